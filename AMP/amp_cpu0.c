@@ -0,0 +1,277 @@
+/*
+ * amp_cpu0.c
+ *
+ *  AMP example, CPU0: switches, LEDs, console and control of CPU1
+ */
+
+/********************************************************************************************
+ * CPU0 side of the AMP split of axi_timer_pwm_student.c. CPU0 owns the GIC distributor, the
+ * AXI GPIO (LEDs in Ch1, switches in Ch2) and the UART; CPU1 (amp_cpu1.c) owns the Private
+ * Timer of its core and the AXI Timer and does nothing but the waveform.
+ *
+ * At start CPU0 empties both OCM mailboxes, releases CPU1 from its boot loop and waits for
+ * it to report. After that a switch change only posts one CMD_SET_FREQ message to CPU1 and
+ * the main loop prints what CPU1 reports: the slow GPIO handler and xil_printf can no longer
+ * delay a PWM sample.
+ *
+ * Switches select the sine frequency as in axi_timer_pwm_student.c:
+ *   0: 60 Hz   1: 100 Hz   2: 500 Hz   3: 1 kHz   others: 1 Hz
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xil_io.h"
+#include "amp_shared.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds and sw */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define SW_CHANNEL 		2				/* GPIO port 2 for SWITCHES */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+#define SW_INT_MASK		XGPIO_IR_CH2_MASK
+#define IntC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID 	// GIC device ID
+#define IntC_GPIO_INTERRUPT_ID	XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR 	// GPIO Interrupt ID
+
+#define CPU1_WAIT_LOOPS		10000000	/* give up on CPU1 after this many polls */
+#define PERIPHCLK_HZ		(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+
+/************************** Hardware Instances  ******************************/
+
+XScuGic IntC;			/* Instance of the Interrupt Controller */
+XGpio GpioInst; 		/* Instance of the AXI GPIO */
+
+/* Frequency the switches ask for but CPU1 has not been sent yet (0: none) */
+static volatile u32 PendingFreq;
+static u32 CommandSeq;
+
+/**************  Function Prototypes **************/
+
+static void SW_Intr_Handler(void *InstancePtr);
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr);
+static int StartCpu1(void);
+static u32 SwitchFrequency(u32 Switches);
+static void SendPending(void);
+static void PrintReport(const mbox_msg_t *Msg);
+
+
+/*************** Main function ********************/
+int main(void){
+	int Status;
+	u32 SwitchValue;
+	mbox_msg_t Msg;
+
+	/* Configure Gpio for leds and switches */
+	Status = XGpio_Initialize(&GpioInst, GPIO_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("GPIO Config failed!\r\n");
+		return XST_FAILURE;
+	}
+	XGpio_SetDataDirection(&GpioInst, LED_CHANNEL, 0x0);
+	XGpio_SetDataDirection(&GpioInst, SW_CHANNEL, 0xf);
+
+	/* Distributor first: CPU1 only attaches its CPU interface to it */
+	Status = IntCInitFunction(&IntC, IntC_DEVICE_ID, &GpioInst);
+	if(Status != XST_SUCCESS) {
+		xil_printf("GPIO Interruption configuration failed!\r\n");
+		return XST_FAILURE;
+	}
+
+	Status = StartCpu1();
+	if (Status != XST_SUCCESS) {
+		xil_printf("CPU1 did not start\r\n");
+		return XST_FAILURE;
+	}
+	xil_printf("CPU1 running\r\n");
+
+	/* First switch reading */
+	SwitchValue = XGpio_DiscreteRead(&GpioInst, SW_CHANNEL);
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, SwitchValue);
+	PendingFreq = SwitchFrequency(SwitchValue);
+
+	while(1){
+		SendPending();
+		while (mbox_receive(&AMP_SHARED->ToCpu0, &Msg) == 0)
+			PrintReport(&Msg);
+	}
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/*
+ * Empties the mailboxes while CPU1 is still parked, then writes its entry point where the
+ * boot code polls for it and wakes it with SEV
+ */
+static int StartCpu1(void)
+{
+	int i;
+
+	AMP_SHARED->Cpu1Ready = 0;
+	MBOX_CLEAN(&AMP_SHARED->Cpu1Ready, sizeof(u32));
+	mbox_init(&AMP_SHARED->ToCpu1);
+	mbox_init(&AMP_SHARED->ToCpu0);
+
+	Xil_Out32(CPU1_START_VECTOR, CPU1_START_ADDR);
+	MBOX_CLEAN(CPU1_START_VECTOR, sizeof(u32));
+	__asm__ volatile("dsb" ::: "memory");
+	__asm__ volatile("sev");
+
+	for (i = 0; i < CPU1_WAIT_LOOPS; i++) {
+		MBOX_INVALIDATE(&AMP_SHARED->Cpu1Ready, sizeof(u32));
+		if (AMP_SHARED->Cpu1Ready == AMP_READY_MAGIC)
+			return XST_SUCCESS;
+	}
+	return XST_FAILURE;
+}
+
+
+static u32 SwitchFrequency(u32 Switches)
+{
+	switch(Switches){
+		case 0x0:
+			return 60;		// 60 Hz sine wave
+		case 0x1:
+			return 100;		// 100 Hz sine wave
+		case 0x2:
+			return 500;		// 500 Hz sine wave
+		case 0x3:
+			return 1000;		// 1 kHz sine wave
+		default:
+			return 1;		// 1 Hz sine wave
+	}
+}
+
+
+/*
+ * Only the main loop sends to CPU1, so the mailbox has a single producer; the switch
+ * handler just leaves the latest request in PendingFreq. A full mailbox is retried on the
+ * next pass and intermediate settings are skipped
+ */
+static void SendPending(void)
+{
+	mbox_msg_t Msg;
+	u32 Freq = PendingFreq;
+
+	if (Freq == 0)
+		return;
+
+	Msg.Type = CMD_SET_FREQ;
+	Msg.Arg[0] = Freq;
+	Msg.Arg[1] = 0;
+	Msg.Arg[2] = 0;
+	Msg.Seq = CommandSeq;
+	if (mbox_send(&AMP_SHARED->ToCpu1, &Msg) == 0) {
+		CommandSeq++;
+		/* a newer request from the handler stays pending */
+		Xil_ExceptionDisable();
+		if (PendingFreq == Freq)
+			PendingFreq = 0;
+		Xil_ExceptionEnable();
+	}
+}
+
+
+static void PrintReport(const mbox_msg_t *Msg)
+{
+	switch (Msg->Type) {
+		case REP_STARTED:
+			printf("CPU1: PWM period %d ns, %d points\r\n", Msg->Arg[0], Msg->Arg[1]);
+			break;
+		case REP_FREQ:
+			printf("CPU1: %d Hz (timer load %d)\r\n", Msg->Arg[0], Msg->Arg[1]);
+			break;
+		case REP_STATS:
+			printf("CPU1: %d samples, worst ISR %d ns, %d reports lost\r\n",
+					Msg->Arg[0], (u32)((u64)Msg->Arg[1] * 1000000000 / PERIPHCLK_HZ),
+					Msg->Arg[2]);
+			break;
+		case REP_ERROR:
+			printf("CPU1: rejected command %d (%d)\r\n", Msg->Arg[0], Msg->Arg[1]);
+			break;
+		default:
+			printf("CPU1: unknown report %d\r\n", Msg->Type);
+	}
+}
+
+
+/********** Interrupt setup and handler connection **********/
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr)
+{
+	XScuGic_Config *IntCConfig;
+	int status;
+
+	/* Interrupt controller initialization and success check */
+	IntCConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(IntCtrlPtr, IntCConfig, IntCConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Gpio Handler connection, delivered to this core only */
+	status = XScuGic_Connect(IntCtrlPtr,
+				IntC_GPIO_INTERRUPT_ID,
+				(Xil_ExceptionHandler)SW_Intr_Handler,
+				(void *)GpioInstancePtr);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+	XScuGic_InterruptMaptoCpu(IntCtrlPtr, 0, IntC_GPIO_INTERRUPT_ID);
+
+	/* Enable GPIO interrupts */
+	XGpio_InterruptEnable(GpioInstancePtr, SW_INT_MASK);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+	/* Enable GIC */
+	XScuGic_Enable(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID);
+
+	/* Initialize the exception table */
+	Xil_ExceptionInit();
+
+	/* Enable Exception handlers */
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			 	 	 	 	 	 (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+								 IntCtrlPtr);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+} /*End of IntCInitFunction */
+
+
+void SW_Intr_Handler(void *InstancePtr)
+{
+	u32 SwitchValue;
+
+	/* Disable Gpio Ch2 interrupts */
+	XGpio_InterruptDisable(&GpioInst, SW_INT_MASK);
+
+	/* Ignore additional button presses in Ch2 */
+	if ((XGpio_InterruptGetStatus(&GpioInst) & SW_INT_MASK) !=
+			SW_INT_MASK) {
+			return;
+		}
+
+	SwitchValue = XGpio_DiscreteRead(&GpioInst, SW_CHANNEL);
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, SwitchValue);
+	PendingFreq = SwitchFrequency(SwitchValue);
+
+    /* Clear the interrupt flag in Gpio Ch2*/
+    (void)XGpio_InterruptClear(&GpioInst, SW_INT_MASK);
+
+    /* Enable GPIO interrupts in Gpio Ch2 */
+    XGpio_InterruptEnable(&GpioInst, SW_INT_MASK);
+} /* End of SW_Intr_Handler*/
@@ -0,0 +1,238 @@
+/*
+ * amp_cpu1.c
+ *
+ *  AMP example, CPU1: real-time sine pwm (spwm) loop
+ */
+
+/********************************************************************************************
+ * CPU1 runs only the waveform of axi_timer_pwm_student.c: its own Private Timer interrupts at
+ * the sample rate and the handler writes the next PWM high time to the AXI Timer. Nothing
+ * else runs on this core, so the sample instants do not move with the switches, the UART or
+ * anything CPU0 does. With the core to itself it reads all SINE_TABLE_SIZE points at every
+ * frequency, 1 kHz included (50 kHz interrupts).
+ *
+ * CPU1 has no UART and no GPIO: it takes commands from CPU0 and sends reports back through
+ * the OCM mailboxes of amp_shared.h, between interrupts.
+ *
+ * Build as a separate application at CPU1_START_ADDR on a BSP with -DUSE_AMP=1 (see
+ * amp_shared.h); CPU0 (amp_cpu0.c) sets up the GIC distributor and starts this core.
+ * The HW platform is that of axi_timer_pwm_student.c (AXI Timer PWM output on pin T14).
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xscutimer.h"
+#include "xtmrctr.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "amp_shared.h"
+
+/* Definitions */
+#define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID	/* this core's Private Timer */
+#define TMRCTR_DEVICE_ID	XPAR_TMRCTR_0_DEVICE_ID		/* AXI TMR device ID */
+#define TMRCTR_0		0				/* AXI Timer 0 ID */
+#define IntC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID	// GIC device ID
+#define PTIMER_INTERRUPT_ID	XPAR_SCUTIMER_INTR		// Private Timer Interruption ID
+
+#define PERIPHCLK_HZ		(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define PWM_PERIOD		12500		/* PWM period of 80 kHz in ns */
+#define SINE_TABLE_SIZE		50		/* Size of Sine Table */
+#define DEFAULT_FREQ		60		/* Hz until CPU0 says otherwise */
+#define MAX_FREQ		1000
+
+/************************** Hardware Instances  ******************************/
+
+XScuGic IntC;			/* This core's interface to the Interrupt Controller */
+XTmrCtr TimerCounterInst;	/* Instance of the AXI Timer */
+XScuTimer PrivateTimerInstance;	/* This core's Private Timer */
+
+/* pwm high time SINE_TABLE_SIZE sine values @f_pwm = 1 KHz, from axi_timer_pwm_student.c */
+const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,842274,
+				885257,922164,952414,975528,991144,999013,999013,991144,
+				975528,952414,922164,885257,842274,793893,740877,684062,
+				624345,562667,500000,437333,375655,315938,259123,206107,
+				157726,114743,77836,47586,24472,8856,987,987,8856,24472,
+				47586,77836,114743,157726,206107,259123,315938,375655,437333};
+
+/* the same table scaled to PWM_PERIOD, so the handler only indexes it */
+static u32 HighTime[SINE_TABLE_SIZE];
+
+/* Shared with the Private Timer handler */
+static volatile u32 Samples;		/* samples written since the last report */
+static volatile u32 WorstTicks;		/* longest interrupt-to-update time, timer ticks */
+static volatile int PwmOn;
+static u32 Pos;				/* table index */
+static u32 LoadValue;
+
+/**************  Function Prototypes **************/
+
+static void PrivateTimerIntrHandler(void *InstancePtr);
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XScuTimer *TimerInstancePtr);
+static void SetFrequency(u32 Freq);
+static void Report(u32 Type, u32 Arg0, u32 Arg1, u32 Arg2);
+static void Command(const mbox_msg_t *Msg);
+
+static u32 ReportSeq, ReportsLost;
+
+
+/*************** Main function ********************/
+int main(void){
+	XScuTimer_Config *ConfigPtr;
+	mbox_msg_t Msg;
+	u32 Reported = 0;
+	int i;
+
+	for (i = 0; i < SINE_TABLE_SIZE; i++)
+		HighTime[i] = (u32)(((u64)sine[i] * PWM_PERIOD + 500000) / 1000000);
+
+	/* AXI Timer in PWM mode, starting at the first sample */
+	XTmrCtr_Initialize(&TimerCounterInst, TMRCTR_DEVICE_ID);
+	XTmrCtr_PwmDisable(&TimerCounterInst);
+	XTmrCtr_PwmConfigure(&TimerCounterInst, PWM_PERIOD, HighTime[0]);
+	XTmrCtr_PwmEnable(&TimerCounterInst);
+	PwmOn = 1;
+
+	/* Private Timer: auto reload at the sample rate */
+	ConfigPtr = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	XScuTimer_CfgInitialize(&PrivateTimerInstance, ConfigPtr, ConfigPtr->BaseAddr);
+	XScuTimer_SetPrescaler(&PrivateTimerInstance, 0);
+	XScuTimer_EnableAutoReload(&PrivateTimerInstance);
+	SetFrequency(DEFAULT_FREQ);
+
+	IntCInitFunction(&IntC, IntC_DEVICE_ID, &PrivateTimerInstance);
+	XScuTimer_Start(&PrivateTimerInstance);
+
+	/* tell CPU0 we are up */
+	AMP_SHARED->Cpu1Ready = AMP_READY_MAGIC;
+	MBOX_CLEAN(&AMP_SHARED->Cpu1Ready, sizeof(u32));
+	Report(REP_STARTED, PWM_PERIOD, SINE_TABLE_SIZE, 0);
+
+	while(1){
+		/* sleep until the next sample; everything below runs between samples */
+		__asm__ volatile("wfi");
+
+		while (mbox_receive(&AMP_SHARED->ToCpu1, &Msg) == 0)
+			Command(&Msg);
+
+		/* about once a second */
+		if (Samples - Reported >= (PERIPHCLK_HZ / (LoadValue + 1))) {
+			Reported = Samples;
+			Report(REP_STATS, Samples, WorstTicks, ReportsLost);
+			WorstTicks = 0;
+		}
+	}
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Private Timer handler: one table point per interrupt */
+static void PrivateTimerIntrHandler(void *InstancePtr)
+{
+	XScuTimer *TimerPtr = (XScuTimer *)InstancePtr;
+	u32 Ticks;
+
+	XScuTimer_ClearInterruptStatus(TimerPtr);
+
+	if (PwmOn) {
+		XTmrCtr_PwmDisable(&TimerCounterInst);
+		XTmrCtr_PwmConfigure(&TimerCounterInst, PWM_PERIOD, HighTime[Pos]);
+		XTmrCtr_PwmEnable(&TimerCounterInst);
+	}
+	if (++Pos == SINE_TABLE_SIZE)
+		Pos = 0;
+	Samples++;
+
+	/* the timer reloaded at the interrupt, what it has counted since is our latency */
+	Ticks = LoadValue - XScuTimer_GetCounterValue(TimerPtr);
+	if (Ticks > WorstTicks)
+		WorstTicks = Ticks;
+}
+
+
+/* One interrupt per table point: load = PERIPHCLK / (f * points) - 1 */
+static void SetFrequency(u32 Freq)
+{
+	LoadValue = PERIPHCLK_HZ / (Freq * SINE_TABLE_SIZE) - 1;
+	XScuTimer_LoadTimer(&PrivateTimerInstance, LoadValue);
+}
+
+
+static void Command(const mbox_msg_t *Msg)
+{
+	switch (Msg->Type) {
+		case CMD_SET_FREQ:
+			if (Msg->Arg[0] == 0 || Msg->Arg[0] > MAX_FREQ) {
+				Report(REP_ERROR, Msg->Type, Msg->Arg[0], 0);
+				break;
+			}
+			SetFrequency(Msg->Arg[0]);
+			Report(REP_FREQ, Msg->Arg[0], LoadValue, 0);
+			break;
+		case CMD_STOP:
+			PwmOn = 0;
+			XTmrCtr_PwmDisable(&TimerCounterInst);
+			break;
+		case CMD_START:
+			PwmOn = 1;
+			break;
+		default:
+			Report(REP_ERROR, Msg->Type, 0, 0);
+	}
+}
+
+
+/* Reports are dropped, and counted, when CPU0 falls behind: CPU1 never waits for it */
+static void Report(u32 Type, u32 Arg0, u32 Arg1, u32 Arg2)
+{
+	mbox_msg_t Msg;
+
+	Msg.Type = Type;
+	Msg.Arg[0] = Arg0;
+	Msg.Arg[1] = Arg1;
+	Msg.Arg[2] = Arg2;
+	Msg.Seq = ReportSeq++;
+	if (mbox_send(&AMP_SHARED->ToCpu0, &Msg) != 0)
+		ReportsLost++;
+}
+
+
+/* With USE_AMP the distributor is left as CPU0 set it; the Private Timer is banked per core */
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XScuTimer *TimerInstancePtr)
+{
+	XScuGic_Config *IntCConfig;
+	int status;
+
+	IntCConfig = XScuGic_LookupConfig(DeviceId);
+	status = XScuGic_CfgInitialize(IntCtrlPtr, IntCConfig, IntCConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	status = XScuGic_Connect(IntCtrlPtr, PTIMER_INTERRUPT_ID,
+				(Xil_ExceptionHandler)PrivateTimerIntrHandler,
+				(void *)TimerInstancePtr);
+	if (status != XST_SUCCESS) {
+		return status;
+	}
+
+	XScuTimer_EnableInterrupt(TimerInstancePtr);
+	XScuGic_Enable(IntCtrlPtr, PTIMER_INTERRUPT_ID);
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				(Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				IntCtrlPtr);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+} /*End of IntCInitFunction */
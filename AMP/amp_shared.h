@@ -0,0 +1,53 @@
+/*
+ * amp_shared.h
+ *
+ *  Memory shared by the two cores of the AMP example and the messages they exchange
+ */
+
+/********************************************************************************************
+ *
+ * Memory map
+ *   CPU0 app   DDR from 0x00100000 (standard lscript.ld)
+ *   CPU1 app   DDR from CPU1_START_ADDR; its lscript.ld must start there and its BSP must be
+ *              built with -DUSE_AMP=1 so XScuGic leaves the distributor set up by CPU0 alone
+ *   OCM        the top 64 KB (0xFFFF0000) is mapped on both cores; AMP_SHARED_BASE holds the
+ *              two mailboxes below. 0xFFFFFE00-0xFFFFFFFF is left to the boot code, which
+ *              parks CPU1 in a WFE loop until CPU1_START_VECTOR holds an address
+ *
+ * Commands go from CPU0 to CPU1 in ToCpu1, reports from CPU1 to CPU0 in ToCpu0.
+ *
+ ********************************************************************************************/
+
+#ifndef AMP_SHARED_H
+#define AMP_SHARED_H
+
+/* Include Files */
+#include "mailbox.h"
+
+/* Definitions */
+#define AMP_SHARED_BASE		0xFFFF0000	/* OCM, high mapping */
+#define CPU1_START_ADDR		0x02000000	/* entry of the CPU1 application */
+#define CPU1_START_VECTOR	0xFFFFFFF0	/* polled by the parked CPU1 */
+
+#define AMP_READY_MAGIC		0x43505531	/* "CPU1": CPU1 is running */
+
+/* Commands, CPU0 -> CPU1 */
+#define CMD_SET_FREQ		1	/* Arg[0] sine frequency in Hz */
+#define CMD_STOP		2	/* PWM output off */
+#define CMD_START		3	/* PWM output on */
+
+/* Reports, CPU1 -> CPU0 */
+#define REP_STARTED		1	/* Arg[0] PWM period ns, Arg[1] sine table points */
+#define REP_FREQ		2	/* Arg[0] frequency now running, Arg[1] timer load */
+#define REP_STATS		3	/* Arg[0] samples, Arg[1] worst ISR cycles, Arg[2] reports lost */
+#define REP_ERROR		4	/* Arg[0] rejected command type */
+
+typedef struct {
+	volatile uint32_t Cpu1Ready __attribute__((aligned(MBOX_LINE)));	/* written by CPU1 */
+	mbox_t ToCpu1;
+	mbox_t ToCpu0;
+} amp_shared_t;
+
+#define AMP_SHARED	((amp_shared_t *)AMP_SHARED_BASE)
+
+#endif
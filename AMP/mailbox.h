@@ -0,0 +1,135 @@
+/*
+ * mailbox.h
+ *
+ *  Lock-free single-producer single-consumer mailbox between the two Cortex-A9 cores
+ */
+
+/********************************************************************************************
+ *
+ * A mailbox is a ring of MBOX_SLOTS fixed-size messages in memory both cores can reach (OCM,
+ * see amp_shared.h). One core only ever sends and the other only ever receives, so no lock or
+ * atomic read-modify-write is needed: the sender owns Head and the slots it fills, the
+ * receiver owns Tail. Each of Head, Tail and every slot sits in its own 32-byte cache line,
+ * so a core never writes a line the other core writes.
+ *
+ * Ordering and caches
+ *   The mailbox is cacheable. OCM is reached through the SCU, not the L2, so L1 maintenance
+ *   is enough:
+ *   send     write the slot, clean it to OCM, DMB, publish Head and clean its line
+ *   receive  invalidate Head, DMB, invalidate and read the slot, DMB, publish Tail and
+ *            clean its line
+ *   The DMB keeps the slot contents visible before the index that publishes them. A line is
+ *   only invalidated by the core that never writes it, so no data is discarded.
+ *
+ * Portability
+ *   Cache maintenance and the barrier are macros. Built for the Zynq they map to the
+ *   standalone BSP L1 functions and DMB. Elsewhere (e.g. two host threads sharing the
+ *   structure) the cache operations compile to nothing and the barrier is a full
+ *   __sync_synchronize(), so the same code runs against a host model of both cores.
+ *
+ ********************************************************************************************/
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+/* Include Files */
+#include <stdint.h>
+
+#if defined(__arm__) && !defined(MBOX_HOST)
+#include "xil_cache.h"
+#define MBOX_CLEAN(p, n)	Xil_L1DCacheFlushRange((INTPTR)(p), (n))
+#define MBOX_INVALIDATE(p, n)	Xil_L1DCacheInvalidateRange((INTPTR)(p), (n))
+#define MBOX_BARRIER()		__asm__ volatile("dmb" ::: "memory")
+#else
+#define MBOX_CLEAN(p, n)	((void)(p), (void)(n))
+#define MBOX_INVALIDATE(p, n)	((void)(p), (void)(n))
+#define MBOX_BARRIER()		__sync_synchronize()
+#endif
+
+/* Definitions */
+#define MBOX_LINE	32			/* Cortex-A9 L1 line */
+#define MBOX_SLOTS	16			/* power of two */
+
+/* One message, one cache line */
+typedef struct {
+	uint32_t Type;				/* meaning of the arguments, see amp_shared.h */
+	uint32_t Arg[3];
+	uint32_t Seq;				/* sender's count, to spot gaps */
+	uint32_t Pad[3];
+} __attribute__((aligned(MBOX_LINE))) mbox_msg_t;
+
+typedef struct {
+	volatile uint32_t Head __attribute__((aligned(MBOX_LINE)));	/* next slot to fill */
+	volatile uint32_t Tail __attribute__((aligned(MBOX_LINE)));	/* next slot to read */
+	mbox_msg_t Slot[MBOX_SLOTS];
+} __attribute__((aligned(MBOX_LINE))) mbox_t;
+
+
+/*****************************************************************************
+ * Function: mbox_init()
+ *
+ * Empties the mailbox. Only one core calls it, before the other one starts
+ *
+ *****************************************************************************/
+static inline void mbox_init(mbox_t *m)
+{
+	m->Head = 0;
+	m->Tail = 0;
+	MBOX_CLEAN(m, sizeof(*m));
+}
+
+
+/*****************************************************************************
+ * Function: mbox_send()
+ *
+ * Copies a message into the mailbox. Returns 0, or -1 when it is full (the
+ * caller decides whether to retry or drop); never waits
+ *
+ *****************************************************************************/
+static inline int mbox_send(mbox_t *m, const mbox_msg_t *msg)
+{
+	uint32_t head = m->Head;
+	mbox_msg_t *slot;
+
+	MBOX_INVALIDATE(&m->Tail, sizeof(m->Tail));
+	if (head - m->Tail == MBOX_SLOTS)
+		return -1;
+
+	slot = &m->Slot[head & (MBOX_SLOTS - 1)];
+	*slot = *msg;
+	MBOX_CLEAN(slot, sizeof(*slot));
+
+	MBOX_BARRIER();				/* slot before Head */
+	m->Head = head + 1;
+	MBOX_CLEAN(&m->Head, sizeof(m->Head));
+	return 0;
+}
+
+
+/*****************************************************************************
+ * Function: mbox_receive()
+ *
+ * Takes the oldest message. Returns 0, or -1 when the mailbox is empty
+ *
+ *****************************************************************************/
+static inline int mbox_receive(mbox_t *m, mbox_msg_t *msg)
+{
+	uint32_t tail = m->Tail;
+	mbox_msg_t *slot;
+
+	MBOX_INVALIDATE(&m->Head, sizeof(m->Head));
+	if (m->Head == tail)
+		return -1;
+
+	MBOX_BARRIER();				/* Head before the slot */
+	slot = &m->Slot[tail & (MBOX_SLOTS - 1)];
+	MBOX_INVALIDATE(slot, sizeof(*slot));
+	*msg = *slot;
+
+	MBOX_BARRIER();				/* slot read before it is given back */
+	m->Tail = tail + 1;
+	MBOX_CLEAN(&m->Tail, sizeof(m->Tail));
+	return 0;
+}
+
+#endif
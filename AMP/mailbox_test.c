@@ -0,0 +1,157 @@
+/*
+ * mailbox_test.c
+ *
+ *  Host test of mailbox.h: both cores modelled as two threads
+ */
+
+/********************************************************************************************
+ * Runs on a PC, not on the Zybo:
+ *
+ *   gcc -O2 -pthread -DMBOX_HOST -o mailbox_test mailbox_test.c && ./mailbox_test
+ *
+ * First, on one thread, an empty mailbox must refuse to give a message, a full one must
+ * refuse to take one, and MBOX_SLOTS messages must come out in the order they went in.
+ * Then a sender thread (CPU0) and a receiver thread (CPU1) run at the same time for
+ * MESSAGES messages, retrying (and yielding the CPU) when the mailbox is full or empty.
+ * The receiver checks that every Seq is the previous one plus one (no gap, no reordering,
+ * no repeat) and that the arguments belong to that Seq (no torn slot). Both full and empty must have been hit, so
+ * the two sides really did overtake each other.
+ *
+ * Prints "mailbox test passed" and returns 0, or the first failure and returns 1.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include "mailbox.h"
+
+/* Definitions */
+#define MESSAGES	2000000u
+
+static mbox_t Box;
+static volatile uint32_t Full, Empty;	/* retries of each side */
+static volatile int Failed;
+
+/* Function Prototypes */
+static int SingleThread(void);
+static void *Sender(void *arg);
+static void *Receiver(void *arg);
+static void Fill(mbox_msg_t *msg, uint32_t seq);
+
+
+int main(void)
+{
+	pthread_t tx, rx;
+
+	if (SingleThread())
+		return 1;
+
+	mbox_init(&Box);
+	pthread_create(&rx, NULL, Receiver, NULL);
+	pthread_create(&tx, NULL, Sender, NULL);
+	pthread_join(tx, NULL);
+	pthread_join(rx, NULL);
+	if (Failed)
+		return 1;
+
+	printf("%u messages, sender found it full %u times, receiver empty %u times\n",
+	       MESSAGES, Full, Empty);
+	if (Full == 0 || Empty == 0) {
+		printf("FAIL: the threads never overtook each other\n");
+		return 1;
+	}
+
+	printf("mailbox test passed\n");
+	return 0;
+}
+
+
+/* Empty, full and FIFO order without concurrency */
+static int SingleThread(void)
+{
+	mbox_msg_t msg;
+	uint32_t i, round;
+
+	mbox_init(&Box);
+	for (round = 0; round < 3; round++) {	/* indices wrap past the ring */
+		if (mbox_receive(&Box, &msg) != -1) {
+			printf("FAIL: message from an empty mailbox\n");
+			return 1;
+		}
+		for (i = 0; i < MBOX_SLOTS; i++) {
+			Fill(&msg, round * MBOX_SLOTS + i);
+			if (mbox_send(&Box, &msg) != 0) {
+				printf("FAIL: send %u refused before the mailbox was full\n", i);
+				return 1;
+			}
+		}
+		Fill(&msg, ~0u);
+		if (mbox_send(&Box, &msg) != -1) {
+			printf("FAIL: send accepted by a full mailbox\n");
+			return 1;
+		}
+		for (i = 0; i < MBOX_SLOTS; i++) {
+			if (mbox_receive(&Box, &msg) != 0 || msg.Seq != round * MBOX_SLOTS + i) {
+				printf("FAIL: expected Seq %u\n", round * MBOX_SLOTS + i);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+
+/* CPU0: Seq 0, 1, 2... retried until there is room */
+static void *Sender(void *arg)
+{
+	mbox_msg_t msg;
+	uint32_t seq;
+
+	(void)arg;
+	for (seq = 0; seq < MESSAGES && !Failed; seq++) {
+		Fill(&msg, seq);
+		while (mbox_send(&Box, &msg) != 0 && !Failed) {
+			Full++;
+			sched_yield();		/* let the receiver run on a single CPU */
+		}
+	}
+	return NULL;
+}
+
+
+/* CPU1: every message must be the next Seq, with its own arguments */
+static void *Receiver(void *arg)
+{
+	mbox_msg_t msg, want;
+	uint32_t seq;
+
+	(void)arg;
+	for (seq = 0; seq < MESSAGES; seq++) {
+		while (mbox_receive(&Box, &msg) != 0) {
+			Empty++;
+			sched_yield();
+		}
+		Fill(&want, seq);
+		if (msg.Seq != seq || msg.Type != want.Type || msg.Arg[0] != want.Arg[0] ||
+		    msg.Arg[1] != want.Arg[1] || msg.Arg[2] != want.Arg[2]) {
+			printf("FAIL: message %u has Seq %u, arguments %08x %08x %08x\n",
+			       seq, msg.Seq, msg.Arg[0], msg.Arg[1], msg.Arg[2]);
+			Failed = 1;
+			break;
+		}
+	}
+	return NULL;
+}
+
+
+/* Arguments derived from Seq, so a slot mixing two messages shows */
+static void Fill(mbox_msg_t *msg, uint32_t seq)
+{
+	msg->Type = seq & 0xFF;
+	msg->Arg[0] = seq * 2654435761u;
+	msg->Arg[1] = ~seq;
+	msg->Arg[2] = seq ^ 0xA5A5A5A5;
+	msg->Seq = seq;
+}
@@ -0,0 +1,899 @@
+// arm_dual.sv
+// Dual-issue (superscalar) version of arm_pipelined.sv
+// Compile instead of arm_pipelined.sv, with the same alu module
+//
+// run 300
+// Expect simulator to print "Simulation succeeded"
+// when the value 7 is written to address 100 (0x64)
+// Uses the same memfile.dat as ARM_SingleCycle.
+
+// Same instruction subset as arm_pipelined.sv:
+//   ADD, SUB, AND, ORR (immediate and register), LDR, STR, B
+//   R15 reads as PC+8
+//
+// Pipeline:
+//   Fetch / Decode / Execute / Memory / Writeback, two slots wide.
+//   Fetch reads 64 bits from imem, the instructions at PC (slot 0)
+//   and PC+4 (slot 1), and steps the PC by 8. Slot 0 always holds the
+//   older instruction.
+//   Decode issues both together (a pair) unless
+//    - slot 1 reads a register slot 0 writes   (pair dependency)
+//    - both are LDR/STR                        (one data memory port)
+//    - both are B                              (one branch unit)
+//    - slot 0 sets the flags and slot 1 has a condition other than AL
+//      (flag interlock: both check the flags left by the previous
+//      pair, so slot 1 cannot see those of slot 0)
+//    - either writes R15
+//   Otherwise slot 0 issues alone, slot 1 moves to slot 0 and Fetch
+//   waits a cycle (a split); it issues alone in the next cycle.
+//   A write to R15 in slot 0 drops slot 1 instead, as it is on the
+//   wrong path.
+//   Each slot has its own ALU and register file read ports (4 read,
+//   2 write ports in all). Results are forwarded to both Execute slots
+//   from both slots of Memory and Writeback, the younger one first;
+//   if both slots write the same register, slot 1 wins. A load in
+//   Execute (either slot) stalls Decode one cycle if either
+//   instruction there reads its result, unless a mispredict in
+//   Execute flushes Decode instead.
+//   LDR/STR use the one data memory port from either slot.
+//   Writes to R15 through the register file stall fetch until the new
+//   PC leaves Writeback, as in arm_pipelined.sv.
+//   B is resolved in Execute, in either slot. A wrong prediction
+//   squashes the instructions in Fetch and Decode (2 cycles), and
+//   slot 1 of Execute when the branch is in slot 0.
+//
+// Branch prediction (bpred module, parameters as in arm_pipelined.sv):
+//   Each fetch slot looks up its own copy of the tables (two read
+//   ports); both copies are updated by the branch in Execute. A
+//   predicted taken branch in slot 0 ends the fetched pair.
+//
+// Performance counters in arm:
+//   Retired   instructions reaching Memory (condition failed included)
+//   Pairs     cycles that issued two instructions
+//   Splits    pairs split by the rules above
+//   The testbench prints them with the cycle count, IPC = Retired /
+//   Cycles, and the bpred counters of slot 0 when the run ends.
+//   Stores at 128 and above are left to the program (scratch data for
+//   dualbench.dat, which needs copying to memfile.dat).
+//   memfile.dat is mostly one dependence chain; in dualbench.dat the
+//   FILL and SUM loops are written to pair, while FIB is a chain and
+//   splits. The IPC of neither is reported: with no simulator
+//   available, arm_dual.sv has not been run.
+
+module testbench();
+
+  logic        clk;
+  logic        reset;
+
+  logic [31:0] WriteData, DataAdr;
+  logic        MemWrite;
+  logic [31:0] Cycles;
+
+  // instantiate device to be tested
+  top dut(clk, reset, WriteData, DataAdr, MemWrite);
+
+  // initialize test
+  initial
+    begin
+      reset <= 1; # 22; reset <= 0;
+    end
+
+  // generate clock to sequence tests
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  // count cycles since reset
+  always @(posedge clk)
+    if (reset) Cycles <= 0;
+    else       Cycles <= Cycles + 1;
+
+  // check results
+  always @(negedge clk)
+    begin
+      if(MemWrite) begin
+        if(DataAdr === 100 & WriteData === 7) begin
+          $display("Simulation succeeded");
+          $display("Cycles %0d, Retired %0d, IPC %0.2f, Pairs %0d, Splits %0d",
+                   Cycles, dut.arm.Retired,
+                   real'(dut.arm.Retired) / Cycles,
+                   dut.arm.Pairs, dut.arm.Splits);
+          $display("Predictions %0d, Mispredicts %0d, FlushCycles %0d",
+                   dut.arm.bp0.Predictions, dut.arm.bp0.Mispredicts,
+                   dut.arm.bp0.FlushCycles);
+          $stop;
+        end else if (DataAdr !== 96 & DataAdr < 128) begin
+          $display("Simulation failed");
+          $stop;
+        end
+      end
+    end
+endmodule
+
+module top #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                       BHT_BITS  = 6, BTB_BITS = 4)
+            (input  logic        clk, reset,
+             output logic [31:0] WriteData, DataAdr,
+             output logic        MemWrite);
+
+  logic [31:0] PC, ReadData;
+  logic [63:0] Instr;
+
+  // instantiate processor and memories
+  arm #(BP_SCHEME, USE_BTB, BHT_BITS, BTB_BITS)
+      arm(clk, reset, PC, Instr, MemWrite, DataAdr,
+          WriteData, ReadData);
+  imem imem(PC, Instr);
+  dmem dmem(clk, MemWrite, DataAdr, WriteData, ReadData);
+endmodule
+
+module dmem(input  logic        clk, we,
+            input  logic [31:0] a, wd,
+            output logic [31:0] rd);
+
+  logic [31:0] RAM[63:0];
+
+  assign rd = RAM[a[31:2]]; // word aligned
+
+  always_ff @(posedge clk)
+    if (we) RAM[a[31:2]] <= wd;
+endmodule
+
+module imem(input  logic [31:0] a,
+            output logic [63:0] rd);
+
+  logic [31:0] RAM[63:0];
+
+  initial
+      $readmemh("memfile.dat",RAM);
+
+  // 64-bit fetch: the words at a and a+4
+  assign rd = {RAM[a[31:2] + 1], RAM[a[31:2]]};
+endmodule
+
+module arm #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                       BHT_BITS  = 6, BTB_BITS = 4)
+            (input  logic        clk, reset,
+             output logic [31:0] PCF,
+             input  logic [63:0] InstrF,
+             output logic        MemWriteM,
+             output logic [31:0] DataAdrM, WriteDataM,
+             input  logic [31:0] ReadDataM);
+
+  logic [1:0]  RegSrcD0, ImmSrcD0, RegSrcD1, ImmSrcD1;
+  logic [1:0]  ALUControlE0, ALUControlE1;
+  logic        ALUSrcE0, ALUSrcE1, BranchE0, BranchE1, BranchE;
+  logic        BranchTakenE, MemSlotM;
+  logic        MemtoRegW0, MemtoRegW1, RegWriteW0, RegWriteW1, PCSrcW;
+  logic        RegWriteM0, RegWriteM1, MemtoRegE0, MemtoRegE1;
+  logic        RegWriteD0, Use1D0, Use2D0, Use1D1, Use2D1;
+  logic        MemD0, MemD1, BranchD0, BranchD1, FlagSetD0, CondD1;
+  logic        PCSrcD0, PCSrcD1, PCWrPendingF;
+  logic [1:0]  RetireM;
+  logic [3:0]  ALUFlagsE0, ALUFlagsE1;
+  logic [31:0] InstrD0, InstrD1;
+  logic        ValidD0, ValidD1;
+  logic [31:0] PCF1, PCE, BranchTargetE, PredTargetF0, PredTargetF1;
+  logic        PredTakenF0, PredTakenF1, PredTakenE, MispredictE, KillE1;
+  logic [3:0]  RA1D0, RA2D0, RA1D1, RA2D1, WA3D0;
+  logic [3:0]  RA1E0, RA2E0, RA1E1, RA2E1, WA3E0, WA3E1;
+  logic [3:0]  WA3M0, WA3M1, WA3W0, WA3W1;
+  logic [2:0]  ForwardAE0, ForwardBE0, ForwardAE1, ForwardBE1;
+  logic        DualD, SplitD, StallF, StallD, FlushD, FlushE, FlushE1;
+
+  // performance counters
+  logic [31:0] Retired, Pairs, Splits;
+
+  controller c(clk, reset, InstrD0[31:12], InstrD1[31:12],
+               ValidD0, ValidD1, ALUFlagsE0, ALUFlagsE1,
+               RegSrcD0, ImmSrcD0, RegSrcD1, ImmSrcD1,
+               ALUSrcE0, ALUSrcE1, ALUControlE0, ALUControlE1,
+               BranchE0, BranchE1, BranchTakenE,
+               MemWriteM, MemSlotM,
+               MemtoRegW0, MemtoRegW1, RegWriteW0, RegWriteW1, PCSrcW,
+               RegWriteM0, RegWriteM1, MemtoRegE0, MemtoRegE1,
+               RegWriteD0, Use1D0, Use2D0, Use1D1, Use2D1,
+               MemD0, MemD1, BranchD0, BranchD1, FlagSetD0, CondD1,
+               PCSrcD0, PCSrcD1, PCWrPendingF, RetireM,
+               FlushE, FlushE1, KillE1);
+  datapath dp(clk, reset,
+              RegSrcD0, ImmSrcD0, RegSrcD1, ImmSrcD1,
+              ALUSrcE0, ALUSrcE1, ALUControlE0, ALUControlE1,
+              BranchE0, BranchE1, BranchTakenE, MemSlotM,
+              MemtoRegW0, MemtoRegW1, RegWriteW0, RegWriteW1, PCSrcW,
+              PCF, InstrF, InstrD0, InstrD1, ValidD0, ValidD1,
+              DataAdrM, WriteDataM, ReadDataM,
+              ALUFlagsE0, ALUFlagsE1,
+              PredTakenF0, PredTakenF1, PredTargetF0, PredTargetF1,
+              MispredictE, PredTakenE, PCE, BranchTargetE,
+              RA1D0, RA2D0, RA1D1, RA2D1, WA3D0,
+              RA1E0, RA2E0, RA1E1, RA2E1, WA3E0, WA3E1,
+              WA3M0, WA3M1, WA3W0, WA3W1,
+              ForwardAE0, ForwardBE0, ForwardAE1, ForwardBE1,
+              SplitD, StallF, StallD, FlushD, FlushE, FlushE1);
+
+  // one copy of the predictor tables per fetch slot
+  assign PCF1    = PCF + 32'h4;
+  assign BranchE = BranchE0 | BranchE1;
+  bpred #(BP_SCHEME, USE_BTB, BHT_BITS, BTB_BITS)
+        bp0(clk, reset, PCF, InstrF[31:0], PredTakenF0, PredTargetF0,
+            PCE, BranchTargetE, BranchE, BranchTakenE, PredTakenE,
+            MispredictE);
+  bpred #(BP_SCHEME, USE_BTB, BHT_BITS, BTB_BITS)
+        bp1(clk, reset, PCF1, InstrF[63:32], PredTakenF1, PredTargetF1,
+            PCE, BranchTargetE, BranchE, BranchTakenE, PredTakenE, );
+
+  // a mispredicted branch in slot 0 squashes slot 1 of Execute
+  assign KillE1 = MispredictE & BranchE0;
+
+  hazard h(RA1D0, RA2D0, RA1D1, RA2D1, WA3D0,
+           RA1E0, RA2E0, RA1E1, RA2E1, WA3E0, WA3E1,
+           WA3M0, WA3M1, WA3W0, WA3W1,
+           ValidD1, RegWriteD0, Use1D0, Use2D0, Use1D1, Use2D1,
+           MemD0, MemD1, BranchD0, BranchD1, FlagSetD0, CondD1,
+           PCSrcD0, PCSrcD1,
+           RegWriteM0, RegWriteM1, RegWriteW0, RegWriteW1,
+           MispredictE, KillE1, MemtoRegE0, MemtoRegE1,
+           PCWrPendingF, PCSrcW,
+           ForwardAE0, ForwardBE0, ForwardAE1, ForwardBE1,
+           DualD, SplitD, StallF, StallD, FlushD, FlushE, FlushE1);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Retired <= 0;
+      Pairs   <= 0;
+      Splits  <= 0;
+    end else begin
+      Retired <= Retired + RetireM[0] + RetireM[1];
+      if (DualD & ~FlushE) Pairs  <= Pairs + 1;
+      if (SplitD)          Splits <= Splits + 1;
+    end
+endmodule
+
+module controller(input  logic         clk, reset,
+                  input  logic [31:12] InstrD0, InstrD1,
+                  input  logic         ValidD0, ValidD1,
+                  input  logic [3:0]   ALUFlagsE0, ALUFlagsE1,
+                  output logic [1:0]   RegSrcD0, ImmSrcD0,
+                  output logic [1:0]   RegSrcD1, ImmSrcD1,
+                  output logic         ALUSrcE0, ALUSrcE1,
+                  output logic [1:0]   ALUControlE0, ALUControlE1,
+                  output logic         BranchE0, BranchE1, BranchTakenE,
+                  output logic         MemWriteM, MemSlotM,
+                  output logic         MemtoRegW0, MemtoRegW1,
+                  output logic         RegWriteW0, RegWriteW1, PCSrcW,
+                  // hazard interface
+                  output logic         RegWriteM0, RegWriteM1,
+                  output logic         MemtoRegE0, MemtoRegE1,
+                  output logic         RegWriteD0,
+                  output logic         Use1D0, Use2D0, Use1D1, Use2D1,
+                  output logic         MemD0, MemD1, BranchD0, BranchD1,
+                  output logic         FlagSetD0, CondD1,
+                  output logic         PCSrcD0, PCSrcD1, PCWrPendingF,
+                  output logic [1:0]   RetireM,
+                  input  logic         FlushE, FlushE1, KillE1);
+
+  logic       ALUSrcD0, ALUSrcD1, MemtoRegD0, MemtoRegD1;
+  logic       RegWriteD1, MemWriteD0, MemWriteD1;
+  logic [1:0] ALUControlD0, ALUControlD1, FlagWriteD0, FlagWriteD1;
+  logic [1:0] FlagWriteE0, FlagWriteE1;
+  logic       ValidE0, ValidE1, MemSlotE;
+  logic       MemWriteE0, MemWriteE1, RegWriteE0, RegWriteE1;
+  logic       PCSrcE, PCSrcGatedE, PCSrcM, MemtoRegM0, MemtoRegM1;
+  logic       CondExE0, CondExE1;
+  logic [3:0] CondE0, CondE1, FlagsE, Flags0E, FlagsNextE;
+
+  // Decode stage
+  // one decoder per slot; an empty slot decodes to no writes
+  decoder dec0(InstrD0, ValidD0, RegSrcD0, ImmSrcD0, ALUSrcD0,
+               MemtoRegD0, RegWriteD0, MemWriteD0, BranchD0,
+               ALUControlD0, FlagWriteD0, PCSrcD0);
+  decoder dec1(InstrD1, ValidD1, RegSrcD1, ImmSrcD1, ALUSrcD1,
+               MemtoRegD1, RegWriteD1, MemWriteD1, BranchD1,
+               ALUControlD1, FlagWriteD1, PCSrcD1);
+
+  // summary for the issue logic
+  // B reads R15 only; Rm is read by register data processing and
+  // Rd by STR
+  assign Use1D0    = ValidD0 & ~BranchD0;
+  assign Use2D0    = ValidD0 & (~ALUSrcD0 | MemWriteD0);
+  assign Use1D1    = ValidD1 & ~BranchD1;
+  assign Use2D1    = ValidD1 & (~ALUSrcD1 | MemWriteD1);
+  assign MemD0     = MemtoRegD0 | MemWriteD0;
+  assign MemD1     = MemtoRegD1 | MemWriteD1;
+  assign FlagSetD0 = FlagWriteD0[1];
+  assign CondD1    = (InstrD1[31:28] != 4'b1110);
+
+  // Execute stage
+  // slot 1 is cleared whenever it does not issue
+  floprc #(8) flushedregsE0(clk, reset, FlushE,
+                            {FlagWriteD0, BranchD0, MemWriteD0,
+                             RegWriteD0, PCSrcD0, MemtoRegD0, ValidD0},
+                            {FlagWriteE0, BranchE0, MemWriteE0,
+                             RegWriteE0, PCSrcE, MemtoRegE0, ValidE0});
+  floprc #(7) flushedregsE1(clk, reset, FlushE1,
+                            {FlagWriteD1, BranchD1, MemWriteD1,
+                             RegWriteD1, MemtoRegD1, ValidD1},
+                            {FlagWriteE1, BranchE1, MemWriteE1,
+                             RegWriteE1, MemtoRegE1, ValidE1});
+  flopr  #(6) regsE(clk, reset,
+                    {ALUSrcD0, ALUControlD0, ALUSrcD1, ALUControlD1},
+                    {ALUSrcE0, ALUControlE0, ALUSrcE1, ALUControlE1});
+  flopr  #(8) condregE(clk, reset, {InstrD0[31:28], InstrD1[31:28]},
+                       {CondE0, CondE1});
+  flopr  #(4) flagsreg(clk, reset, FlagsNextE, FlagsE);
+
+  // write and Branch controls are conditional
+  // both slots check the flags left by the previous pair; slot 1
+  // writes its flags after slot 0
+  conditional cond0(CondE0, FlagsE, FlagsE, ALUFlagsE0, FlagWriteE0,
+                    CondExE0, Flags0E);
+  conditional cond1(CondE1, FlagsE, Flags0E, ALUFlagsE1,
+                    FlagWriteE1 & {2{~KillE1}}, CondExE1, FlagsNextE);
+  assign BranchTakenE = (BranchE0 & CondExE0) | (BranchE1 & CondExE1);
+  assign PCSrcGatedE  = PCSrcE & CondExE0;
+  assign MemSlotE     = MemWriteE1 | MemtoRegE1;
+
+  // Memory stage
+  flopr #(9) regsM(clk, reset,
+                    {(MemWriteE0 & CondExE0) |
+                     (MemWriteE1 & CondExE1 & ~KillE1), MemSlotE,
+                     MemtoRegE0, RegWriteE0 & CondExE0,
+                     MemtoRegE1, RegWriteE1 & CondExE1 & ~KillE1,
+                     PCSrcGatedE, ValidE0, ValidE1 & ~KillE1},
+                    {MemWriteM, MemSlotM,
+                     MemtoRegM0, RegWriteM0, MemtoRegM1, RegWriteM1,
+                     PCSrcM, RetireM});
+
+  // Writeback stage
+  flopr #(5) regsW(clk, reset,
+                   {MemtoRegM0, RegWriteM0, MemtoRegM1, RegWriteM1,
+                    PCSrcM},
+                   {MemtoRegW0, RegWriteW0, MemtoRegW1, RegWriteW1,
+                    PCSrcW});
+
+  // Hazard prediction
+  assign PCWrPendingF = PCSrcD0 | PCSrcD1 | PCSrcE | PCSrcM;
+endmodule
+
+module decoder(input  logic [31:12] Instr,
+               input  logic         Valid,
+               output logic [1:0]   RegSrc, ImmSrc,
+               output logic         ALUSrc, MemtoReg, RegWrite, MemWrite,
+               output logic         Branch,
+               output logic [1:0]   ALUControl, FlagWrite,
+               output logic         PCSrc);
+
+  logic [9:0] controls;
+  logic       RegW, MemW, Br, ALUOp;
+
+  // Main Decoder (same encoding as arm_single.sv)
+  always_comb
+  	casex(Instr[27:26])
+  	                          // Data processing immediate
+  	  2'b00: if (Instr[25]) controls = 10'b0000101001;
+  	                          // Data processing register
+  	         else           controls = 10'b0000001001;
+  	                          // LDR
+  	  2'b01: if (Instr[20]) controls = 10'b0001111000;
+  	                          // STR
+  	         else           controls = 10'b1001110100;
+  	                          // B
+  	  2'b10:                controls = 10'b0110100010;
+  	                          // Unimplemented
+  	  default:              controls = 10'bx;
+  	endcase
+
+  assign {RegSrc, ImmSrc, ALUSrc, MemtoReg,
+          RegW, MemW, Br, ALUOp} = controls;
+
+  assign RegWrite = RegW & Valid;
+  assign MemWrite = MemW & Valid;
+  assign Branch   = Br   & Valid;
+
+  // ALU Decoder
+  always_comb
+    if (ALUOp) begin                  // which DP Instr?
+      case(Instr[24:21])
+  	    4'b0100: ALUControl = 2'b00; // ADD
+  	    4'b0010: ALUControl = 2'b01; // SUB
+        4'b0000: ALUControl = 2'b10; // AND
+  	    4'b1100: ALUControl = 2'b11; // ORR
+  	    default: ALUControl = 2'bx;  // unimplemented
+      endcase
+      // update flags if S bit is set
+	// (C & V only updated for arith instructions)
+      FlagWrite[1] = Instr[20] & Valid;
+      FlagWrite[0] = Instr[20] & Valid &
+        (ALUControl == 2'b00 | ALUControl == 2'b01);
+    end else begin
+      ALUControl = 2'b00; // add for non-DP instructions
+      FlagWrite  = 2'b00; // don't update Flags
+    end
+
+  // PC Logic
+  // Only register writes to R15 go through Writeback. B is resolved
+  // in Execute and steered by the branch predictor.
+  assign PCSrc = (Instr[15:12] == 4'b1111) & RegWrite;
+endmodule
+
+module conditional(input  logic [3:0] Cond,
+                   input  logic [3:0] Flags, FlagsIn,
+                   input  logic [3:0] ALUFlags,
+                   input  logic [1:0] FlagsWrite,
+                   output logic       CondEx,
+                   output logic [3:0] FlagsNext);
+
+  condcheck cc(Cond, Flags, CondEx);
+
+  // flags are only written by instructions whose condition holds,
+  // on top of FlagsIn
+  assign FlagsNext[3:2] = (FlagsWrite[1] & CondEx) ?
+                          ALUFlags[3:2] : FlagsIn[3:2];
+  assign FlagsNext[1:0] = (FlagsWrite[0] & CondEx) ?
+                          ALUFlags[1:0] : FlagsIn[1:0];
+endmodule
+
+module condcheck(input  logic [3:0] Cond,
+                 input  logic [3:0] Flags,
+                 output logic       CondEx);
+
+  logic neg, zero, carry, overflow, ge;
+
+  assign {neg, zero, carry, overflow} = Flags;
+  assign ge = (neg == overflow);
+
+  always_comb
+    case(Cond)
+      4'b0000: CondEx = zero;             // EQ
+      4'b0001: CondEx = ~zero;            // NE
+      4'b0010: CondEx = carry;            // CS
+      4'b0011: CondEx = ~carry;           // CC
+      4'b0100: CondEx = neg;              // MI
+      4'b0101: CondEx = ~neg;             // PL
+      4'b0110: CondEx = overflow;         // VS
+      4'b0111: CondEx = ~overflow;        // VC
+      4'b1000: CondEx = carry & ~zero;    // HI
+      4'b1001: CondEx = ~(carry & ~zero); // LS
+      4'b1010: CondEx = ge;               // GE
+      4'b1011: CondEx = ~ge;              // LT
+      4'b1100: CondEx = ~zero & ge;       // GT
+      4'b1101: CondEx = ~(~zero & ge);    // LE
+      4'b1110: CondEx = 1'b1;             // Always
+      default: CondEx = 1'bx;             // undefined
+    endcase
+endmodule
+
+module datapath(input  logic        clk, reset,
+                input  logic [1:0]  RegSrcD0, ImmSrcD0,
+                input  logic [1:0]  RegSrcD1, ImmSrcD1,
+                input  logic        ALUSrcE0, ALUSrcE1,
+                input  logic [1:0]  ALUControlE0, ALUControlE1,
+                input  logic        BranchE0, BranchE1, BranchTakenE,
+                input  logic        MemSlotM,
+                input  logic        MemtoRegW0, MemtoRegW1,
+                input  logic        RegWriteW0, RegWriteW1, PCSrcW,
+                output logic [31:0] PCF,
+                input  logic [63:0] InstrF,
+                output logic [31:0] InstrD0, InstrD1,
+                output logic        ValidD0, ValidD1,
+                output logic [31:0] DataAdrM, WriteDataM,
+                input  logic [31:0] ReadDataM,
+                output logic [3:0]  ALUFlagsE0, ALUFlagsE1,
+                // branch predictor interface
+                input  logic        PredTakenF0, PredTakenF1,
+                input  logic [31:0] PredTargetF0, PredTargetF1,
+                input  logic        MispredictE,
+                output logic        PredTakenE,
+                output logic [31:0] PCE, BranchTargetE,
+                // hazard logic
+                output logic [3:0]  RA1D0, RA2D0, RA1D1, RA2D1, WA3D0,
+                output logic [3:0]  RA1E0, RA2E0, RA1E1, RA2E1,
+                output logic [3:0]  WA3E0, WA3E1,
+                output logic [3:0]  WA3M0, WA3M1, WA3W0, WA3W1,
+                input  logic [2:0]  ForwardAE0, ForwardBE0,
+                input  logic [2:0]  ForwardAE1, ForwardBE1,
+                input  logic        SplitD, StallF, StallD, FlushD,
+                input  logic        FlushE, FlushE1);
+
+  logic [31:0] PCPlus8F, PredTargetF, PCnext1F, PCnext2F, PCnextF;
+  logic [31:0] InstrD0n, PCD0n, PCD0, PCD1, PCPlus8D0, PCPlus8D1;
+  logic [31:0] ExtImmD0, ExtImmD1, rd1D0, rd2D0, rd1D1, rd2D1;
+  logic [31:0] rd1E0, rd2E0, ExtImmE0, SrcAE0, SrcBE0, WriteDataE0;
+  logic [31:0] rd1E1, rd2E1, ExtImmE1, SrcAE1, SrcBE1, WriteDataE1;
+  logic [31:0] ALUResultE0, ALUResultE1, PCE0, PCPlus4E, RedirectE;
+  logic [31:0] ALUOutM0, ALUOutM1, WriteDataM0, WriteDataM1;
+  logic [31:0] ReadDataW, ALUOutW0, ALUOutW1, ResultW0, ResultW1;
+  logic        PredTakenF, ValidF1, PredTakenD0, PredTakenD1;
+  logic        ValidD0n, PredTakenD0n, PredTakenE0, PredTakenE1;
+
+  // Fetch stage
+  // predicted target, then PC writes from Writeback, then the
+  // correction of a mispredicted branch in Execute
+  // a predicted taken branch in slot 0 leaves slot 1 empty
+  assign ValidF1 = ~PredTakenF0;
+  assign PredTakenF = PredTakenF0 | PredTakenF1;
+  mux2 #(32)    predtgtmux(PredTargetF1, PredTargetF0, PredTakenF0,
+                           PredTargetF);
+  mux2 #(32)    predmux(PCPlus8F, PredTargetF, PredTakenF, PCnext1F);
+  mux2 #(32)    pcnextmux(PCnext1F, ResultW0, PCSrcW, PCnext2F);
+  mux2 #(32)    branchmux(PCnext2F, RedirectE, MispredictE, PCnextF);
+  flopenr #(32) pcreg(clk, reset, ~StallF, PCnextF, PCF);
+  adder #(32)   pcadd(PCF, 32'h8, PCPlus8F);
+
+  // Decode stage
+  // a split moves slot 1 to slot 0 and empties slot 1
+  // PC+8 is rebuilt from PCD0 because Fetch may already hold a
+  // predicted target
+  mux2     #(32) instr0mux(InstrF[31:0], InstrD1, SplitD, InstrD0n);
+  mux2     #(2)  valid0mux({1'b1, PredTakenF0}, {ValidD1, PredTakenD1},
+                           SplitD, {ValidD0n, PredTakenD0n});
+  mux2     #(32) pcd0mux(PCF, PCD1, SplitD, PCD0n);
+  flopenrc #(32) instr0reg(clk, reset, ~StallD, FlushD,
+                           InstrD0n, InstrD0);
+  flopenrc #(32) instr1reg(clk, reset, ~StallD, FlushD | SplitD,
+                           InstrF[63:32], InstrD1);
+  flopenrc #(2)  pred0reg(clk, reset, ~StallD, FlushD,
+                          {ValidD0n, PredTakenD0n}, {ValidD0, PredTakenD0});
+  flopenrc #(2)  pred1reg(clk, reset, ~StallD, FlushD | SplitD,
+                          {ValidF1, PredTakenF1 & ValidF1},
+                          {ValidD1, PredTakenD1});
+  flopenr  #(32) pcdreg(clk, reset, ~StallD, PCD0n, PCD0);
+  adder    #(32) pcadd4d(PCD0, 32'h4, PCD1);
+  adder    #(32) pcadd8d0(PCD0, 32'h8, PCPlus8D0);
+  adder    #(32) pcadd8d1(PCD1, 32'h8, PCPlus8D1);
+  mux2     #(4)  ra1mux0(InstrD0[19:16], 4'b1111, RegSrcD0[0], RA1D0);
+  mux2     #(4)  ra2mux0(InstrD0[3:0], InstrD0[15:12], RegSrcD0[1], RA2D0);
+  mux2     #(4)  ra1mux1(InstrD1[19:16], 4'b1111, RegSrcD1[0], RA1D1);
+  mux2     #(4)  ra2mux1(InstrD1[3:0], InstrD1[15:12], RegSrcD1[1], RA2D1);
+  assign WA3D0 = InstrD0[15:12];
+  regfile        rf(clk, RegWriteW0, RegWriteW1,
+                    RA1D0, RA2D0, RA1D1, RA2D1,
+                    WA3W0, WA3W1, ResultW0, ResultW1,
+                    PCPlus8D0, PCPlus8D1,
+                    rd1D0, rd2D0, rd1D1, rd2D1);
+  extend         ext0(InstrD0[23:0], ImmSrcD0, ExtImmD0);
+  extend         ext1(InstrD1[23:0], ImmSrcD1, ExtImmD1);
+
+  // Execute stage
+  flopr  #(32) rd1reg0(clk, reset, rd1D0, rd1E0);
+  flopr  #(32) rd2reg0(clk, reset, rd2D0, rd2E0);
+  flopr  #(32) immreg0(clk, reset, ExtImmD0, ExtImmE0);
+  flopr  #(32) rd1reg1(clk, reset, rd1D1, rd1E1);
+  flopr  #(32) rd2reg1(clk, reset, rd2D1, rd2E1);
+  flopr  #(32) immreg1(clk, reset, ExtImmD1, ExtImmE1);
+  flopr  #(32) pcereg(clk, reset, PCD0, PCE0);
+  floprc #(1)  prederreg0(clk, reset, FlushE, PredTakenD0, PredTakenE0);
+  floprc #(1)  prederreg1(clk, reset, FlushE1, PredTakenD1, PredTakenE1);
+  flopr  #(8)  wa3ereg(clk, reset, {InstrD0[15:12], InstrD1[15:12]},
+                       {WA3E0, WA3E1});
+  flopr  #(16) raereg(clk, reset, {RA1D0, RA2D0, RA1D1, RA2D1},
+                      {RA1E0, RA2E0, RA1E1, RA2E1});
+  mux5   #(32) byp1mux0(rd1E0, ResultW0, ResultW1, ALUOutM0, ALUOutM1,
+                        ForwardAE0, SrcAE0);
+  mux5   #(32) byp2mux0(rd2E0, ResultW0, ResultW1, ALUOutM0, ALUOutM1,
+                        ForwardBE0, WriteDataE0);
+  mux5   #(32) byp1mux1(rd1E1, ResultW0, ResultW1, ALUOutM0, ALUOutM1,
+                        ForwardAE1, SrcAE1);
+  mux5   #(32) byp2mux1(rd2E1, ResultW0, ResultW1, ALUOutM0, ALUOutM1,
+                        ForwardBE1, WriteDataE1);
+  mux2   #(32) srcbmux0(WriteDataE0, ExtImmE0, ALUSrcE0, SrcBE0);
+  mux2   #(32) srcbmux1(WriteDataE1, ExtImmE1, ALUSrcE1, SrcBE1);
+  alu          alu0(SrcAE0, SrcBE0, ALUControlE0, ALUResultE0, ALUFlagsE0);
+  alu          alu1(SrcAE1, SrcBE1, ALUControlE1, ALUResultE1, ALUFlagsE1);
+
+  // branch correction: target if taken, fall-through if not
+  // slot 1 of a pair is at PCE0 + 4
+  assign PredTakenE = PredTakenE0 | PredTakenE1;
+  mux2   #(32) brpcmux(PCE0, PCE0 + 32'h4, BranchE1, PCE);
+  mux2   #(32) brtgtmux(ALUResultE0, ALUResultE1, BranchE1, BranchTargetE);
+  adder  #(32) pcadd4e(PCE, 32'h4, PCPlus4E);
+  mux2   #(32) redirmux(PCPlus4E, BranchTargetE, BranchTakenE, RedirectE);
+
+  // Memory stage
+  // the one data port serves the slot holding LDR/STR
+  flopr #(32) aluresreg0(clk, reset, ALUResultE0, ALUOutM0);
+  flopr #(32) aluresreg1(clk, reset, ALUResultE1, ALUOutM1);
+  flopr #(32) wdreg0(clk, reset, WriteDataE0, WriteDataM0);
+  flopr #(32) wdreg1(clk, reset, WriteDataE1, WriteDataM1);
+  flopr #(8)  wa3mreg(clk, reset, {WA3E0, WA3E1}, {WA3M0, WA3M1});
+  mux2  #(32) dadrmux(ALUOutM0, ALUOutM1, MemSlotM, DataAdrM);
+  mux2  #(32) dwdmux(WriteDataM0, WriteDataM1, MemSlotM, WriteDataM);
+
+  // Writeback stage
+  flopr #(32) aluoutreg0(clk, reset, ALUOutM0, ALUOutW0);
+  flopr #(32) aluoutreg1(clk, reset, ALUOutM1, ALUOutW1);
+  flopr #(32) rdreg(clk, reset, ReadDataM, ReadDataW);
+  flopr #(8)  wa3wreg(clk, reset, {WA3M0, WA3M1}, {WA3W0, WA3W1});
+  mux2  #(32) resmux0(ALUOutW0, ReadDataW, MemtoRegW0, ResultW0);
+  mux2  #(32) resmux1(ALUOutW1, ReadDataW, MemtoRegW1, ResultW1);
+endmodule
+
+module hazard(input  logic [3:0] RA1D0, RA2D0, RA1D1, RA2D1, WA3D0,
+              input  logic [3:0] RA1E0, RA2E0, RA1E1, RA2E1,
+              input  logic [3:0] WA3E0, WA3E1,
+              input  logic [3:0] WA3M0, WA3M1, WA3W0, WA3W1,
+              input  logic       ValidD1, RegWriteD0,
+              input  logic       Use1D0, Use2D0, Use1D1, Use2D1,
+              input  logic       MemD0, MemD1, BranchD0, BranchD1,
+              input  logic       FlagSetD0, CondD1, PCSrcD0, PCSrcD1,
+              input  logic       RegWriteM0, RegWriteM1,
+              input  logic       RegWriteW0, RegWriteW1,
+              input  logic       MispredictE, KillE1,
+              input  logic       MemtoRegE0, MemtoRegE1,
+              input  logic       PCWrPendingF, PCSrcW,
+              output logic [2:0] ForwardAE0, ForwardBE0,
+              output logic [2:0] ForwardAE1, ForwardBE1,
+              output logic       DualD, SplitD, StallF, StallD,
+              output logic       FlushD, FlushE, FlushE1);
+
+  logic ldrStallD, DepD;
+
+  // forwarding logic
+  // Memory before Writeback, slot 1 before slot 0 (the younger
+  // result wins)
+  function automatic logic [2:0] forward(input logic [3:0] ra);
+    if      ((ra == WA3M1) & RegWriteM1) forward = 3'b100;
+    else if ((ra == WA3M0) & RegWriteM0) forward = 3'b011;
+    else if ((ra == WA3W1) & RegWriteW1) forward = 3'b010;
+    else if ((ra == WA3W0) & RegWriteW0) forward = 3'b001;
+    else                                 forward = 3'b000;
+  endfunction
+
+  always_comb begin
+    ForwardAE0 = forward(RA1E0);
+    ForwardBE0 = forward(RA2E0);
+    ForwardAE1 = forward(RA1E1);
+    ForwardBE1 = forward(RA2E1);
+  end
+
+  // Load RAW: stall one cycle when a load in Execute feeds either
+  // slot of Decode; a load squashed by a branch in slot 0 feeds nothing
+  function automatic logic readsD(input logic [3:0] wa);
+    readsD = (Use1D0 & (RA1D0 == wa)) | (Use2D0 & (RA2D0 == wa)) |
+             (Use1D1 & (RA1D1 == wa)) | (Use2D1 & (RA2D1 == wa));
+  endfunction
+
+  always_comb
+    ldrStallD = (MemtoRegE0 & readsD(WA3E0)) |
+                (MemtoRegE1 & ~KillE1 & readsD(WA3E1));
+
+  // pairing rules
+  assign DepD  = RegWriteD0 & ((Use1D1 & (RA1D1 == WA3D0)) |
+                               (Use2D1 & (RA2D1 == WA3D0)));
+  assign DualD = ValidD1 & ~DepD & ~(MemD0 & MemD1) &
+                 ~(BranchD0 & BranchD1) & ~(FlagSetD0 & CondD1) &
+                 ~PCSrcD0 & ~PCSrcD1;
+
+  // stalls and flushes
+  // Split: slot 0 issues alone, slot 1 moves up, fetch waits
+  // PC write: stall fetch until the new PC is written in Writeback;
+  //   a PC write in slot 0 drops slot 1
+  // Mispredict: squash Fetch and Decode. The redirect must not be
+  //   held off by a stall caused by a wrong-path instruction in Decode,
+  //   and Decode must not hold: its registers ignore the flush while
+  //   disabled.
+  assign SplitD  = ValidD1 & ~DualD & ~PCSrcD0 & ~ldrStallD &
+                   ~MispredictE;
+
+  assign StallD  = ldrStallD & ~MispredictE;
+  assign StallF  = (ldrStallD | SplitD | PCWrPendingF) & ~MispredictE;
+  assign FlushE  = ldrStallD | MispredictE;
+  assign FlushE1 = FlushE | ~DualD;
+  assign FlushD  = (PCWrPendingF & ~SplitD) | PCSrcW | MispredictE;
+endmodule
+
+module bpred #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                         BHT_BITS  = 6, BTB_BITS = 4)
+              (input  logic        clk, reset,
+               // Fetch stage lookup
+               input  logic [31:0] PCF, InstrF,
+               output logic        PredTakenF,
+               output logic [31:0] PredTargetF,
+               // Execute stage update
+               input  logic [31:0] PCE, BranchTargetE,
+               input  logic        BranchE, BranchTakenE, PredTakenE,
+               output logic        MispredictE);
+
+  localparam BHT_SIZE = 2**BHT_BITS;
+  localparam BTB_SIZE = 2**BTB_BITS;
+  localparam TAG_BITS = 30 - BTB_BITS;
+
+  // branch history table and branch target buffer
+  logic [1:0]          bht[BHT_SIZE-1:0];
+  logic                btbvalid[BTB_SIZE-1:0];
+  logic [TAG_BITS-1:0] btbtag[BTB_SIZE-1:0];
+  logic [31:0]         btbtarget[BTB_SIZE-1:0];
+
+  logic [BHT_BITS-1:0] bhtidxF, bhtidxE;
+  logic [BTB_BITS-1:0] btbidxF, btbidxE;
+  logic                BtbHitF, IsBranchF, CandidateF, TakenF;
+  logic [31:0]         DecTargetF;
+
+  // performance counters
+  logic [31:0]         Predictions, Mispredicts, FlushCycles;
+
+  // Fetch stage lookup
+  assign bhtidxF = PCF[BHT_BITS+1:2];
+  assign btbidxF = PCF[BTB_BITS+1:2];
+  assign BtbHitF = btbvalid[btbidxF] &
+                   (btbtag[btbidxF] == PCF[31:BTB_BITS+2]);
+
+  // predecode: B target is PC + 8 + imm24 << 2
+  assign IsBranchF  = (InstrF[27:26] == 2'b10);
+  assign DecTargetF = PCF + 32'h8 + {{6{InstrF[23]}}, InstrF[23:0], 2'b00};
+
+  // a candidate is a branch we know the target of
+  assign CandidateF  = USE_BTB ? BtbHitF : IsBranchF;
+  assign PredTargetF = USE_BTB ? btbtarget[btbidxF] : DecTargetF;
+
+  // direction
+  always_comb
+    case (BP_SCHEME)
+      1:       TakenF = (PredTargetF <= PCF) |        // backward
+                        (InstrF[31:28] == 4'b1110);   // always
+      2:       TakenF = bht[bhtidxF][1];
+      default: TakenF = 1'b0;
+    endcase
+
+  assign PredTakenF = CandidateF & TakenF;
+
+  // Execute stage resolution
+  assign MispredictE = PredTakenE ^ BranchTakenE;
+
+  // Execute stage update
+  assign bhtidxE = PCE[BHT_BITS+1:2];
+  assign btbidxE = PCE[BTB_BITS+1:2];
+
+  // 2-bit counters start weakly not taken
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      for (int i = 0; i < BHT_SIZE; i++) bht[i]      <= 2'b01;
+      for (int i = 0; i < BTB_SIZE; i++) btbvalid[i] <= 1'b0;
+    end else if (BranchE) begin
+      if (BranchTakenE & (bht[bhtidxE] != 2'b11))
+        bht[bhtidxE] <= bht[bhtidxE] + 2'b01;
+      else if (~BranchTakenE & (bht[bhtidxE] != 2'b00))
+        bht[bhtidxE] <= bht[bhtidxE] - 2'b01;
+      if (BranchTakenE) btbvalid[btbidxE] <= 1'b1;
+    end
+
+  // allocate taken branches in the BTB
+  always_ff @(posedge clk)
+    if (BranchE & BranchTakenE) begin
+      btbtag[btbidxE]    <= PCE[31:BTB_BITS+2];
+      btbtarget[btbidxE] <= BranchTargetE;
+    end
+
+  // a mispredict squashes the instructions in Fetch and Decode
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Predictions <= 0;
+      Mispredicts <= 0;
+      FlushCycles <= 0;
+    end else begin
+      if (BranchE)     Predictions <= Predictions + 1;
+      if (MispredictE) begin
+                       Mispredicts <= Mispredicts + 1;
+                       FlushCycles <= FlushCycles + 2;
+      end
+    end
+endmodule
+
+module regfile(input  logic        clk,
+               input  logic        we0, we1,
+               input  logic [3:0]  ra1, ra2, ra3, ra4, wa0, wa1,
+               input  logic [31:0] wd0, wd1, r15a, r15b,
+               output logic [31:0] rd1, rd2, rd3, rd4);
+
+  logic [31:0] rf[14:0];
+
+  // six ported register file, two read ports and one write port per
+  // slot
+  // read four ports combinationally
+  // write two ports on falling edge of clock (midcycle)
+  //   so that writes can be read on same cycle; slot 1 (port wa1)
+  //   wins if both write the same register
+  // register 15 reads PC+8 of the slot instead
+
+  always_ff @(negedge clk) begin
+    if (we0) rf[wa0] <= wd0;
+    if (we1) rf[wa1] <= wd1;
+  end
+
+  assign rd1 = (ra1 == 4'b1111) ? r15a : rf[ra1];
+  assign rd2 = (ra2 == 4'b1111) ? r15a : rf[ra2];
+  assign rd3 = (ra3 == 4'b1111) ? r15b : rf[ra3];
+  assign rd4 = (ra4 == 4'b1111) ? r15b : rf[ra4];
+endmodule
+
+module extend(input  logic [23:0] Instr,
+              input  logic [1:0]  ImmSrc,
+              output logic [31:0] ExtImm);
+
+  always_comb
+    case(ImmSrc)
+               // 8-bit unsigned immediate
+      2'b00:   ExtImm = {24'b0, Instr[7:0]};
+               // 12-bit unsigned immediate
+      2'b01:   ExtImm = {20'b0, Instr[11:0]};
+               // 24-bit two's complement shifted branch
+      2'b10:   ExtImm = {{6{Instr[23]}}, Instr[23:0], 2'b00};
+      default: ExtImm = 32'bx; // undefined
+    endcase
+endmodule
+
+module adder #(parameter WIDTH=8)
+              (input  logic [WIDTH-1:0] a, b,
+               output logic [WIDTH-1:0] y);
+
+  assign y = a + b;
+endmodule
+
+module flopenr #(parameter WIDTH = 8)
+                (input  logic             clk, reset, en,
+                 input  logic [WIDTH-1:0] d,
+                 output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)   q <= 0;
+    else if (en) q <= d;
+endmodule
+
+module flopr #(parameter WIDTH = 8)
+              (input  logic             clk, reset,
+               input  logic [WIDTH-1:0] d,
+               output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) q <= 0;
+    else       q <= d;
+endmodule
+
+module flopenrc #(parameter WIDTH = 8)
+                 (input  logic             clk, reset, en, clear,
+                  input  logic [WIDTH-1:0] d,
+                  output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)   q <= 0;
+    else if (en)
+      if (clear) q <= 0;
+      else       q <= d;
+endmodule
+
+module floprc #(parameter WIDTH = 8)
+               (input  logic             clk, reset, clear,
+                input  logic [WIDTH-1:0] d,
+                output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)      q <= 0;
+    else
+      if (clear)    q <= 0;
+      else          q <= d;
+endmodule
+
+module mux2 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1,
+              input  logic             s,
+              output logic [WIDTH-1:0] y);
+
+  assign y = s ? d1 : d0;
+endmodule
+
+module mux5 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1, d2, d3, d4,
+              input  logic [2:0]       s,
+              output logic [WIDTH-1:0] y);
+
+  always_comb
+    case(s)
+      3'b000:  y = d0;
+      3'b001:  y = d1;
+      3'b010:  y = d2;
+      3'b011:  y = d3;
+      default: y = d4;
+    endcase
+endmodule
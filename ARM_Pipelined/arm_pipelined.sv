@@ -0,0 +1,665 @@
+// arm_pipelined.sv
+// Five-stage pipelined implementation of a subset of ARMv4
+// Based on the single-cycle and multi-cycle reference code by
+// David_Harris@hmc.edu and Sarah_Harris@hmc.edu
+//
+// run 300
+// Expect simulator to print "Simulation succeeded"
+// when the value 7 is written to address 100 (0x64)
+// Uses the same memfile.dat as ARM_SingleCycle.
+
+// Same instruction subset as arm_single.sv:
+//   ADD, SUB, AND, ORR (immediate and register), LDR, STR, B
+//   R15 reads as PC+8
+//
+// Pipeline:
+//   Fetch / Decode / Execute / Memory / Writeback
+//   Results are forwarded from the Memory and Writeback stages to
+//   Execute. A load followed by a dependent instruction stalls one cycle.
+//   Writes to R15 through the register file stall fetch until the new
+//   PC leaves Writeback.
+//   B is resolved in Execute. A wrong prediction squashes the
+//   instructions in Fetch and Decode (2 cycles).
+//
+// Branch prediction (bpred module), selected by parameters of top:
+//   BP_SCHEME = 0  predict not taken (no prediction hardware)
+//             = 1  static BTFN: backward branches and unconditional
+//                  branches predicted taken, forward branches not taken
+//             = 2  bimodal: table of 2^BHT_BITS 2-bit saturating
+//                  counters indexed by PC[BHT_BITS+1:2]
+//   USE_BTB   = 1  predicted targets come from a direct-mapped branch
+//                  target buffer of 2^BTB_BITS entries. Only branches
+//                  that hit in the BTB are predicted.
+//             = 0  predicted targets come from predecoding the fetched
+//                  instruction (imem is read combinationally in Fetch)
+//
+//   Performance counters in bpred:
+//     Predictions   branches resolved in Execute
+//     Mispredicts   branches whose direction or target was wrong
+//     FlushCycles   issue slots squashed by mispredictions
+//   The testbench prints them with the cycle count when the run ends.
+//   Stores at 128 and above are left to the program, so the
+//   dualbench.dat kernels of arm_dual.sv run here too.
+
+module testbench();
+
+  logic        clk;
+  logic        reset;
+
+  logic [31:0] WriteData, DataAdr;
+  logic        MemWrite;
+  logic [31:0] Cycles;
+
+  // instantiate device to be tested
+  top dut(clk, reset, WriteData, DataAdr, MemWrite);
+
+  // initialize test
+  initial
+    begin
+      reset <= 1; # 22; reset <= 0;
+    end
+
+  // generate clock to sequence tests
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  // count cycles since reset
+  always @(posedge clk)
+    if (reset) Cycles <= 0;
+    else       Cycles <= Cycles + 1;
+
+  // check results
+  always @(negedge clk)
+    begin
+      if(MemWrite) begin
+        if(DataAdr === 100 & WriteData === 7) begin
+          $display("Simulation succeeded");
+          $display("Cycles %0d, Predictions %0d, Mispredicts %0d, FlushCycles %0d",
+                   Cycles, dut.arm.bp.Predictions, dut.arm.bp.Mispredicts,
+                   dut.arm.bp.FlushCycles);
+          $stop;
+        end else if (DataAdr !== 96 & DataAdr < 128) begin
+          $display("Simulation failed");
+          $stop;
+        end
+      end
+    end
+endmodule
+
+module top #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                       BHT_BITS  = 6, BTB_BITS = 4)
+            (input  logic        clk, reset,
+             output logic [31:0] WriteData, DataAdr,
+             output logic        MemWrite);
+
+  logic [31:0] PC, Instr, ReadData;
+
+  // instantiate processor and memories
+  arm #(BP_SCHEME, USE_BTB, BHT_BITS, BTB_BITS)
+      arm(clk, reset, PC, Instr, MemWrite, DataAdr,
+          WriteData, ReadData);
+  imem imem(PC, Instr);
+  dmem dmem(clk, MemWrite, DataAdr, WriteData, ReadData);
+endmodule
+
+module dmem(input  logic        clk, we,
+            input  logic [31:0] a, wd,
+            output logic [31:0] rd);
+
+  logic [31:0] RAM[63:0];
+
+  assign rd = RAM[a[31:2]]; // word aligned
+
+  always_ff @(posedge clk)
+    if (we) RAM[a[31:2]] <= wd;
+endmodule
+
+module imem(input  logic [31:0] a,
+            output logic [31:0] rd);
+
+  logic [31:0] RAM[63:0];
+
+  initial
+      $readmemh("memfile.dat",RAM);
+
+  assign rd = RAM[a[31:2]]; // word aligned
+endmodule
+
+module arm #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                       BHT_BITS  = 6, BTB_BITS = 4)
+            (input  logic        clk, reset,
+             output logic [31:0] PCF,
+             input  logic [31:0] InstrF,
+             output logic        MemWriteM,
+             output logic [31:0] ALUOutM, WriteDataM,
+             input  logic [31:0] ReadDataM);
+
+  logic [1:0]  RegSrcD, ImmSrcD, ALUControlE;
+  logic        ALUSrcE, BranchE, BranchTakenE, MemtoRegW, PCSrcW, RegWriteW;
+  logic [3:0]  ALUFlagsE;
+  logic [31:0] InstrD, PCE, ALUResultE, PredTargetF;
+  logic        RegWriteM, MemtoRegE, PCWrPendingF;
+  logic        PredTakenF, PredTakenE, MispredictE;
+  logic [1:0]  ForwardAE, ForwardBE;
+  logic        StallF, StallD, FlushD, FlushE;
+  logic        Match_1E_M, Match_1E_W, Match_2E_M, Match_2E_W, Match_12D_E;
+
+  controller c(clk, reset, InstrD[31:12], ALUFlagsE,
+               RegSrcD, ImmSrcD,
+               ALUSrcE, BranchE, BranchTakenE, ALUControlE,
+               MemWriteM,
+               MemtoRegW, PCSrcW, RegWriteW,
+               RegWriteM, MemtoRegE, PCWrPendingF,
+               FlushE);
+  datapath dp(clk, reset,
+              RegSrcD, ImmSrcD,
+              ALUSrcE, BranchTakenE, ALUControlE,
+              MemtoRegW, PCSrcW, RegWriteW,
+              PCF, InstrF, InstrD,
+              ALUOutM, WriteDataM, ReadDataM,
+              ALUFlagsE, ALUResultE,
+              PredTakenF, PredTargetF, MispredictE, PredTakenE, PCE,
+              Match_1E_M, Match_1E_W, Match_2E_M, Match_2E_W, Match_12D_E,
+              ForwardAE, ForwardBE, StallF, StallD, FlushD, FlushE);
+  bpred #(BP_SCHEME, USE_BTB, BHT_BITS, BTB_BITS)
+        bp(clk, reset, PCF, InstrF, PredTakenF, PredTargetF,
+           PCE, ALUResultE, BranchE, BranchTakenE, PredTakenE,
+           MispredictE);
+  hazard h(Match_1E_M, Match_1E_W, Match_2E_M, Match_2E_W, Match_12D_E,
+           RegWriteM, RegWriteW, MispredictE, MemtoRegE,
+           PCWrPendingF, PCSrcW,
+           ForwardAE, ForwardBE,
+           StallF, StallD, FlushD, FlushE);
+endmodule
+
+module controller(input  logic         clk, reset,
+                  input  logic [31:12] InstrD,
+                  input  logic [3:0]   ALUFlagsE,
+                  output logic [1:0]   RegSrcD, ImmSrcD,
+                  output logic         ALUSrcE, BranchE, BranchTakenE,
+                  output logic [1:0]   ALUControlE,
+                  output logic         MemWriteM,
+                  output logic         MemtoRegW, PCSrcW, RegWriteW,
+                  // hazard interface
+                  output logic         RegWriteM, MemtoRegE,
+                  output logic         PCWrPendingF,
+                  input  logic         FlushE);
+
+  logic [9:0] controlsD;
+  logic       CondExE, ALUOpD;
+  logic [1:0] ALUControlD;
+  logic       ALUSrcD;
+  logic       MemtoRegD, MemtoRegM;
+  logic       RegWriteD, RegWriteE, RegWriteGatedE;
+  logic       MemWriteD, MemWriteE, MemWriteGatedE;
+  logic       BranchD;
+  logic [1:0] FlagWriteD, FlagWriteE;
+  logic       PCSrcD, PCSrcE, PCSrcGatedE, PCSrcM;
+  logic [3:0] FlagsE, FlagsNextE, CondE;
+
+  // Decode stage
+  // Main Decoder (same encoding as arm_single.sv)
+  always_comb
+  	casex(InstrD[27:26])
+  	                           // Data processing immediate
+  	  2'b00: if (InstrD[25]) controlsD = 10'b0000101001;
+  	                           // Data processing register
+  	         else            controlsD = 10'b0000001001;
+  	                           // LDR
+  	  2'b01: if (InstrD[20]) controlsD = 10'b0001111000;
+  	                           // STR
+  	         else            controlsD = 10'b1001110100;
+  	                           // B
+  	  2'b10:                 controlsD = 10'b0110100010;
+  	                           // Unimplemented
+  	  default:               controlsD = 10'bx;
+  	endcase
+
+  assign {RegSrcD, ImmSrcD, ALUSrcD, MemtoRegD,
+          RegWriteD, MemWriteD, BranchD, ALUOpD} = controlsD;
+
+  // ALU Decoder
+  always_comb
+    if (ALUOpD) begin                  // which DP Instr?
+      case(InstrD[24:21])
+  	    4'b0100: ALUControlD = 2'b00; // ADD
+  	    4'b0010: ALUControlD = 2'b01; // SUB
+        4'b0000: ALUControlD = 2'b10; // AND
+  	    4'b1100: ALUControlD = 2'b11; // ORR
+  	    default: ALUControlD = 2'bx;  // unimplemented
+      endcase
+      // update flags if S bit is set
+	// (C & V only updated for arith instructions)
+      FlagWriteD[1] = InstrD[20];
+      FlagWriteD[0] = InstrD[20] &
+        (ALUControlD == 2'b00 | ALUControlD == 2'b01);
+    end else begin
+      ALUControlD = 2'b00; // add for non-DP instructions
+      FlagWriteD  = 2'b00; // don't update Flags
+    end
+
+  // PC Logic
+  // Only register writes to R15 go through Writeback. B is resolved
+  // in Execute and steered by the branch predictor.
+  assign PCSrcD = (InstrD[15:12] == 4'b1111) & RegWriteD;
+
+  // Execute stage
+  floprc #(7) flushedregsE(clk, reset, FlushE,
+                           {FlagWriteD, BranchD, MemWriteD,
+                            RegWriteD, PCSrcD, MemtoRegD},
+                           {FlagWriteE, BranchE, MemWriteE,
+                            RegWriteE, PCSrcE, MemtoRegE});
+  flopr  #(3) regsE(clk, reset,
+                    {ALUSrcD, ALUControlD},
+                    {ALUSrcE, ALUControlE});
+  flopr  #(4) condregE(clk, reset, InstrD[31:28], CondE);
+  flopr  #(4) flagsreg(clk, reset, FlagsNextE, FlagsE);
+
+  // write and Branch controls are conditional
+  conditional cond(CondE, FlagsE, ALUFlagsE, FlagWriteE,
+                   CondExE, FlagsNextE);
+  assign BranchTakenE   = BranchE   & CondExE;
+  assign RegWriteGatedE = RegWriteE & CondExE;
+  assign MemWriteGatedE = MemWriteE & CondExE;
+  assign PCSrcGatedE    = PCSrcE    & CondExE;
+
+  // Memory stage
+  flopr #(4) regsM(clk, reset,
+                   {MemWriteGatedE, MemtoRegE, RegWriteGatedE, PCSrcGatedE},
+                   {MemWriteM, MemtoRegM, RegWriteM, PCSrcM});
+
+  // Writeback stage
+  flopr #(3) regsW(clk, reset,
+                   {MemtoRegM, RegWriteM, PCSrcM},
+                   {MemtoRegW, RegWriteW, PCSrcW});
+
+  // Hazard prediction
+  assign PCWrPendingF = PCSrcD | PCSrcE | PCSrcM;
+endmodule
+
+module conditional(input  logic [3:0] Cond,
+                   input  logic [3:0] Flags,
+                   input  logic [3:0] ALUFlags,
+                   input  logic [1:0] FlagsWrite,
+                   output logic       CondEx,
+                   output logic [3:0] FlagsNext);
+
+  condcheck cc(Cond, Flags, CondEx);
+
+  // flags are only written by instructions whose condition holds
+  assign FlagsNext[3:2] = (FlagsWrite[1] & CondEx) ?
+                          ALUFlags[3:2] : Flags[3:2];
+  assign FlagsNext[1:0] = (FlagsWrite[0] & CondEx) ?
+                          ALUFlags[1:0] : Flags[1:0];
+endmodule
+
+module condcheck(input  logic [3:0] Cond,
+                 input  logic [3:0] Flags,
+                 output logic       CondEx);
+
+  logic neg, zero, carry, overflow, ge;
+
+  assign {neg, zero, carry, overflow} = Flags;
+  assign ge = (neg == overflow);
+
+  always_comb
+    case(Cond)
+      4'b0000: CondEx = zero;             // EQ
+      4'b0001: CondEx = ~zero;            // NE
+      4'b0010: CondEx = carry;            // CS
+      4'b0011: CondEx = ~carry;           // CC
+      4'b0100: CondEx = neg;              // MI
+      4'b0101: CondEx = ~neg;             // PL
+      4'b0110: CondEx = overflow;         // VS
+      4'b0111: CondEx = ~overflow;        // VC
+      4'b1000: CondEx = carry & ~zero;    // HI
+      4'b1001: CondEx = ~(carry & ~zero); // LS
+      4'b1010: CondEx = ge;               // GE
+      4'b1011: CondEx = ~ge;              // LT
+      4'b1100: CondEx = ~zero & ge;       // GT
+      4'b1101: CondEx = ~(~zero & ge);    // LE
+      4'b1110: CondEx = 1'b1;             // Always
+      default: CondEx = 1'bx;             // undefined
+    endcase
+endmodule
+
+module datapath(input  logic        clk, reset,
+                input  logic [1:0]  RegSrcD, ImmSrcD,
+                input  logic        ALUSrcE, BranchTakenE,
+                input  logic [1:0]  ALUControlE,
+                input  logic        MemtoRegW, PCSrcW, RegWriteW,
+                output logic [31:0] PCF,
+                input  logic [31:0] InstrF,
+                output logic [31:0] InstrD,
+                output logic [31:0] ALUOutM, WriteDataM,
+                input  logic [31:0] ReadDataM,
+                output logic [3:0]  ALUFlagsE,
+                output logic [31:0] ALUResultE,
+                // branch predictor interface
+                input  logic        PredTakenF,
+                input  logic [31:0] PredTargetF,
+                input  logic        MispredictE,
+                output logic        PredTakenE,
+                output logic [31:0] PCE,
+                // hazard logic
+                output logic        Match_1E_M, Match_1E_W,
+                                    Match_2E_M, Match_2E_W, Match_12D_E,
+                input  logic [1:0]  ForwardAE, ForwardBE,
+                input  logic        StallF, StallD, FlushD, FlushE);
+
+  logic [31:0] PCPlus4F, PCnext1F, PCnext2F, PCnextF;
+  logic [31:0] PCD, ExtImmD, rd1D, rd2D, PCPlus8D;
+  logic [31:0] rd1E, rd2E, ExtImmE, SrcAE, SrcBE, WriteDataE;
+  logic [31:0] PCPlus4E, RedirectE;
+  logic [31:0] ReadDataW, ALUOutW, ResultW;
+  logic [3:0]  RA1D, RA2D, RA1E, RA2E, WA3E, WA3M, WA3W;
+  logic        PredTakenD;
+  logic        Match_1D_E, Match_2D_E;
+
+  // Fetch stage
+  // predicted target, then PC writes from Writeback, then the
+  // correction of a mispredicted branch in Execute
+  mux2 #(32)    predmux(PCPlus4F, PredTargetF, PredTakenF, PCnext1F);
+  mux2 #(32)    pcnextmux(PCnext1F, ResultW, PCSrcW, PCnext2F);
+  mux2 #(32)    branchmux(PCnext2F, RedirectE, MispredictE, PCnextF);
+  flopenr #(32) pcreg(clk, reset, ~StallF, PCnextF, PCF);
+  adder #(32)   pcadd(PCF, 32'h4, PCPlus4F);
+
+  // Decode stage
+  // PC+8 is rebuilt from PCD because Fetch may already hold a
+  // predicted target rather than PCD+4
+  flopenrc #(32) instrreg(clk, reset, ~StallD, FlushD, InstrF, InstrD);
+  flopenrc #(1)  predreg(clk, reset, ~StallD, FlushD,
+                         PredTakenF, PredTakenD);
+  flopenr  #(32) pcdreg(clk, reset, ~StallD, PCF, PCD);
+  adder    #(32) pcadd8(PCD, 32'h8, PCPlus8D);
+  mux2     #(4)  ra1mux(InstrD[19:16], 4'b1111, RegSrcD[0], RA1D);
+  mux2     #(4)  ra2mux(InstrD[3:0], InstrD[15:12], RegSrcD[1], RA2D);
+  regfile        rf(clk, RegWriteW, RA1D, RA2D,
+                    WA3W, ResultW, PCPlus8D,
+                    rd1D, rd2D);
+  extend         ext(InstrD[23:0], ImmSrcD, ExtImmD);
+
+  // Execute stage
+  flopr  #(32) rd1reg(clk, reset, rd1D, rd1E);
+  flopr  #(32) rd2reg(clk, reset, rd2D, rd2E);
+  flopr  #(32) immreg(clk, reset, ExtImmD, ExtImmE);
+  flopr  #(32) pcereg(clk, reset, PCD, PCE);
+  floprc #(1)  prederreg(clk, reset, FlushE, PredTakenD, PredTakenE);
+  flopr  #(4)  wa3ereg(clk, reset, InstrD[15:12], WA3E);
+  flopr  #(4)  ra1reg(clk, reset, RA1D, RA1E);
+  flopr  #(4)  ra2reg(clk, reset, RA2D, RA2E);
+  mux3   #(32) byp1mux(rd1E, ResultW, ALUOutM, ForwardAE, SrcAE);
+  mux3   #(32) byp2mux(rd2E, ResultW, ALUOutM, ForwardBE, WriteDataE);
+  mux2   #(32) srcbmux(WriteDataE, ExtImmE, ALUSrcE, SrcBE);
+  alu          alu(SrcAE, SrcBE, ALUControlE, ALUResultE, ALUFlagsE);
+
+  // branch correction: target if taken, fall-through if not
+  adder  #(32) pcadd4e(PCE, 32'h4, PCPlus4E);
+  mux2   #(32) redirmux(PCPlus4E, ALUResultE, BranchTakenE, RedirectE);
+
+  // Memory stage
+  flopr #(32) aluresreg(clk, reset, ALUResultE, ALUOutM);
+  flopr #(32) wdreg(clk, reset, WriteDataE, WriteDataM);
+  flopr #(4)  wa3mreg(clk, reset, WA3E, WA3M);
+
+  // Writeback stage
+  flopr #(32) aluoutreg(clk, reset, ALUOutM, ALUOutW);
+  flopr #(32) rdreg(clk, reset, ReadDataM, ReadDataW);
+  flopr #(4)  wa3wreg(clk, reset, WA3M, WA3W);
+  mux2  #(32) resmux(ALUOutW, ReadDataW, MemtoRegW, ResultW);
+
+  // hazard comparison
+  eqcmp #(4) m0(WA3M, RA1E, Match_1E_M);
+  eqcmp #(4) m1(WA3W, RA1E, Match_1E_W);
+  eqcmp #(4) m2(WA3M, RA2E, Match_2E_M);
+  eqcmp #(4) m3(WA3W, RA2E, Match_2E_W);
+  eqcmp #(4) m4a(WA3E, RA1D, Match_1D_E);
+  eqcmp #(4) m4b(WA3E, RA2D, Match_2D_E);
+  assign Match_12D_E = Match_1D_E | Match_2D_E;
+endmodule
+
+module hazard(input  logic       Match_1E_M, Match_1E_W,
+                                 Match_2E_M, Match_2E_W, Match_12D_E,
+              input  logic       RegWriteM, RegWriteW,
+              input  logic       MispredictE, MemtoRegE,
+              input  logic       PCWrPendingF, PCSrcW,
+              output logic [1:0] ForwardAE, ForwardBE,
+              output logic       StallF, StallD,
+              output logic       FlushD, FlushE);
+
+  logic ldrStallD;
+
+  // forwarding logic
+  always_comb begin
+    if      (Match_1E_M & RegWriteM) ForwardAE = 2'b10;
+    else if (Match_1E_W & RegWriteW) ForwardAE = 2'b01;
+    else                             ForwardAE = 2'b00;
+
+    if      (Match_2E_M & RegWriteM) ForwardBE = 2'b10;
+    else if (Match_2E_W & RegWriteW) ForwardBE = 2'b01;
+    else                             ForwardBE = 2'b00;
+  end
+
+  // stalls and flushes
+  // Load RAW: stall one cycle when a load in Execute feeds Decode
+  // PC write: stall fetch until the new PC is written in Writeback
+  // Mispredict: squash Fetch and Decode. The redirect must not be
+  //   held off by a stall caused by a wrong-path instruction in Decode.
+  assign ldrStallD = Match_12D_E & MemtoRegE;
+
+  assign StallD = ldrStallD;
+  assign StallF = (ldrStallD | PCWrPendingF) & ~MispredictE;
+  assign FlushE = ldrStallD | MispredictE;
+  assign FlushD = PCWrPendingF | PCSrcW | MispredictE;
+endmodule
+
+module bpred #(parameter BP_SCHEME = 2, USE_BTB = 1,
+                         BHT_BITS  = 6, BTB_BITS = 4)
+              (input  logic        clk, reset,
+               // Fetch stage lookup
+               input  logic [31:0] PCF, InstrF,
+               output logic        PredTakenF,
+               output logic [31:0] PredTargetF,
+               // Execute stage update
+               input  logic [31:0] PCE, BranchTargetE,
+               input  logic        BranchE, BranchTakenE, PredTakenE,
+               output logic        MispredictE);
+
+  localparam BHT_SIZE = 2**BHT_BITS;
+  localparam BTB_SIZE = 2**BTB_BITS;
+  localparam TAG_BITS = 30 - BTB_BITS;
+
+  // branch history table and branch target buffer
+  logic [1:0]          bht[BHT_SIZE-1:0];
+  logic                btbvalid[BTB_SIZE-1:0];
+  logic [TAG_BITS-1:0] btbtag[BTB_SIZE-1:0];
+  logic [31:0]         btbtarget[BTB_SIZE-1:0];
+
+  logic [BHT_BITS-1:0] bhtidxF, bhtidxE;
+  logic [BTB_BITS-1:0] btbidxF, btbidxE;
+  logic                BtbHitF, IsBranchF, CandidateF, TakenF;
+  logic [31:0]         DecTargetF;
+
+  // performance counters
+  logic [31:0]         Predictions, Mispredicts, FlushCycles;
+
+  // Fetch stage lookup
+  assign bhtidxF = PCF[BHT_BITS+1:2];
+  assign btbidxF = PCF[BTB_BITS+1:2];
+  assign BtbHitF = btbvalid[btbidxF] &
+                   (btbtag[btbidxF] == PCF[31:BTB_BITS+2]);
+
+  // predecode: B target is PC + 8 + imm24 << 2
+  assign IsBranchF  = (InstrF[27:26] == 2'b10);
+  assign DecTargetF = PCF + 32'h8 + {{6{InstrF[23]}}, InstrF[23:0], 2'b00};
+
+  // a candidate is a branch we know the target of
+  assign CandidateF  = USE_BTB ? BtbHitF : IsBranchF;
+  assign PredTargetF = USE_BTB ? btbtarget[btbidxF] : DecTargetF;
+
+  // direction
+  always_comb
+    case (BP_SCHEME)
+      1:       TakenF = (PredTargetF <= PCF) |        // backward
+                        (InstrF[31:28] == 4'b1110);   // always
+      2:       TakenF = bht[bhtidxF][1];
+      default: TakenF = 1'b0;
+    endcase
+
+  assign PredTakenF = CandidateF & TakenF;
+
+  // Execute stage resolution
+  assign MispredictE = PredTakenE ^ BranchTakenE;
+
+  // Execute stage update
+  assign bhtidxE = PCE[BHT_BITS+1:2];
+  assign btbidxE = PCE[BTB_BITS+1:2];
+
+  // 2-bit counters start weakly not taken
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      for (int i = 0; i < BHT_SIZE; i++) bht[i]      <= 2'b01;
+      for (int i = 0; i < BTB_SIZE; i++) btbvalid[i] <= 1'b0;
+    end else if (BranchE) begin
+      if (BranchTakenE & (bht[bhtidxE] != 2'b11))
+        bht[bhtidxE] <= bht[bhtidxE] + 2'b01;
+      else if (~BranchTakenE & (bht[bhtidxE] != 2'b00))
+        bht[bhtidxE] <= bht[bhtidxE] - 2'b01;
+      if (BranchTakenE) btbvalid[btbidxE] <= 1'b1;
+    end
+
+  // allocate taken branches in the BTB
+  always_ff @(posedge clk)
+    if (BranchE & BranchTakenE) begin
+      btbtag[btbidxE]    <= PCE[31:BTB_BITS+2];
+      btbtarget[btbidxE] <= BranchTargetE;
+    end
+
+  // a mispredict squashes the instructions in Fetch and Decode
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Predictions <= 0;
+      Mispredicts <= 0;
+      FlushCycles <= 0;
+    end else begin
+      if (BranchE)     Predictions <= Predictions + 1;
+      if (MispredictE) begin
+                       Mispredicts <= Mispredicts + 1;
+                       FlushCycles <= FlushCycles + 2;
+      end
+    end
+endmodule
+
+module regfile(input  logic        clk,
+               input  logic        we3,
+               input  logic [3:0]  ra1, ra2, wa3,
+               input  logic [31:0] wd3, r15,
+               output logic [31:0] rd1, rd2);
+
+  logic [31:0] rf[14:0];
+
+  // three ported register file
+  // read two ports combinationally
+  // write third port on falling edge of clock (midcycle)
+  //   so that writes can be read on same cycle
+  // register 15 reads PC+8 instead
+
+  always_ff @(negedge clk)
+    if (we3) rf[wa3] <= wd3;
+
+  assign rd1 = (ra1 == 4'b1111) ? r15 : rf[ra1];
+  assign rd2 = (ra2 == 4'b1111) ? r15 : rf[ra2];
+endmodule
+
+module extend(input  logic [23:0] Instr,
+              input  logic [1:0]  ImmSrc,
+              output logic [31:0] ExtImm);
+
+  always_comb
+    case(ImmSrc)
+               // 8-bit unsigned immediate
+      2'b00:   ExtImm = {24'b0, Instr[7:0]};
+               // 12-bit unsigned immediate
+      2'b01:   ExtImm = {20'b0, Instr[11:0]};
+               // 24-bit two's complement shifted branch
+      2'b10:   ExtImm = {{6{Instr[23]}}, Instr[23:0], 2'b00};
+      default: ExtImm = 32'bx; // undefined
+    endcase
+endmodule
+
+module adder #(parameter WIDTH=8)
+              (input  logic [WIDTH-1:0] a, b,
+               output logic [WIDTH-1:0] y);
+
+  assign y = a + b;
+endmodule
+
+module flopenr #(parameter WIDTH = 8)
+                (input  logic             clk, reset, en,
+                 input  logic [WIDTH-1:0] d,
+                 output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)   q <= 0;
+    else if (en) q <= d;
+endmodule
+
+module flopr #(parameter WIDTH = 8)
+              (input  logic             clk, reset,
+               input  logic [WIDTH-1:0] d,
+               output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) q <= 0;
+    else       q <= d;
+endmodule
+
+module flopenrc #(parameter WIDTH = 8)
+                 (input  logic             clk, reset, en, clear,
+                  input  logic [WIDTH-1:0] d,
+                  output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)   q <= 0;
+    else if (en)
+      if (clear) q <= 0;
+      else       q <= d;
+endmodule
+
+module floprc #(parameter WIDTH = 8)
+               (input  logic             clk, reset, clear,
+                input  logic [WIDTH-1:0] d,
+                output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)      q <= 0;
+    else
+      if (clear)    q <= 0;
+      else          q <= d;
+endmodule
+
+module eqcmp #(parameter WIDTH = 8)
+              (input  logic [WIDTH-1:0] a, b,
+               output logic             y);
+
+  assign y = (a == b);
+endmodule
+
+module mux2 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1,
+              input  logic             s,
+              output logic [WIDTH-1:0] y);
+
+  assign y = s ? d1 : d0;
+endmodule
+
+module mux3 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1, d2,
+              input  logic [1:0]       s,
+              output logic [WIDTH-1:0] y);
+
+  assign y = s[1] ? d2 : (s[0] ? d1 : d0);
+endmodule
@@ -0,0 +1,69 @@
+// dualbench.asm
+// Kernels for the dual-issue core (arm_dual.sv), in the subset of
+// arm_pipelined.sv (ADD, SUB, AND, ORR, LDR, STR, B):
+//   FILL  stores a[i] = 1 + 3i for 32 words at 128; the store pairs
+//         with the loop counter, the pointer with the value
+//   MISP  two mispredicted BEQs (cold, forward) paired with an LDR of
+//         R1, first as LDR/BEQ, then as BEQ/killed LDR; the wrong-path
+//         pair behind each reads R1 and must be squashed, not issued
+//         after the load stall. Any leak makes R12 nonzero
+//   SUM   adds the array two words at a time into two sums, loads
+//         scheduled two pairs ahead of their use
+//   FIB   20 Fibonacci steps: every pair depends on itself and the
+//         SUBS/BNE pair hits the flag interlock, so each splits
+// It writes y = F(42) = 267914296 to address 96 and, if the array sum
+// is 1520 and R12 = 0, the value 7 to address 100. The data at 128-255 goes to
+// dmem; instruction and data memories are separate.
+
+// dualbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          ADD  R4, R0, #128        ; R4 = p = a, 32 words at 128      E2804080 0x04
+//          ADD  R5, R0, #1          ; R5 = v                           E2805001 0x08
+//          ADD  R8, R0, #32         ; R8 = n                           E2808020 0x0c
+// FILL     STR  R5, [R4]            ; a[i] = 1 + 3i                    E5845000 0x10
+//          SUBS R8, R8, #1          ;                                  E2588001 0x14
+//          ADD  R4, R4, #4          ;                                  E2844004 0x18
+//          ADD  R5, R5, #3          ;                                  E2855003 0x1c
+//          BNE  FILL                ;                                  1AFFFFFA 0x20
+//          SUBS R12, R0, #0         ; R12 = 0, Z = 1 for the BEQs      E250C000 0x24
+//          BEQ  MISP1               ; mispredicted: fetch from MISP1   0A000000 0x28
+//          ADD  R12, R12, #1        ; wrong path                       E28CC001 0x2c
+// MISP1    LDR  R1, [R0, #128]      ; slot 0: R1 = a[0] = 1            E5901080 0x30
+//          BEQ  MISP2               ; slot 1: mispredicted             0A000001 0x34
+//          ADD  R12, R1, #1         ; wrong path, reads R1: squash     E281C001 0x38
+//          ADD  R12, R12, #1        ; wrong path                       E28CC001 0x3c
+// MISP2    BEQ  MISPOK              ; slot 0: mispredicted             0A000002 0x40
+//          LDR  R1, [R0, #128]      ; slot 1: killed                   E5901080 0x44
+//          ADD  R12, R1, #1         ; wrong path, reads R1: squash     E281C001 0x48
+//          ADD  R12, R12, #1        ; wrong path                       E28CC001 0x4c
+// MISPOK   ADD  R4, R0, #128        ; R4 = p = a                       E2804080 0x50
+//          ADD  R8, R0, #16         ; R8 = n / 2                       E2808010 0x54
+//          ADD  R9, R0, #0          ; R9 = s0                          E2809000 0x58
+//          ADD  R10, R0, #0         ; R10 = s1                         E280A000 0x5c
+//          ADD  R7, R0, #0          ;                                  E2807000 0x60
+// SUM      LDR  R6, [R4]            ; two words per iteration          E5946000 0x64
+//          ADD  R10, R10, R7        ; s1 += odd word of the last iteration E08AA007 0x68
+//          LDR  R7, [R4, #4]        ;                                  E5947004 0x6c
+//          SUBS R8, R8, #1          ;                                  E2588001 0x70
+//          ADD  R9, R9, R6          ; s0 += even word                  E0899006 0x74
+//          ADD  R4, R4, #8          ;                                  E2844008 0x78
+//          BNE  SUM                 ;                                  1AFFFFF8 0x7c
+//          ADD  R10, R10, R7        ; s1 += last odd word              E08AA007 0x80
+//          ADD  R2, R0, #1          ; R2 = x                           E2802001 0x84
+//          ADD  R3, R0, #1          ; R3 = y                           E2803001 0x88
+//          ADD  R8, R0, #20         ;                                  E2808014 0x8c
+// FIB      ADD  R2, R2, R3          ; x = x + y                        E0822003 0x90
+//          ADD  R3, R3, R2          ; y = y + x, needs x: split        E0833002 0x94
+//          SUBS R8, R8, #1          ;                                  E2588001 0x98
+//          BNE  FIB                 ; needs the flags: split           1AFFFFFB 0x9c
+//          STR  R3, [R0, #96]       ; mem[96] = y = F(42)              E5803060 0xa0
+//          ADD  R11, R9, R10        ; R11 = s0 + s1 = 1520             E089B00A 0xa4
+//          ADD  R11, R11, R12       ; + R12, 0 unless a squash failed  E08BB00C 0xa8
+//          SUB  R11, R11, #255      ;                                  E24BB0FF 0xac
+//          SUB  R11, R11, #255      ;                                  E24BB0FF 0xb0
+//          SUB  R11, R11, #255      ;                                  E24BB0FF 0xb4
+//          SUB  R11, R11, #255      ;                                  E24BB0FF 0xb8
+//          SUB  R11, R11, #255      ;                                  E24BB0FF 0xbc
+//          SUB  R11, R11, #238      ; R11 = 1520 - 1513 = 7            E24BB0EE 0xc0
+//          STR  R11, [R0, #100]     ; mem[100] = 7                     E580B064 0xc4
@@ -8,34 +8,60 @@
 
 // 16 32-bit registers
 // Data-processing instructions
-//   ADD, SUB, AND, ORR
+//   ADD, SUB, AND, ORR, MOV
 //   INSTR<cond><S> rd, rn, #immediate
-//   INSTR<cond><S> rd, rn, rm
+//   INSTR<cond><S> rd, rn, rm {, <shift> #shamt5}
+//   INSTR<cond><S> rd, rn, rm, <shift> rs
 //    rd <- rn INSTR rm	      if (S) Update Status Flags
 //    rd <- rn INSTR immediate	if (S) Update Status Flags
+//    MOV ignores rn: rd <- immediate / shifted rm
 //   Instr[31:28] = cond
 //   Instr[27:26] = op = 00
 //   Instr[25:20] = funct
 //                  [25]:    1 for immediate, 0 for register
 //                  [24:21]: 0100 (ADD) / 0010 (SUB) /
-//                           0000 (AND) / 1100 (ORR)
+//                           0000 (AND) / 1100 (ORR) / 1101 (MOV)
 //                  [20]:    S (1 = update CPSR status Flags)
 //   Instr[19:16] = rn
 //   Instr[15:12] = rd
-//   Instr[11:8]  = 0000
-//   Instr[7:0]   = imm8      (for #immediate type) / 
-//                  {0000,rm} (for register type)
+//   Instr[11:0]  = {rot, imm8}             (for #immediate type)
+//                  {shamt5, sh, 0, rm}     (for register type)
+//                  {rs, 0, sh, 1, rm}      (for register-shifted type)
+//    immediate = imm8 rotated right by 2*rot
+//    sh: 00 (LSL) / 01 (LSR) / 10 (ASR) / 11 (ROR)
+//    LSR #0 and ASR #0 shift by 32, ROR #0 (RRX) is not supported
+//    the shifter carry out is not written to C: logical instructions
+//    leave C and V unchanged
 //   
+// Multiply instructions
+//   MUL, MLA, UMULL
+//   MUL<cond><S>   rd, rm, rs         rd <- rm * rs
+//   MLA<cond><S>   rd, rm, rs, ra     rd <- rm * rs + ra
+//   UMULL<cond><S> rdlo, rdhi, rm, rs {rdhi, rdlo} <- rm * rs (unsigned)
+//    if (S) update N and Z (C and V unchanged)
+//   Instr[31:28] = cond
+//   Instr[27:24] = 0000
+//   Instr[23:20] = 000S (MUL) / 001S (MLA) / 100S (UMULL)
+//   Instr[19:16] = rd / rdhi
+//   Instr[15:12] = ra / rdlo (0000 for MUL)
+//   Instr[11:8]  = rs
+//   Instr[7:4]   = 1001
+//   Instr[3:0]   = rm
+//   The multiplier is combinational; UMULL writes both halves in one
+//   cycle through a second register file write port.
+//
 // Load/Store instructions
-//   LDR, STR
+//   LDR, STR, LDRB, STRB
 //   INSTR rd, [rn, #offset]
-//    LDR: rd <- Mem[rn+offset]
-//    STR: Mem[rn+offset] <- rd
+//    LDR:  rd <- Mem[rn+offset]
+//    STR:  Mem[rn+offset] <- rd
+//    LDRB: rd <- zero extended byte Mem[rn+offset]
+//    STRB: byte Mem[rn+offset] <- rd[7:0]
 //   Instr[31:28] = cond
 //   Instr[27:26] = op = 01 
 //   Instr[25:20] = funct
 //                  [25]:    0 (A)
-//                  [24:21]: 1100 (P/U/B/W)
+//                  [24:21]: 1100 (P/U/B/W), B = 1 for LDRB/STRB
 //                  [20]:    L (1 for LDR, 0 for STR)
 //   Instr[19:16] = rn
 //   Instr[15:12] = rd
@@ -72,8 +98,31 @@
 //    1100  Signed greater                N = V & Z = 0
 //    1101  Signed less/equal             N != V | Z = 1
 //    1110  Always                        any
-
-module testbench();
+//
+// Performance monitoring unit (pmu)
+//   Mapped at PMU_BASE = 0xFFFFFF00 in the data address space.
+//   Reach it with SUB Rn, R0, #255 ; SUB Rn, Rn, #1 (Rn = 0xFFFFFF00)
+//   Offset  Name      Counts
+//    0x00   PMCR      bit 0: enable (1 at reset), writing bit 1 clears
+//    0x04   CYCLES    clock cycles
+//    0x08   INSTRET   retired instructions (condition failed included)
+//    0x0C   BRANCHES  taken branches and writes to R15
+//    0x10   CONDFAIL  instructions whose condition failed
+//    0x14   LOADS     executed LDR/LDRB
+//    0x18   STORES    executed STR/STRB
+//   CPI = CYCLES / INSTRET (always 1 on this core)
+//
+// Memories
+//   imem and dmem hold MEM_BYTES bytes (a power of two) starting at
+//   MEM_BASE; set both as parameters of testbench/top. Addresses wrap
+//   inside the memory, which must not reach the PMU page.
+//   dmem takes a byte enable per lane, STRB drives rd[7:0] on all lanes.
+//   imem loads memfile.dat by default. Compiled with +define+MEMLOAD_DPI,
+//   +incdir+../SimLoader and SimLoader/memload.c, +image=<file> loads an
+//   ELF (at its load addresses) or raw binary (at MEM_BASE) into both
+//   memories instead.
+
+module testbench #(parameter MEM_BASE = 32'h0, MEM_BYTES = 256)();
 
   logic        clk;
   logic        reset;
@@ -82,7 +131,7 @@ module testbench();
   logic        MemWrite;
 
   // instantiate device to be tested
-  top dut(clk, reset, WriteData, DataAdr, MemWrite);
+  top #(MEM_BASE, MEM_BYTES) dut(clk, reset, WriteData, DataAdr, MemWrite);
   
   // initialize test
   initial
@@ -102,8 +151,11 @@ module testbench();
       if(MemWrite) begin
         if(DataAdr === 100 & WriteData === 7) begin
           $display("Simulation succeeded");
+          $display("CYCLES %0d INSTRET %0d BRANCHES %0d CONDFAIL %0d LOADS %0d STORES %0d",
+                   dut.pmu.Cycles, dut.pmu.InstRet, dut.pmu.Branches,
+                   dut.pmu.CondFail, dut.pmu.Loads, dut.pmu.Stores);
           $stop;
-        end else if (DataAdr !== 96) begin
+        end else if (DataAdr !== 96 & DataAdr < 256) begin
           $display("Simulation failed");
           $stop;
         end
@@ -111,40 +163,117 @@ module testbench();
     end
 endmodule
 
-module top(input  logic        clk, reset, 
-           output logic [31:0] WriteData, DataAdr, 
-           output logic        MemWrite);
+module top #(parameter MEM_BASE = 32'h0, MEM_BYTES = 256)
+           (input  logic        clk, reset, 
+            output logic [31:0] WriteData, DataAdr, 
+            output logic        MemWrite);
 
-  logic [31:0] PC, Instr, ReadData;
+  logic [31:0] PC, Instr, ReadData, MemReadData, PmuReadData;
+  logic [3:0]  Events, ByteEn;
+  logic        PmuSel;
   
   // instantiate processor and memories
   arm arm(clk, reset, PC, Instr, MemWrite, DataAdr, 
-          WriteData, ReadData);
-  imem imem(PC, Instr);
-  dmem dmem(clk, MemWrite, DataAdr, WriteData, ReadData);
+          WriteData, ByteEn, ReadData, Events);
+  imem #(MEM_BASE, MEM_BYTES) imem(PC, Instr);
+  dmem #(MEM_BASE, MEM_BYTES) dmem(clk, MemWrite & ~PmuSel, ByteEn, 
+                                   DataAdr, WriteData, MemReadData);
+  pmu  pmu(clk, reset, MemWrite & PmuSel, DataAdr[7:0], WriteData,
+           PmuReadData, Events);
+
+  // address decoding: PMU in the last 256 bytes
+  assign PmuSel = (DataAdr[31:8] == 24'hFFFFFF);
+  mux2 #(32) rdmux(MemReadData, PmuReadData, PmuSel, ReadData);
 endmodule
 
-module dmem(input  logic        clk, we,
-            input  logic [31:0] a, wd,
-            output logic [31:0] rd);
+module pmu(input  logic        clk, reset, we,
+           input  logic [7:0]  a,
+           input  logic [31:0] wd,
+           output logic [31:0] rd,
+           input  logic [3:0]  Events);
+
+  logic        En, Branch, CondFailed, Load, Store;
+  logic [31:0] Cycles, InstRet, Branches, CondFail, Loads, Stores;
 
-  logic [31:0] RAM[63:0];
+  assign {Branch, CondFailed, Load, Store} = Events;
 
-  assign rd = RAM[a[31:2]]; // word aligned
+  // one instruction retires every cycle on the single-cycle core
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      En <= 1;
+      {Cycles, InstRet, Branches, CondFail, Loads, Stores} <= 0;
+    end else if (we & (a[7:2] == 6'h00)) begin
+      En <= wd[0];
+      if (wd[1]) {Cycles, InstRet, Branches, CondFail, Loads, Stores} <= 0;
+    end else if (En) begin
+      Cycles   <= Cycles   + 1;
+      InstRet  <= InstRet  + 1;
+      Branches <= Branches + Branch;
+      CondFail <= CondFail + CondFailed;
+      Loads    <= Loads    + Load;
+      Stores   <= Stores   + Store;
+    end
+
+  always_comb
+    case(a[7:2])
+      6'h00:   rd = {31'b0, En};
+      6'h01:   rd = Cycles;
+      6'h02:   rd = InstRet;
+      6'h03:   rd = Branches;
+      6'h04:   rd = CondFail;
+      6'h05:   rd = Loads;
+      6'h06:   rd = Stores;
+      default: rd = 32'b0;
+    endcase
+endmodule
+
+module dmem #(parameter BASE = 32'h0, BYTES = 256)
+            (input  logic        clk, we,
+             input  logic [3:0]  be,
+             input  logic [31:0] a, wd,
+             output logic [31:0] rd);
+
+  localparam ADRBITS = $clog2(BYTES);
+
+  logic [31:0] RAM[BYTES/4-1:0];
+  logic [31:0] offset;
+
+`ifdef MEMLOAD_DPI
+`include "memload.svh"
+
+  initial void'(loadimage());
+`endif
+
+  assign offset = a - BASE;
+  assign rd = RAM[offset[ADRBITS-1:2]]; // word aligned
 
   always_ff @(posedge clk)
-    if (we) RAM[a[31:2]] <= wd;
+    if (we) 
+      for (int i = 0; i < 4; i++)
+        if (be[i]) RAM[offset[ADRBITS-1:2]][8*i +: 8] <= wd[8*i +: 8];
 endmodule
 
-module imem(input  logic [31:0] a,
-            output logic [31:0] rd);
+module imem #(parameter BASE = 32'h0, BYTES = 256)
+            (input  logic [31:0] a,
+             output logic [31:0] rd);
 
-  logic [31:0] RAM[63:0];
+  localparam ADRBITS = $clog2(BYTES);
+
+  logic [31:0] RAM[BYTES/4-1:0];
+  logic [31:0] offset;
+
+`ifdef MEMLOAD_DPI
+`include "memload.svh"
+`endif
 
   initial
+`ifdef MEMLOAD_DPI
+    if (!loadimage())
+`endif
       $readmemh("memfile.dat",RAM);
 
-  assign rd = RAM[a[31:2]]; // word aligned
+  assign offset = a - BASE;
+  assign rd = RAM[offset[ADRBITS-1:2]]; // word aligned
 endmodule
 
 module arm(input  logic        clk, reset,
@@ -152,54 +281,69 @@ module arm(input  logic        clk, reset,
            input  logic [31:0] Instr,
            output logic        MemWrite,
            output logic [31:0] ALUResult, WriteData,
-           input  logic [31:0] ReadData);
+           output logic [3:0]  ByteEn,
+           input  logic [31:0] ReadData,
+           output logic [3:0]  Events);
 
   logic [3:0] ALUFlags;
   logic       RegWrite, 
-              ALUSrc, MemtoReg, PCSrc;
-  logic [1:0] RegSrc, ImmSrc, ALUControl;
+              ALUSrc, MovOp, MulOp, MemtoReg, ByteOp, PCSrc, CondEx;
+  logic [1:0] RegSrc, ImmSrc, ALUControl, MulCtrl;
 
-  controller c(clk, reset, Instr[31:12], ALUFlags, 
+  controller c(clk, reset, Instr[31:4], ALUFlags, 
                RegSrc, RegWrite, ImmSrc, 
-               ALUSrc, ALUControl,
-               MemWrite, MemtoReg, PCSrc);
+               ALUSrc, MovOp, ALUControl, MulOp, MulCtrl,
+               MemWrite, MemtoReg, ByteOp, PCSrc, CondEx);
   datapath dp(clk, reset, 
               RegSrc, RegWrite, ImmSrc,
-              ALUSrc, ALUControl,
-              MemtoReg, PCSrc,
+              ALUSrc, MovOp, ALUControl, MulOp, MulCtrl,
+              MemtoReg, ByteOp, PCSrc,
               ALUFlags, PC, Instr,
-              ALUResult, WriteData, ReadData);
+              ALUResult, WriteData, ByteEn, ReadData);
+
+  // events for the performance monitoring unit
+  assign Events = {PCSrc, ~CondEx, MemtoReg & RegWrite, MemWrite};
 endmodule
 
 module controller(input  logic         clk, reset,
-	              input  logic [31:12] Instr,
+	              input  logic [31:4]  Instr,
                   input  logic [3:0]   ALUFlags,
                   output logic [1:0]   RegSrc,
                   output logic         RegWrite,
                   output logic [1:0]   ImmSrc,
-                  output logic         ALUSrc, 
+                  output logic         ALUSrc, MovOp,
                   output logic [1:0]   ALUControl,
-                  output logic         MemWrite, MemtoReg,
-                  output logic         PCSrc);
+                  output logic         MulOp,
+                  output logic [1:0]   MulCtrl,
+                  output logic         MemWrite, MemtoReg, ByteOp,
+                  output logic         PCSrc, CondEx);
 
   logic [1:0] FlagW;
-  logic       PCS, RegW, MemW;
+  logic       PCS, RegW, MemW, IsMul;
   
-  decode dec(Instr[27:26], Instr[25:20], Instr[15:12],
+  // multiplies share Op = 00 with data processing
+  assign IsMul = (Instr[27:24] == 4'b0000) & (Instr[7:4] == 4'b1001);
+
+  decode dec(Instr[27:26], Instr[25:20], Instr[15:12], IsMul,
              FlagW, PCS, RegW, MemW,
-             MemtoReg, ALUSrc, ImmSrc, RegSrc, ALUControl);
+             MemtoReg, ALUSrc, MovOp, ImmSrc, RegSrc, ALUControl,
+             MulOp, MulCtrl, ByteOp);
   condlogic cl(clk, reset, Instr[31:28], ALUFlags,
                FlagW, PCS, RegW, MemW,
-               PCSrc, RegWrite, MemWrite);
+               PCSrc, RegWrite, MemWrite, CondEx);
 endmodule
 
 module decode(input  logic [1:0] Op,
               input  logic [5:0] Funct,
               input  logic [3:0] Rd,
+              input  logic       IsMul,
               output logic [1:0] FlagW,
               output logic       PCS, RegW, MemW,
-              output logic       MemtoReg, ALUSrc,
-              output logic [1:0] ImmSrc, RegSrc, ALUControl);
+              output logic       MemtoReg, ALUSrc, MovOp,
+              output logic [1:0] ImmSrc, RegSrc, ALUControl,
+              output logic       MulOp,
+              output logic [1:0] MulCtrl,
+              output logic       ByteOp);
 
   logic [9:0] controls;
   logic       Branch, ALUOp;
@@ -210,6 +354,8 @@ module decode(input  logic [1:0] Op,
   	casex(Op)
   	                        // Data processing immediate
   	  2'b00: if (Funct[5])  controls = 10'b0000101001; 
+  	                        // MUL, MLA, UMULL
+  	         else if (IsMul) controls = 10'b0000001000;
   	                        // Data processing register
   	         else           controls = 10'b0000001001; 
   	                        // LDR
@@ -233,8 +379,10 @@ module decode(input  logic [1:0] Op,
   	    4'b0010: ALUControl = 2'b01; // SUB
         4'b0000: ALUControl = 2'b10; // AND
   	    4'b1100: ALUControl = 2'b11; // ORR
+  	    4'b1101: ALUControl = 2'b11; // MOV (ORR with SrcA = 0)
   	    default: ALUControl = 2'bx;  // unimplemented
       endcase
+      MovOp         = (Funct[4:1] == 4'b1101);
       // update flags if S bit is set 
 	// (C & V only updated for arith instructions)
       FlagW[1]      = Funct[0]; // FlagW[1] = S-bit
@@ -243,11 +391,22 @@ module decode(input  logic [1:0] Op,
         (ALUControl == 2'b00 | ALUControl == 2'b01); 
     end else begin
       ALUControl = 2'b00; // add for non-DP instructions
-      FlagW      = 2'b00; // don't update Flags
+      MovOp      = 1'b0;
+      // multiplies with S only update N and Z
+      FlagW      = {MulOp & Funct[0], 1'b0};
     end
+
+  // Multiply Decoder
+  // MulCtrl = {long (UMULL), accumulate (MLA)}
+  assign MulOp   = (Op == 2'b00) & ~Funct[5] & IsMul;
+  assign MulCtrl = {Funct[3], Funct[1]};
+
+  // LDRB/STRB
+  assign ByteOp  = (Op == 2'b01) & Funct[2];
               
   // PC Logic
-  assign PCS  = ((Rd == 4'b1111) & RegW) | Branch; 
+  // (multiplies write Instr[19:16], never the PC)
+  assign PCS  = ((Rd == 4'b1111) & RegW & ~MulOp) | Branch; 
 endmodule
 
 module condlogic(input  logic       clk, reset,
@@ -255,11 +414,11 @@ module condlogic(input  logic       clk, reset,
                  input  logic [3:0] ALUFlags,
                  input  logic [1:0] FlagW,
                  input  logic       PCS, RegW, MemW,
-                 output logic       PCSrc, RegWrite, MemWrite);
+                 output logic       PCSrc, RegWrite, MemWrite,
+                 output logic       CondEx);
                  
   logic [1:0] FlagWrite;
   logic [3:0] Flags;
-  logic       CondEx;
 
   flopenr #(2)flagreg1(clk, reset, FlagWrite[1], 
                        ALUFlags[3:2], Flags[3:2]);
@@ -308,19 +467,25 @@ module datapath(input  logic        clk, reset,
                 input  logic [1:0]  RegSrc,
                 input  logic        RegWrite,
                 input  logic [1:0]  ImmSrc,
-                input  logic        ALUSrc,
+                input  logic        ALUSrc, MovOp,
                 input  logic [1:0]  ALUControl,
-                input  logic        MemtoReg,
+                input  logic        MulOp,
+                input  logic [1:0]  MulCtrl,
+                input  logic        MemtoReg, ByteOp,
                 input  logic        PCSrc,
                 output logic [3:0]  ALUFlags,
                 output logic [31:0] PC,
                 input  logic [31:0] Instr,
                 output logic [31:0] ALUResult, WriteData,
+                output logic [3:0]  ByteEn,
                 input  logic [31:0] ReadData);
 
   logic [31:0] PCNext, PCPlus4, PCPlus8;
-  logic [31:0] ExtImm, SrcA, SrcB, Result;
-  logic [3:0]  RA1, RA2;
+  logic [31:0] ExtImm, RD1, Rs, SrcA, SrcB, ShiftedB, Result;
+  logic [31:0] ExResult, MulResult, MulLo, RD2, LoadData;
+  logic [3:0]  RA1, RA2, WA3;
+  logic [3:0]  AluFlags;
+  logic [1:0]  MulFlags;
 
   // next PC logic
   mux2 #(32)  pcmux(PCPlus4, Result, PCSrc, PCNext);
@@ -329,38 +494,69 @@ module datapath(input  logic        clk, reset,
   adder #(32) pcadd2(PCPlus4, 32'b100, PCPlus8);
 
   // register file logic
-  mux2 #(4)   ra1mux(Instr[19:16], 4'b1111, RegSrc[0], RA1);
+  // multiplies read ra from Instr[15:12] and write rd to Instr[19:16]
+  mux3 #(4)   ra1mux(Instr[19:16], 4'b1111, Instr[15:12], 
+                     {MulOp, RegSrc[0]}, RA1);
   mux2 #(4)   ra2mux(Instr[3:0], Instr[15:12], RegSrc[1], RA2);
-  regfile     rf(clk, RegWrite, RA1, RA2,
-                 Instr[15:12], Result, PCPlus8, 
-                 SrcA, WriteData); 
-  mux2 #(32)  resmux(ALUResult, ReadData, MemtoReg, Result);
+  mux2 #(4)   wa3mux(Instr[15:12], Instr[19:16], MulOp, WA3);
+  regfile     rf(clk, RegWrite, RA1, RA2, Instr[11:8],
+                 WA3, Result, PCPlus8, 
+                 RegWrite & MulOp & MulCtrl[1], Instr[15:12], MulLo,
+                 RD1, RD2, Rs); 
+  mux2 #(32)  exmux(ALUResult, MulResult, MulOp, ExResult);
+  mux2 #(32)  resmux(ExResult, LoadData, MemtoReg, Result);
   extend      ext(Instr[23:0], ImmSrc, ExtImm);
 
   // ALU logic
-  mux2 #(32)  srcbmux(WriteData, ExtImm, ALUSrc, SrcB);
+  // the register operand goes through the barrel shifter,
+  // MOV replaces SrcA with 0
+  shifter     sh(RD2, Instr[11:4], Rs[7:0], ShiftedB);
+  mux2 #(32)  srcamux(RD1, 32'b0, MovOp, SrcA);
+  mux2 #(32)  srcbmux(ShiftedB, ExtImm, ALUSrc, SrcB);
   alu         alu(SrcA, SrcB, ALUControl, 
-                  ALUResult, ALUFlags);
+                  ALUResult, AluFlags);
+
+  // multiplier logic
+  multiplier  mul(RD2, Rs, RD1, MulCtrl, 
+                  MulResult, MulLo, MulFlags);
+  assign ALUFlags = MulOp ? {MulFlags, AluFlags[1:0]} : AluFlags;
+
+  // byte access logic
+  // STRB drives the byte on all lanes and enables the addressed one,
+  // LDRB zero extends the addressed lane
+  mux2 #(32)  wdmux(RD2, {4{RD2[7:0]}}, ByteOp, WriteData);
+  mux2 #(4)   bemux(4'b1111, 4'b0001 << ALUResult[1:0], ByteOp, ByteEn);
+  mux2 #(32)  ldmux(ReadData, {24'b0, ReadData[8*ALUResult[1:0] +: 8]}, 
+                    ByteOp, LoadData);
 endmodule
 
 module regfile(input  logic        clk, 
                input  logic        we3, 
-               input  logic [3:0]  ra1, ra2, wa3, 
+               input  logic [3:0]  ra1, ra2, ra4, wa3, 
                input  logic [31:0] wd3, r15,
-               output logic [31:0] rd1, rd2);
+               input  logic        we5,
+               input  logic [3:0]  wa5,
+               input  logic [31:0] wd5,
+               output logic [31:0] rd1, rd2, rd4);
 
   logic [31:0] rf[14:0];
 
-  // three ported register file
-  // read two ports combinationally
-  // write third port on rising edge of clock
+  // five ported register file
+  // read three ports combinationally
+  //   (the third read port supplies rs for register-shifted operands
+  //    and multiplies)
+  // write two ports on rising edge of clock
+  //   (the second write port is only used by UMULL for rdlo)
   // register 15 reads PC+8 instead
 
-  always_ff @(posedge clk)
+  always_ff @(posedge clk) begin
     if (we3) rf[wa3] <= wd3;	
+    if (we5) rf[wa5] <= wd5;
+  end
 
   assign rd1 = (ra1 == 4'b1111) ? r15 : rf[ra1];
   assign rd2 = (ra2 == 4'b1111) ? r15 : rf[ra2];
+  assign rd4 = (ra4 == 4'b1111) ? r15 : rf[ra4];
 endmodule
 
 module extend(input  logic [23:0] Instr,
@@ -370,7 +566,8 @@ module extend(input  logic [23:0] Instr,
   always_comb
     case(ImmSrc) 
                // 8-bit unsigned immediate
-      2'b00:   ExtImm = {24'b0, Instr[7:0]};  
+               //   rotated right by 2*rot (Instr[11:8])
+      2'b00:   ExtImm = {2{24'b0, Instr[7:0]}} >> {Instr[11:8], 1'b0};
                // 12-bit unsigned immediate 
       2'b01:   ExtImm = {20'b0, Instr[11:0]}; 
                // 24-bit two's complement shifted branch 
@@ -379,6 +576,54 @@ module extend(input  logic [23:0] Instr,
     endcase             
 endmodule
 
+module shifter(input  logic [31:0] a,
+               input  logic [11:4] Shift,
+               input  logic [7:0]  Rs,
+               output logic [31:0] y);
+
+  logic [7:0]  shamt;
+  logic [31:0] asr;
+
+  // shift amount: rs[7:0] when Shift[4] is set, else the 5-bit
+  // immediate. LSR #0 and ASR #0 encode a shift by 32.
+  always_comb
+    if (Shift[4])              shamt = Rs;
+    else if (Shift[11:7] == 5'b0 & (Shift[6:5] == 2'b01 | 
+                                    Shift[6:5] == 2'b10))
+                               shamt = 8'd32;
+    else                       shamt = {3'b0, Shift[11:7]};
+
+  // kept apart so the shift stays signed
+  assign asr = $signed(a) >>> shamt[4:0];
+
+  always_comb
+    case(Shift[6:5])
+      2'b00:   y = (shamt > 31) ? 32'b0 : a << shamt[4:0];       // LSL
+      2'b01:   y = (shamt > 31) ? 32'b0 : a >> shamt[4:0];       // LSR
+      2'b10:   y = (shamt > 31) ? {32{a[31]}} : asr;             // ASR
+      default: y = {a, a} >> shamt[4:0];                          // ROR
+    endcase
+endmodule
+
+module multiplier(input  logic [31:0] a, b, acc,
+                  input  logic [1:0]  MulCtrl,
+                  output logic [31:0] Result, Lo,
+                  output logic [1:0]  Flags);
+
+  logic [63:0] product;
+
+  // MulCtrl = {long, accumulate}
+  assign product = a * b + (MulCtrl[0] ? {32'b0, acc} : 64'b0);
+
+  // Result goes to Instr[19:16]: rdhi for UMULL, rd otherwise
+  assign Lo     = product[31:0];
+  assign Result = MulCtrl[1] ? product[63:32] : product[31:0];
+
+  // N and Z
+  assign Flags  = MulCtrl[1] ? {product[63], product == 64'b0} :
+                               {product[31], product[31:0] == 32'b0};
+endmodule
+
 module adder #(parameter WIDTH=8)
               (input  logic [WIDTH-1:0] a, b,
                output logic [WIDTH-1:0] y);
@@ -414,3 +659,11 @@ module mux2 #(parameter WIDTH = 8)
   assign y = s ? d1 : d0; 
 endmodule
 
+module mux3 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1, d2,
+              input  logic [1:0]       s, 
+              output logic [WIDTH-1:0] y);
+
+  assign y = s[1] ? d2 : (s[0] ? d1 : d0); 
+endmodule
+
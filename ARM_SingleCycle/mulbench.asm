@@ -0,0 +1,62 @@
+// mulbench.asm
+// Multiply benchmark: step response of a one-pole Q15 low-pass filter
+//   y[n] = y[n-1] + ((x - y[n-1]) * alpha) >> 15
+//   x = 0x4000 (0.5), alpha = 0x1999 (~0.2), 16 samples
+// If successful, it writes y[16] = 0x3E30 to address 96
+// and the value 7 to address 100
+//
+// Two versions of the same kernel:
+//   mulbench.dat       MUL
+//   mulbench_base.dat  shift-and-add loop over the bits of alpha
+// Copy either one to memfile.dat to run it in the testbench, which
+// prints the cycle count when it succeeds.
+//
+// The MUL version replaces 13 iterations of a 5-instruction loop per
+// sample with one instruction. The speedup itself is not reported:
+// neither image has been simulated on arm_single.sv or arm_multi.sv.
+
+// mulbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          MOV  R1, #0x4000         ; R1 = x = 0.5 (Q15)               E3A01901 0x04
+//          MOV  R2, #0x1900         ; R2 = alpha = 0x1999 (~0.2, Q15)  E3A02C19 0x08
+//          ORR  R2, R2, #0x99       ;                                  E3822099 0x0c
+//          ADD  R3, R0, #16         ; R3 = n = 16 samples              E2803010 0x10
+//          ADD  R4, R0, #0          ; R4 = y = 0                       E2804000 0x14
+// LOOP     SUB  R5, R1, R4          ; R5 = e = x - y                   E0415004 0x18
+//          MUL  R6, R5, R2          ; R6 = e * alpha                   E0060295 0x1c
+//          ADD  R4, R4, R6, ASR #15 ; y += (e * alpha) >> 15           E08447C6 0x20
+//          SUBS R3, R3, #1          ; n--                              E2533001 0x24
+//          BNE  LOOP                ;                                  1AFFFFFA 0x28
+//          STR  R4, [R0, #96]       ; mem[96] = y = 0x3E30             E5804060 0x2c
+//          MOV  R9, #0x3E00         ; R9 = expected y                  E3A09C3E 0x30
+//          ORR  R9, R9, #0x30       ;                                  E3899030 0x34
+//          SUBS R9, R4, R9          ; Z = 1 if y is right              E0549009 0x38
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x3c
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x40
+
+// mulbench_base.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          MOV  R1, #0x4000         ; R1 = x = 0.5 (Q15)               E3A01901 0x04
+//          MOV  R2, #0x1900         ; R2 = alpha = 0x1999 (~0.2, Q15)  E3A02C19 0x08
+//          ORR  R2, R2, #0x99       ;                                  E3822099 0x0c
+//          ADD  R3, R0, #16         ; R3 = n = 16 samples              E2803010 0x10
+//          ADD  R4, R0, #0          ; R4 = y = 0                       E2804000 0x14
+// LOOP     SUB  R5, R1, R4          ; R5 = e = x - y                   E0415004 0x18
+//          ADD  R6, R0, #0          ; R6 = e * alpha by shift and add  E2806000 0x1c
+//          ADD  R7, R2, #0          ; R7 = remaining bits of alpha     E2827000 0x20
+// MLOOP    ANDS R8, R7, #1          ; low bit set?                     E2178001 0x24
+//          ADDNE R6, R6, R5         ; add e                            10866005 0x28
+//          ADD  R5, R5, R5          ; e <<= 1                          E0855005 0x2c
+//          MOVS R7, R7, LSR #1      ; next bit                         E1B070A7 0x30
+//          BNE  MLOOP               ;                                  1AFFFFFA 0x34
+//          ADD  R4, R4, R6, ASR #15 ; y += (e * alpha) >> 15           E08447C6 0x38
+//          SUBS R3, R3, #1          ; n--                              E2533001 0x3c
+//          BNE  LOOP                ;                                  1AFFFFF4 0x40
+//          STR  R4, [R0, #96]       ; mem[96] = y = 0x3E30             E5804060 0x44
+//          MOV  R9, #0x3E00         ; R9 = expected y                  E3A09C3E 0x48
+//          ORR  R9, R9, #0x30       ;                                  E3899030 0x4c
+//          SUBS R9, R4, R9          ; Z = 1 if y is right              E0549009 0x50
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x54
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x58
@@ -0,0 +1,71 @@
+// shiftbench.asm
+// Barrel shifter benchmark: sum of base + 4*i for i = 16..1, base = 0x10000
+// If successful, it writes the sum 0x100220 to address 96
+// and the value 7 to address 100
+//
+// Two versions of the same kernel:
+//   shiftbench.dat       rotated immediates and shifted register operands
+//   shiftbench_base.dat  ADD/SUB/AND/ORR with 8-bit immediates only
+// Copy either one to memfile.dat to run it in the testbench, which
+// prints the cycle count when it succeeds.
+//
+// The loop body drops from 6 to 4 instructions and the constants
+// 0x10000 and 0x100000 take one instruction instead of 17 and 4.
+// These counts are read off the code. The cycle comparison was not
+// done, because no simulator was available to run either image.
+
+// shiftbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          MOV  R1, #0x10000        ; R1 = base = 0x10000 (rotated imm) E3A01801 0x04
+//          ADD  R2, R0, #16         ; R2 = i = 16                      E2802010 0x08
+//          ADD  R4, R0, #0          ; R4 = sum = 0                     E2804000 0x0c
+// LOOP     ADD  R5, R1, R2, LSL #2  ; R5 = base + 4*i                  E0815102 0x10
+//          ADD  R4, R4, R5          ; sum += R5                        E0844005 0x14
+//          SUBS R2, R2, #1          ; i--                              E2522001 0x18
+//          BNE  LOOP                ; 16 iterations                    1AFFFFFB 0x1c
+//          STR  R4, [R0, #96]       ; mem[96] = sum = 0x100220         E5804060 0x20
+//          SUB  R6, R4, R1, LSL #4  ; R6 = sum - 0x100000              E0446201 0x24
+//          SUBS R6, R6, #0x220      ; Z = 1 if sum is right            E2566E22 0x28
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x2c
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x30
+
+// shiftbench_base.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          ADD  R1, R0, #1          ; R1 = 1                           E2801001 0x04
+//          ADD  R1, R1, R1          ; R1 = 2                           E0811001 0x08
+//          ADD  R1, R1, R1          ; R1 = 4                           E0811001 0x0c
+//          ADD  R1, R1, R1          ; R1 = 8                           E0811001 0x10
+//          ADD  R1, R1, R1          ; R1 = 0x10                        E0811001 0x14
+//          ADD  R1, R1, R1          ; R1 = 0x20                        E0811001 0x18
+//          ADD  R1, R1, R1          ; R1 = 0x40                        E0811001 0x1c
+//          ADD  R1, R1, R1          ; R1 = 0x80                        E0811001 0x20
+//          ADD  R1, R1, R1          ; R1 = 0x100                       E0811001 0x24
+//          ADD  R1, R1, R1          ; R1 = 0x200                       E0811001 0x28
+//          ADD  R1, R1, R1          ; R1 = 0x400                       E0811001 0x2c
+//          ADD  R1, R1, R1          ; R1 = 0x800                       E0811001 0x30
+//          ADD  R1, R1, R1          ; R1 = 0x1000                      E0811001 0x34
+//          ADD  R1, R1, R1          ; R1 = 0x2000                      E0811001 0x38
+//          ADD  R1, R1, R1          ; R1 = 0x4000                      E0811001 0x3c
+//          ADD  R1, R1, R1          ; R1 = 0x8000                      E0811001 0x40
+//          ADD  R1, R1, R1          ; R1 = base = 0x10000              E0811001 0x44
+//          ADD  R2, R0, #16         ; R2 = i = 16                      E2802010 0x48
+//          ADD  R4, R0, #0          ; R4 = sum = 0                     E2804000 0x4c
+// LOOP     ADD  R5, R2, R2          ; R5 = 2*i                         E0825002 0x50
+//          ADD  R5, R5, R5          ; R5 = 4*i                         E0855005 0x54
+//          ADD  R5, R5, R1          ; R5 = base + 4*i                  E0855001 0x58
+//          ADD  R4, R4, R5          ; sum += R5                        E0844005 0x5c
+//          SUBS R2, R2, #1          ; i--                              E2522001 0x60
+//          BNE  LOOP                ; 16 iterations                    1AFFFFF9 0x64
+//          STR  R4, [R0, #96]       ; mem[96] = sum = 0x100220         E5804060 0x68
+//          ADD  R6, R1, R1          ; R6 = 0x20000                     E0816001 0x6c
+//          ADD  R6, R6, R6          ; R6 = 0x40000                     E0866006 0x70
+//          ADD  R6, R6, R6          ; R6 = 0x80000                     E0866006 0x74
+//          ADD  R6, R6, R6          ; R6 = 0x100000                    E0866006 0x78
+//          SUB  R6, R4, R6          ; R6 = sum - 0x100000              E0446006 0x7c
+//          SUB  R6, R6, #255        ;                                  E24660FF 0x80
+//          SUB  R6, R6, #255        ;                                  E24660FF 0x84
+//          SUBS R6, R6, #34         ; Z = 1 if sum is right (0x220 = 544) E2566022 0x88
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x8c
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x90
@@ -0,0 +1,144 @@
+/*
+ * ao.c
+ *
+ *  Active object queues and scheduler (see ao.h)
+ */
+
+/* Include Files */
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "mmio.h"
+#include "ao.h"
+
+/* Objects by priority, and one bit per object with events waiting */
+static ao_t *AoTable[AO_PRIORITIES];
+static volatile u32 AoReady;
+
+
+/*****************************************************************************
+ * Function: AO_Start()
+ *
+ * Registers an object at a free priority with its queue storage (Len a
+ * power of two) and posts AO_SIG_INIT to it. Starts the global timer the
+ * events are stamped with if the boot code has not
+ *
+ *****************************************************************************/
+int AO_Start(ao_t *Me, u32 Prio, ao_handler_t Handler, ao_event_t *Queue, u32 Len)
+{
+	if (Prio == 0 || Prio >= AO_PRIORITIES || AoTable[Prio] != NULL)
+		return XST_INVALID_PARAM;
+	if (Len == 0 || (Len & (Len - 1)) != 0)
+		return XST_INVALID_PARAM;
+
+	Me->Handler = Handler;
+	Me->Queue = Queue;
+	Me->Len = Len;
+	Me->Head = 0;
+	Me->Tail = 0;
+	Me->Prio = Prio;
+	Me->Lost = 0;
+	Me->MaxDepth = 0;
+	Me->Count = 0;
+	Me->LatSum = 0;
+	Me->LatMax = 0;
+	AoTable[Prio] = Me;
+
+	mmio_update32(GTIMER_BASE + GTIMER_CONTROL, GTIMER_CONTROL_ENABLE, GTIMER_CONTROL_ENABLE);
+
+	return AO_Post(Me, AO_SIG_INIT, 0);
+}
+
+
+/*****************************************************************************
+ * Function: AO_Post()
+ *
+ * Queues an event for Me; callable from handlers and objects alike. Returns
+ * XST_FAILURE, and counts the event as lost, when the queue is full
+ *
+ *****************************************************************************/
+int AO_Post(ao_t *Me, u16 Sig, u32 Arg)
+{
+	ao_event_t *Event;
+	u32 cpsr, Depth;
+
+	cpsr = irq_save();
+	Depth = Me->Head - Me->Tail;
+	if (Depth == Me->Len) {
+		Me->Lost++;
+		irq_restore(cpsr);
+		return XST_FAILURE;
+	}
+
+	Event = &Me->Queue[Me->Head & (Me->Len - 1)];
+	Event->Sig = Sig;
+	Event->Arg = Arg;
+	Event->Stamp = gtimer_now32();
+	Me->Head++;
+	if (Depth + 1 > Me->MaxDepth)
+		Me->MaxDepth = Depth + 1;
+	AoReady |= 1u << Me->Prio;
+	irq_restore(cpsr);
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************
+ * Function: AO_Run()
+ *
+ * Dispatches events, highest priority first, one at a time and to
+ * completion. With nothing to do it checks and sleeps with IRQ masked: the
+ * interrupt that posts the next event still ends the WFI, and is taken as
+ * soon as IRQ is unmasked, so no post can slip in between
+ *
+ *****************************************************************************/
+void AO_Run(void)
+{
+	ao_event_t Event;
+	ao_t *Me;
+	u32 cpsr, Prio, Latency;
+
+	while (1) {
+		cpsr = irq_save();
+		if (AoReady == 0) {
+			__asm__ volatile("dsb\n\twfi" ::: "memory");
+			irq_restore(cpsr);
+			continue;
+		}
+
+		Prio = 31 - __builtin_clz(AoReady);
+		Me = AoTable[Prio];
+		Event = Me->Queue[Me->Tail & (Me->Len - 1)];
+		Me->Tail++;
+		if (Me->Tail == Me->Head)
+			AoReady &= ~(1u << Prio);
+		irq_restore(cpsr);
+
+		Latency = gtimer_now32() - Event.Stamp;
+		Me->LatSum += Latency;
+		if (Latency > Me->LatMax)
+			Me->LatMax = Latency;
+		Me->Count++;
+
+		Me->Handler(Me, &Event);
+	}
+}
+
+
+/* One line of statistics since the last report, latency mean/worst in CPU cycles */
+void AO_Report(ao_t *Me, const char *Name)
+{
+	u32 Mean = Me->Count ? 2 * (Me->LatSum / Me->Count) : 0;
+	u32 cpsr;
+
+	xil_printf("%s: %d events, %d lost, depth %d, latency %d/%d cycles\r\n",
+		   Name, Me->Count, Me->Lost, Me->MaxDepth, Mean, 2 * Me->LatMax);
+
+	cpsr = irq_save();
+	Me->Lost = 0;
+	Me->MaxDepth = 0;
+	Me->Count = 0;
+	Me->LatSum = 0;
+	Me->LatMax = 0;
+	irq_restore(cpsr);
+}
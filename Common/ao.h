@@ -0,0 +1,77 @@
+/*
+ * ao.h
+ *
+ *  Run-to-completion active objects: event queues filled by handlers, one dispatch loop
+ */
+
+/********************************************************************************************
+ *
+ * The examples share volatile flags between handlers and a while(1) loop (PrivateTimerHit,
+ * SwitchValue): a flag set twice before the loop reads it loses an event, and nothing tells.
+ * Here each piece of behaviour is an active object: a handler function and a queue of
+ * events, with a priority. Interrupt handlers only read the hardware and post an event;
+ * AO_Run() takes the highest-priority object with an event waiting, calls its handler to
+ * completion and goes on, and sleeps in WFI when every queue is empty.
+ *
+ *   static ao_event_t PwmQueue[32];
+ *   static ao_t Pwm;
+ *   AO_Start(&Pwm, 2, PwmHandler, PwmQueue, 32);
+ *   AO_Post(&Pwm, SIG_TICK, 0);			from a handler or another object
+ *   AO_Run();						never returns
+ *
+ * Events are copied by value into the queue, which the application provides as a static
+ * array: memory is fixed at build time and nothing is allocated. A post to a full queue is
+ * refused and counted in Lost. Objects do not preempt each other: a long handler delays
+ * every other object, so the queues must cover the longest handler of a lower priority.
+ *
+ * Every event is stamped with the global timer when posted; AO_Run() keeps, per object,
+ * the mean and worst time from post to the start of its handler, which AO_Report() prints
+ * and restarts.
+ *
+ ********************************************************************************************/
+
+#ifndef AO_H
+#define AO_H
+
+/* Include Files */
+#include "xil_types.h"
+
+/* Definitions */
+#define AO_PRIORITIES	32		/* 1 (lowest) .. 31, one object each */
+
+/* Signals of the runtime; applications number theirs from AO_SIG_USER */
+#define AO_SIG_INIT	0		/* first event of every object */
+#define AO_SIG_USER	1
+
+typedef struct {
+	u16 Sig;
+	u16 Pad;
+	u32 Arg;
+	u32 Stamp;			/* global timer at the post */
+} ao_event_t;
+
+typedef struct ao ao_t;
+typedef void (*ao_handler_t)(ao_t *Me, const ao_event_t *Event);
+
+struct ao {
+	ao_handler_t Handler;
+	ao_event_t *Queue;
+	u32 Len;			/* power of two */
+	volatile u32 Head;		/* events posted */
+	volatile u32 Tail;		/* events dispatched */
+	u32 Prio;
+
+	/* statistics, global timer ticks (2 CPU cycles) */
+	u32 Lost;			/* posts refused, queue full */
+	u32 MaxDepth;
+	u32 Count;
+	u32 LatSum, LatMax;
+};
+
+/* Function Prototypes */
+int AO_Start(ao_t *Me, u32 Prio, ao_handler_t Handler, ao_event_t *Queue, u32 Len);
+int AO_Post(ao_t *Me, u16 Sig, u32 Arg);
+void AO_Run(void);
+void AO_Report(ao_t *Me, const char *Name);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * console.c
+ *
+ *  Interrupt-driven, buffered console on the PS UART (see console.h)
+ */
+
+/* Include Files */
+#include <stdarg.h>
+#include <stdio.h>
+#include "xil_exception.h"
+#include "xstatus.h"
+#include "mmio.h"
+#include "console.h"
+
+/* Ring: Head is advanced by the writers, Tail by the TX handler (both with IRQ masked) */
+static struct {
+	char Buf[CONSOLE_SIZE];
+	volatile u32 Head;
+	volatile u32 Tail;
+	volatile u32 Dropped;
+	volatile int Busy;		/* TX-empty interrupt enabled */
+	Console_Policy Policy;
+} Console;
+
+/* Function Prototypes */
+static void Console_Intr_Handler(void *CallBackRef);
+static void Console_Fill(void);
+static void Console_Kick(void);
+
+
+/*****************************************************************************
+ * Function: Console_Initialize()
+ *
+ * Connects the UART interrupt to an initialised GIC. The TX-empty interrupt
+ * is only enabled while the ring holds data
+ *
+ *****************************************************************************/
+int Console_Initialize(XScuGic *IntcInstancePtr, Console_Policy Policy)
+{
+	int Status;
+
+	Console.Head = 0;
+	Console.Tail = 0;
+	Console.Dropped = 0;
+	Console.Busy = 0;
+	Console.Policy = Policy;
+
+	mmio_write32(CONSOLE_UART_BASE + UART_IDR, UART_IXR_TEMPTY);
+	mmio_write32(CONSOLE_UART_BASE + UART_ISR, UART_IXR_TEMPTY);
+
+	Status = XScuGic_Connect(IntcInstancePtr, CONSOLE_UART_INTR,
+				 (Xil_ExceptionHandler)Console_Intr_Handler, NULL);
+	if (Status != XST_SUCCESS)
+		return XST_FAILURE;
+
+	XScuGic_Enable(IntcInstancePtr, CONSOLE_UART_INTR);
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************
+ * Function: Console_Write()
+ *
+ * Queues Len bytes and returns how many were queued; the rest were dropped
+ *
+ *****************************************************************************/
+int Console_Write(const char *Data, int Len)
+{
+	u32 cpsr, Used, Free, n, i;
+	int Done = 0;
+
+	while (Done < Len) {
+		cpsr = irq_save();
+		Used = Console.Head - Console.Tail;
+		Free = CONSOLE_SIZE - Used;
+
+		if (Free < (u32)(Len - Done)) {
+			if (Console.Policy == CONSOLE_OVERWRITE) {
+				/* discard the oldest bytes still waiting */
+				n = Len - Done - Free;
+				if (n > Used)
+					n = Used;
+				Console.Tail += n;
+				Console.Dropped += n;
+				Free += n;
+			} else if (Console.Policy == CONSOLE_BLOCK && Free == 0 && !(cpsr & CPSR_I)) {
+				/* wait with interrupts on for the handler to drain */
+				Console_Kick();
+				irq_restore(cpsr);
+				while (Console.Head - Console.Tail == CONSOLE_SIZE)
+					;
+				continue;
+			}
+		}
+
+		n = (u32)(Len - Done) < Free ? (u32)(Len - Done) : Free;
+		for (i = 0; i < n; i++)
+			Console.Buf[(Console.Head + i) & (CONSOLE_SIZE - 1)] = Data[Done + i];
+		Console.Head += n;
+		Done += n;
+		Console_Kick();
+
+		/* full and not allowed to wait: drop the rest */
+		if (n == 0) {
+			Console.Dropped += Len - Done;
+			irq_restore(cpsr);
+			break;
+		}
+		irq_restore(cpsr);
+	}
+
+	return Done;
+}
+
+
+/*****************************************************************************
+ * Function: Console_Printf()
+ *
+ * Formats one line of up to CONSOLE_LINE - 1 characters and queues it
+ *
+ *****************************************************************************/
+int Console_Printf(const char *Format, ...)
+{
+	char Line[CONSOLE_LINE];
+	va_list Args;
+	int Len;
+
+	va_start(Args, Format);
+	Len = vsnprintf(Line, sizeof(Line), Format, Args);
+	va_end(Args);
+
+	if (Len < 0)
+		return 0;
+	if (Len > CONSOLE_LINE - 1)
+		Len = CONSOLE_LINE - 1;
+
+	return Console_Write(Line, Len);
+}
+
+
+/*****************************************************************************
+ * Function: Console_Flush()
+ *
+ * Waits until everything queued has left the UART. Feeds the FIFO itself,
+ * so it also works with interrupts masked
+ *
+ *****************************************************************************/
+void Console_Flush(void)
+{
+	u32 cpsr;
+
+	while (Console.Head != Console.Tail) {
+		cpsr = irq_save();
+		Console_Fill();
+		irq_restore(cpsr);
+	}
+
+	while (!uart_tx_empty(CONSOLE_UART_BASE))
+		;
+}
+
+
+/* Bytes lost to a full ring since Console_Initialize */
+u32 Console_Dropped(void)
+{
+	return Console.Dropped;
+}
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Moves ring bytes into the TX FIFO until one of them is full/empty */
+static void Console_Fill(void)
+{
+	while (Console.Head != Console.Tail && !uart_tx_full(CONSOLE_UART_BASE)) {
+		uart_putc(CONSOLE_UART_BASE, Console.Buf[Console.Tail & (CONSOLE_SIZE - 1)]);
+		Console.Tail++;
+	}
+}
+
+
+/* Called with IRQ masked after new data: starts the drain if it is idle */
+static void Console_Kick(void)
+{
+	if (Console.Busy)
+		return;
+
+	Console_Fill();
+	Console.Busy = 1;
+	mmio_write32(CONSOLE_UART_BASE + UART_IER, UART_IXR_TEMPTY);
+}
+
+
+/* TX FIFO empty: refill it, or stop the interrupt when the ring is empty */
+static void Console_Intr_Handler(void *CallBackRef)
+{
+	(void)CallBackRef;
+
+	mmio_write32(CONSOLE_UART_BASE + UART_ISR, UART_IXR_TEMPTY);
+
+	Console_Fill();
+	if (Console.Head == Console.Tail) {
+		mmio_write32(CONSOLE_UART_BASE + UART_IDR, UART_IXR_TEMPTY);
+		Console.Busy = 0;
+	}
+}
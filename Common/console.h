@@ -0,0 +1,57 @@
+/*
+ * console.h
+ *
+ *  Interrupt-driven, buffered console on the PS UART
+ */
+
+/********************************************************************************************
+ *
+ * xil_printf writes every character straight to the UART and polls the 64-byte TX FIFO when
+ * it is full, so a status line costs the caller about one character time (87 us at 115200
+ * baud) per character past the first 64. Console_Printf formats the line into a local
+ * buffer, copies it into a RAM ring and returns; the UART TX-empty interrupt refills the
+ * FIFO from the ring in the background.
+ *
+ * What happens when a line does not fit in the ring is set at Console_Initialize:
+ *
+ *   CONSOLE_DROP	the part that does not fit is lost and counted
+ *   CONSOLE_BLOCK	the caller waits for the interrupt to make room; from a handler, or
+ *			with interrupts masked, it cannot and drops instead
+ *   CONSOLE_OVERWRITE	the oldest output still in the ring is lost and counted
+ *
+ * The ring is shared by the main loop and handlers of one core: every update is made with
+ * IRQ masked. Console_Flush waits until the ring and the FIFO are empty (before a reset, or
+ * to mix with xil_printf). Formatting uses vsnprintf, so keep floating-point conversions out
+ * of handlers.
+ *
+ * HW platform: the UART of stdout (UART 1 on the Zybo), already set up by the BSP.
+ *
+ ********************************************************************************************/
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+/* Include Files */
+#include "xparameters.h"
+#include "xscugic.h"
+
+/* Definitions */
+#define CONSOLE_SIZE		2048			/* ring bytes, power of two */
+#define CONSOLE_LINE		128			/* longest Console_Printf line */
+#define CONSOLE_UART_BASE	XPAR_PS7_UART_1_BASEADDR
+#define CONSOLE_UART_INTR	XPAR_XUARTPS_1_INTR
+
+typedef enum {
+	CONSOLE_DROP,
+	CONSOLE_BLOCK,
+	CONSOLE_OVERWRITE
+} Console_Policy;
+
+/* Function Prototypes */
+int Console_Initialize(XScuGic *IntcInstancePtr, Console_Policy Policy);
+int Console_Write(const char *Data, int Len);
+int Console_Printf(const char *Format, ...) __attribute__((format(printf, 1, 2)));
+void Console_Flush(void);
+u32 Console_Dropped(void);
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * console_bench.c
+ *
+ *  Caller-visible cycles per status line: xil_printf against Console_Printf
+ */
+
+/********************************************************************************************
+ * Prints LINES status lines like the ones of the examples, first with xil_printf and then
+ * with Console_Printf, and times each call with the Cortex-A9 cycle counter (PMCCNTR, CPU
+ * clock). The LINES lines fit in the console ring, so the second figure is the formatting
+ * and the copy only; the UART sends them afterwards while the CPU is free. A third row
+ * queues lines faster than the UART sends them with the CONSOLE_DROP policy and shows what
+ * was lost. The results are printed after Console_Flush, so they are not timed. No board
+ * results are recorded yet.
+ *
+ * HW platform: stdout on UART 1. Build with -O2 and console.c.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "console.h"
+#include "pmccntr.h"
+
+/* Definitions */
+#define INTC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID	/* GIC device ID */
+#define LINES			16				/* lines per row */
+#define BURST			200				/* lines of the drop row */
+
+/************************** Hardware Instances  ******************************/
+
+XScuGic INTCInst;		/* Instance of the GIC */
+
+/**************  Function Prototypes **************/
+
+static int IntcInitFunction(u16 DeviceId);
+
+
+/*************** Main function ********************/
+int main(void){
+	u32 t0, Print, Queue, Burst, Queued, Dropped;
+	int i;
+
+	if (IntcInitFunction(INTC_DEVICE_ID) != XST_SUCCESS ||
+	    Console_Initialize(&INTCInst, CONSOLE_DROP) != XST_SUCCESS) {
+		xil_printf("Failed to initialise the console\r\n");
+		return XST_FAILURE;
+	}
+
+	pmccntr_start();
+
+	t0 = pmccntr_read();
+	for (i = 0; i < LINES; i++)
+		xil_printf("PWM pos %d high %d ns, btn %x\r\n", i, 1000000 + i * 5000, i & 0xF);
+	Print = pmccntr_read() - t0;
+
+	t0 = pmccntr_read();
+	for (i = 0; i < LINES; i++)
+		Console_Printf("PWM pos %d high %d ns, btn %x\r\n", i, 1000000 + i * 5000, i & 0xF);
+	Queue = pmccntr_read() - t0;
+	Console_Flush();
+
+	Queued = 0;
+	t0 = pmccntr_read();
+	for (i = 0; i < BURST; i++)
+		Queued += Console_Printf("PWM pos %d high %d ns, btn %x\r\n", i, 1000000 + i * 5000, i & 0xF);
+	Burst = pmccntr_read() - t0;
+	Console_Flush();
+	Dropped = Console_Dropped();
+
+	xil_printf("\r\ncycles per line\r\n");
+	xil_printf("xil_printf          ");
+	pmccntr_print_per(Print, LINES);
+	xil_printf("\r\nConsole_Printf      ");
+	pmccntr_print_per(Queue, LINES);
+	xil_printf("\r\nConsole_Printf, full");
+	pmccntr_print_per(Burst, BURST);
+	xil_printf("  (%d of %d bytes dropped)\r\n", Dropped, Queued + Dropped);
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+static int IntcInitFunction(u16 DeviceId)
+{
+	XScuGic_Config *IntcConfig;
+	int status;
+
+	IntcConfig = XScuGic_LookupConfig(DeviceId);
+	status = XScuGic_CfgInitialize(&INTCInst, IntcConfig, IntcConfig->CpuBaseAddress);
+	if (status != XST_SUCCESS) return XST_FAILURE;
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				     (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				     &INTCInst);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+}
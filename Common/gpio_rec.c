@@ -0,0 +1,187 @@
+/*
+ * gpio_rec.c
+ *
+ *  GPIO input recording and replay (see gpio_rec.h)
+ */
+
+/* Include Files */
+#include "xil_printf.h"
+#include "mmio.h"
+#include "gpio_rec.h"
+
+/* Definitions */
+#define DELTA_MAX		0xFFFFFFFFu
+
+/* Recording in progress */
+static struct {
+	gpiorec_t *Buf;
+	u32 Len;
+	volatile u32 Count;
+	u32 Lost;			/* changes after the buffer filled */
+	u64 LastUs;
+	u32 Last[GPIOREC_PORTS];
+	u32 Known;			/* ports with a value in Last */
+} Rec;
+
+/* Replay in progress: time as recorded */
+static volatile int Replaying;
+static u64 ReplayUs;
+
+/* Function Prototypes */
+static u64 RealUs(void);
+static void Append(u32 Delta, u16 Port, u32 Value);
+
+
+/*****************************************************************************
+ * Function: GpioRec_Start()
+ *
+ * Starts a recording into Buf; time 0 is now. Also starts the global timer
+ * if the boot code has not
+ *
+ *****************************************************************************/
+void GpioRec_Start(gpiorec_t *Buf, u32 Len)
+{
+	mmio_update32(GTIMER_BASE + GTIMER_CONTROL, GTIMER_CONTROL_ENABLE, GTIMER_CONTROL_ENABLE);
+
+	Rec.Buf = Buf;
+	Rec.Len = Len;
+	Rec.Count = 0;
+	Rec.Lost = 0;
+	Rec.Known = 0;
+	Rec.LastUs = RealUs();
+}
+
+
+/*****************************************************************************
+ * Function: GpioRec_Sample()
+ *
+ * Records Value for Port if it differs from the last one recorded. Safe in
+ * handlers: runs with IRQ masked
+ *
+ *****************************************************************************/
+void GpioRec_Sample(u16 Port, u32 Value)
+{
+	u32 cpsr;
+	u64 Now, Delta;
+
+	if (Rec.Buf == NULL)
+		return;
+
+	cpsr = irq_save();
+
+	if (Port < GPIOREC_PORTS) {
+		if ((Rec.Known & (1u << Port)) && Rec.Last[Port] == Value)
+			goto out;
+		Rec.Known |= 1u << Port;
+		Rec.Last[Port] = Value;
+	}
+
+	Now = RealUs();
+	Delta = Now - Rec.LastUs;
+	Rec.LastUs = Now;
+
+	for (; Delta > DELTA_MAX; Delta -= DELTA_MAX)
+		Append(DELTA_MAX, GPIOREC_GAP, 0);
+	Append((u32)Delta, Port, Value);
+
+out:
+	irq_restore(cpsr);
+}
+
+
+/* Records stored so far */
+u32 GpioRec_Count(void)
+{
+	return Rec.Count;
+}
+
+
+/*****************************************************************************
+ * Function: GpioRec_Dump()
+ *
+ * Prints the recording as a C definition named Name; save the lines from
+ * the gpio_rec comment to the closing brace into a header and include it
+ * in the replay build
+ *
+ *****************************************************************************/
+void GpioRec_Dump(const char *Name)
+{
+	u32 i;
+
+	xil_printf("/* gpio_rec: %d records, %d changes lost */\r\n", Rec.Count, Rec.Lost);
+	xil_printf("static const gpiorec_t %s[] = {\r\n", Name);
+	for (i = 0; i < Rec.Count; i++)
+		xil_printf("\t{ %10d, 0x%04x, 0, 0x%08x },\r\n",
+			   Rec.Buf[i].Delta, Rec.Buf[i].Port, Rec.Buf[i].Value);
+	xil_printf("};\r\n");
+}
+
+
+/*****************************************************************************
+ * Function: GpioRec_Replay()
+ *
+ * Calls Input(Port, Value) for every record, with GpioRec_NowUs() at the
+ * recorded time. With Speedup > 0 every call waits until the recorded time
+ * divided by Speedup has passed since the start; with 0 it does not wait
+ *
+ *****************************************************************************/
+void GpioRec_Replay(const gpiorec_t *Record, u32 Count, u32 Speedup, gpiorec_input_t Input)
+{
+	u64 Start;
+	u32 i;
+
+	mmio_update32(GTIMER_BASE + GTIMER_CONTROL, GTIMER_CONTROL_ENABLE, GTIMER_CONTROL_ENABLE);
+	Start = RealUs();
+	ReplayUs = 0;
+	Replaying = 1;
+
+	for (i = 0; i < Count; i++) {
+		ReplayUs += Record[i].Delta;
+		if (Speedup)
+			while ((RealUs() - Start) * Speedup < ReplayUs)
+				;
+		if (Record[i].Port != GPIOREC_GAP)
+			Input(Record[i].Port, Record[i].Value);
+	}
+
+	Replaying = 0;
+}
+
+
+/* Microseconds: recorded time during a replay, global timer otherwise */
+u64 GpioRec_NowUs(void)
+{
+	return Replaying ? ReplayUs : RealUs();
+}
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+static u64 RealUs(void)
+{
+	return gtimer_now64() / GTIMER_TICKS_PER_US;
+}
+
+
+/* Called with IRQ masked */
+static void Append(u32 Delta, u16 Port, u32 Value)
+{
+	gpiorec_t *r;
+
+	if (Rec.Count == Rec.Len) {
+		Rec.Lost++;
+		return;
+	}
+
+	r = &Rec.Buf[Rec.Count];
+	r->Delta = Delta;
+	r->Port = Port;
+	r->Pad = 0;
+	r->Value = Value;
+	Rec.Count++;
+}
@@ -0,0 +1,58 @@
+/*
+ * gpio_rec.h
+ *
+ *  Recorded GPIO input traces and their replay
+ */
+
+/********************************************************************************************
+ *
+ * Buttons bounce differently every time and nobody presses a keypad the same way twice, so
+ * runs of the input handlers are not comparable. A recording is a list of input changes:
+ *
+ *   Delta	microseconds since the previous record (or the start)
+ *   Port	input, numbered by the application (button channel, switches, keypad rows...)
+ *   Value	what GPIO read on that input from then on
+ *
+ * GpioRec_Sample() is called wherever the application reads an input, handlers included,
+ * and stores a record only when the value changed. GpioRec_Dump() prints the recording as
+ * a C array, ready to be saved from the terminal into a header and built into a replay.
+ * A gap longer than the 32-bit Delta (71 minutes) is split with GPIOREC_GAP records.
+ *
+ * GpioRec_Replay() feeds a recording to the application's input function, in order and
+ * with the same values, at the recorded times divided by Speedup (0: back to back, no
+ * waiting). Code that measures time between inputs (debounce) must take it from
+ * GpioRec_NowUs(), which during a replay returns the recorded time rather than the real
+ * one: a replay then takes the same decisions at any speed, and hours of input run in
+ * seconds.
+ *
+ ********************************************************************************************/
+
+#ifndef GPIO_REC_H
+#define GPIO_REC_H
+
+/* Include Files */
+#include "xil_types.h"
+
+/* Definitions */
+#define GPIOREC_PORTS		4		/* inputs compared for changes */
+#define GPIOREC_GAP		0xFFFF		/* Port of a record that only carries time */
+
+typedef struct {
+	u32 Delta;
+	u16 Port;
+	u16 Pad;
+	u32 Value;
+} gpiorec_t;
+
+typedef void (*gpiorec_input_t)(u16 Port, u32 Value);
+
+/* Function Prototypes */
+void GpioRec_Start(gpiorec_t *Buf, u32 Len);
+void GpioRec_Sample(u16 Port, u32 Value);
+u32 GpioRec_Count(void);
+void GpioRec_Dump(const char *Name);
+
+void GpioRec_Replay(const gpiorec_t *Rec, u32 Count, u32 Speedup, gpiorec_input_t Input);
+u64 GpioRec_NowUs(void);
+
+#endif
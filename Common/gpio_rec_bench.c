@@ -0,0 +1,240 @@
+/*
+ * gpio_rec_bench.c
+ *
+ *  Button input path recorded once, then replayed as a repeatable benchmark
+ */
+
+/********************************************************************************************
+ * The path under test is ButtonInput(): a 20 ms debounce lockout timed with GpioRec_NowUs()
+ * and the LED write of BtnInt.c. It keeps a count of accepted changes and a checksum of
+ * their values and times, which is the same for every replay of the same recording.
+ *
+ * Default build, recording: the button interrupt reads the buttons, records the value and
+ * calls ButtonInput(). After RECORD_SECONDS, or when the buffer is full, the recording is
+ * printed as a C array; save it as gpio_rec_capture.h.
+ *
+ * Built with GPIOREC_REPLAY: the recording in gpio_rec_capture.h is fed to ButtonInput()
+ * REPEAT times back to back, timed with the cycle counter (PMCCNTR, CPU clock), then once
+ * at SPEEDUP times the recorded speed. Every run must print the same checksum. The cycle
+ * counts are printed for the board at hand; none have been recorded yet.
+ *
+ * HW platform: that of BtnInt.c (buttons in GPIO 0 Ch1, LEDs in Ch2). Build with -O2 and
+ * gpio_rec.c.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "gpio_rec.h"
+#include "pmccntr.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID		XPAR_AXI_GPIO_0_DEVICE_ID	/* buttons and LEDs */
+#define BTN_CHANNEL		1				/* GPIO port 1 for buttons */
+#define LED_CHANNEL		2				/* GPIO port 2 for leds */
+#define BTN_INT			XGPIO_IR_CH1_MASK
+#define INTC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID	/* GIC device ID */
+#define INTC_GPIO_INTERRUPT_ID	XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR
+
+#define PORT_BTN		0				/* recording port of the buttons */
+#define DEBOUNCE_US		20000
+#define RECORD_LEN		1024				/* records */
+#define RECORD_SECONDS		30
+#define REPEAT			10				/* back-to-back replays */
+#define SPEEDUP			100				/* timed replay */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+/************************** Hardware Instances  ******************************/
+
+XGpio Gpio;			/* GPIO Device driver instance */
+XScuGic INTCInst;		/* Instance of the GIC */
+
+/* Result of the input path */
+static struct {
+	u64 LastUs;
+	u32 Value;
+	u32 Accepted;
+	u32 Sum;
+} Btn;
+
+#ifdef GPIOREC_REPLAY
+#include "gpio_rec_capture.h"
+#define CAPTURE_LEN	(sizeof(GpioRecCapture) / sizeof(GpioRecCapture[0]))
+#else
+static gpiorec_t Recording[RECORD_LEN];
+#endif
+
+/**************  Function Prototypes **************/
+
+static void ButtonInput(u16 Port, u32 Value);
+static void ButtonReset(void);
+#ifdef GPIOREC_REPLAY
+static void Replay(void);
+#else
+static void Record(void);
+static void BTN_Intr_Handler(void *InstancePtr);
+static int IntcInitFunction(u16 DeviceId, XGpio *GpioInstancePtr);
+#endif
+
+
+/*************** Main function ********************/
+int main(void){
+	XGpio_Initialize(&Gpio, GPIO_DEVICE_ID);
+	XGpio_SetDataDirection(&Gpio, LED_CHANNEL, 0x0);
+	XGpio_SetDataDirection(&Gpio, BTN_CHANNEL, 0xf);
+
+#ifdef GPIOREC_REPLAY
+	Replay();
+#else
+	Record();
+#endif
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Input path under test: debounce lockout, LEDs, checksum */
+static void ButtonInput(u16 Port, u32 Value)
+{
+	u64 Now = GpioRec_NowUs();
+
+	if (Port != PORT_BTN || Value == Btn.Value)
+		return;
+	if (Now - Btn.LastUs < DEBOUNCE_US)
+		return;
+
+	Btn.LastUs = Now;
+	Btn.Value = Value;
+	Btn.Accepted++;
+	Btn.Sum = (Btn.Sum ^ Value ^ (u32)Now) * 16777619u;
+
+	XGpio_DiscreteWrite(&Gpio, LED_CHANNEL, Value);
+}
+
+
+static void ButtonReset(void)
+{
+	Btn.LastUs = 0;
+	Btn.Value = 0;
+	Btn.Accepted = 0;
+	Btn.Sum = 2166136261u;
+}
+
+
+#ifdef GPIOREC_REPLAY
+
+/* REPEAT untimed replays, then one at SPEEDUP; the sums must all agree */
+static void Replay(void)
+{
+	u32 c0, Run, Sum = 0;
+	u64 t0;
+	int i;
+
+	pmccntr_start();
+
+	printf("\r\nreplay of %d records\r\n", CAPTURE_LEN);
+	for (i = 0; i < REPEAT; i++) {
+		ButtonReset();
+		c0 = pmccntr_read();
+		GpioRec_Replay(GpioRecCapture, CAPTURE_LEN, 0, ButtonInput);
+		Run = pmccntr_read() - c0;
+		if (i == 0)
+			Sum = Btn.Sum;
+		printf("run %2d: %d cycles,", i, Run);
+		pmccntr_print_per(Run, CAPTURE_LEN);
+		printf(" per input, %d accepted, sum %08x%s\r\n", Btn.Accepted, Btn.Sum,
+		       Btn.Sum == Sum ? "" : "  DIFFERS");
+	}
+
+	ButtonReset();
+	t0 = GpioRec_NowUs();
+	GpioRec_Replay(GpioRecCapture, CAPTURE_LEN, SPEEDUP, ButtonInput);
+	printf("x%d: replayed in %d us, %d accepted, sum %08x%s\r\n",
+	       SPEEDUP, (u32)(GpioRec_NowUs() - t0), Btn.Accepted, Btn.Sum,
+	       Btn.Sum == Sum ? "" : "  DIFFERS");
+}
+
+#else
+
+/* Buttons recorded for RECORD_SECONDS, then printed as gpio_rec_capture.h */
+static void Record(void)
+{
+	u64 t0;
+
+	ButtonReset();
+	GpioRec_Start(Recording, RECORD_LEN);
+	GpioRec_Sample(PORT_BTN, XGpio_DiscreteRead(&Gpio, BTN_CHANNEL));
+
+	if (IntcInitFunction(INTC_DEVICE_ID, &Gpio) != XST_SUCCESS) {
+		printf("Failed to initialize Interrupt Controller\r\n");
+		return;
+	}
+	printf("Recording the buttons for %d s\r\n", RECORD_SECONDS);
+
+	t0 = GpioRec_NowUs();
+	while (GpioRec_NowUs() - t0 < RECORD_SECONDS * 1000000ULL &&
+	       GpioRec_Count() < RECORD_LEN)
+		;
+
+	Xil_ExceptionDisable();
+	printf("%d accepted\r\n", Btn.Accepted);
+	GpioRec_Dump("GpioRecCapture");
+}
+
+
+/* Recording: what the button handler of BtnInt.c does, plus the record */
+static void BTN_Intr_Handler(void *InstancePtr)
+{
+	u32 Value;
+
+	if ((XGpio_InterruptGetStatus(&Gpio) & BTN_INT) != BTN_INT)
+		return;
+
+	Value = XGpio_DiscreteRead(&Gpio, BTN_CHANNEL);
+	GpioRec_Sample(PORT_BTN, Value);
+	ButtonInput(PORT_BTN, Value);
+
+	(void)XGpio_InterruptClear(&Gpio, BTN_INT);
+}
+
+
+static int IntcInitFunction(u16 DeviceId, XGpio *GpioInstancePtr)
+{
+	XScuGic_Config *IntcConfig;
+	int status;
+
+	IntcConfig = XScuGic_LookupConfig(DeviceId);
+	status = XScuGic_CfgInitialize(&INTCInst, IntcConfig, IntcConfig->CpuBaseAddress);
+	if (status != XST_SUCCESS) return XST_FAILURE;
+
+	status = XScuGic_Connect(&INTCInst, INTC_GPIO_INTERRUPT_ID,
+				 (Xil_ExceptionHandler)BTN_Intr_Handler,
+				 (void *)GpioInstancePtr);
+	if (status != XST_SUCCESS) return XST_FAILURE;
+
+	XScuGic_Enable(&INTCInst, INTC_GPIO_INTERRUPT_ID);
+	XGpio_InterruptEnable(GpioInstancePtr, BTN_INT);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				     (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				     &INTCInst);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * gpio_rec_capture.h
+ *
+ *  Recording replayed by gpio_rec_bench.c built with GPIOREC_REPLAY
+ */
+
+/*
+ * Replace with the output of a recording run (GpioRec_Dump). This one is
+ * written by hand: BTN0 and then BTN1 pressed and released, every edge
+ * with contact bounce of a few hundred microseconds.
+ */
+/* gpio_rec: 20 records, 0 changes lost */
+static const gpiorec_t GpioRecCapture[] = {
+	{    1200000, 0x0000, 0, 0x00000001 },
+	{        150, 0x0000, 0, 0x00000000 },
+	{         90, 0x0000, 0, 0x00000001 },
+	{        200, 0x0000, 0, 0x00000000 },
+	{         60, 0x0000, 0, 0x00000001 },
+	{     180000, 0x0000, 0, 0x00000000 },
+	{        120, 0x0000, 0, 0x00000001 },
+	{        300, 0x0000, 0, 0x00000000 },
+	{        450, 0x0000, 0, 0x00000001 },
+	{         80, 0x0000, 0, 0x00000000 },
+	{    2500000, 0x0000, 0, 0x00000002 },
+	{         40, 0x0000, 0, 0x00000000 },
+	{        110, 0x0000, 0, 0x00000002 },
+	{      95000, 0x0000, 0, 0x00000000 },
+	{         70, 0x0000, 0, 0x00000002 },
+	{        250, 0x0000, 0, 0x00000000 },
+	{      30000, 0x0000, 0, 0x00000002 },
+	{         90, 0x0000, 0, 0x00000000 },
+	{        160, 0x0000, 0, 0x00000002 },
+	{      40000, 0x0000, 0, 0x00000000 },
+};
@@ -0,0 +1,110 @@
+/*
+ * hotpath.c
+ *
+ *  OCM copy and L2 way locking (see hotpath.h)
+ */
+
+/* Include Files */
+#include <string.h>
+#include "xil_cache.h"
+#include "xpseudo_asm.h"
+#include "mmio.h"
+#include "hotpath.h"
+
+/* Definitions */
+#define L2CC_BASE		0xF8F02000	/* PL310 L2 cache controller */
+#define L2CC_D_LOCKDOWN(m)	(0x900 + 8 * (m))	/* ways master m may not allocate in */
+#define L2CC_I_LOCKDOWN(m)	(0x904 + 8 * (m))
+#define L2CC_MASTERS		8
+#define L2CC_WAYS		0xFF
+#define L2_LINE			32
+#define CPSR_IF			0xC0		/* IRQ and FIQ masked */
+
+/* Function Prototypes */
+static void Hot_SetLockdown(u32 Ways);
+
+
+/*****************************************************************************
+ * Function: Hot_Init()
+ *
+ * Runs before main(): copies the OCM sections from their load address in
+ * DDR and makes the copied code visible to the instruction side. The vector
+ * table is among them, so no exception may happen before this runs.
+ * Left out with HOTPATH_DDR, where there is nothing to copy
+ *
+ *****************************************************************************/
+#ifndef HOTPATH_DDR
+__attribute__((constructor(101)))
+static void Hot_Init(void)
+{
+	u32 Len = __ocm_end - __ocm_start;
+
+	if (Len == 0)
+		return;
+
+	memcpy(__ocm_start, __ocm_load, Len);
+	Xil_DCacheFlushRange((INTPTR)__ocm_start, Len);
+	Xil_ICacheInvalidateRange((INTPTR)__ocm_start, Len);
+}
+#endif
+
+
+/*****************************************************************************
+ * Function: Hot_LockL2()
+ *
+ * Loads [Start, Start + Len) into the L2 ways of the Ways mask and locks
+ * them: while the range is touched no other way may allocate, afterwards
+ * the Ways may not allocate, so the lines stay until Hot_UnlockL2(). The
+ * ways should be large enough for the range (64 KB each); a few lines of
+ * this function and its stack may land in them too
+ *
+ *****************************************************************************/
+void Hot_LockL2(const void *Start, u32 Len, u32 Ways)
+{
+	UINTPTR Addr = (UINTPTR)Start & ~(L2_LINE - 1);
+	UINTPTR End = (UINTPTR)Start + Len;
+	u32 cpsr;
+
+	cpsr = mfcpsr();
+	mtcpsr(cpsr | CPSR_IF);
+
+	/* out of every level, so the reads below allocate again */
+	Xil_DCacheFlushRange((INTPTR)Start, Len);
+	Xil_ICacheInvalidateRange((INTPTR)Start, Len);
+
+	Hot_SetLockdown(~Ways & L2CC_WAYS);
+	for (; Addr < End; Addr += L2_LINE)
+		(void)mmio_read32(Addr);
+	dsb();
+	Hot_SetLockdown(Ways);
+
+	mtcpsr(cpsr);
+}
+
+
+/* Lets every master allocate in every way again */
+void Hot_UnlockL2(void)
+{
+	Hot_SetLockdown(0);
+}
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Same lockdown for data and instruction fetches of every master */
+static void Hot_SetLockdown(u32 Ways)
+{
+	int m;
+
+	dsb();
+	for (m = 0; m < L2CC_MASTERS; m++) {
+		mmio_write32(L2CC_BASE + L2CC_D_LOCKDOWN(m), Ways);
+		mmio_write32(L2CC_BASE + L2CC_I_LOCKDOWN(m), Ways);
+	}
+	dsb();
+}
@@ -0,0 +1,73 @@
+/*
+ * hotpath.h
+ *
+ *  Placement of interrupt code and tables in OCM, or in locked L2 ways
+ */
+
+/********************************************************************************************
+ *
+ * The BSP links everything into DDR. A handler that runs every 100 us but not in between
+ * loses its lines to the main loop and pays DDR misses on every entry: the vector table,
+ * the GIC dispatcher, the handler and the table it reads. Two ways to keep them close:
+ *
+ *   OCM_TEXT, OCM_RODATA, OCM_DATA
+ *	The function or object goes to the low OCM (0x00000000, 192 KB, fixed ~20-cycle
+ *	latency, no DDR behind it). lscript_ocm.ld puts the vector table, the GIC dispatcher
+ *	and the stacks there too. The FSBL runs from that OCM, so these sections are loaded
+ *	into DDR with the program and copied into place by a constructor before main().
+ *
+ *   L2_TEXT, L2_RODATA, L2_DATA
+ *	The function or object stays in DDR, grouped between __l2lock_start and __l2lock_end
+ *	by lscript_ocm.ld, and Hot_LockL2() loads the group into chosen L2 ways and locks
+ *	them, so nothing else can evict it (each way is 64 KB taken from the 512 KB L2).
+ *
+ *   OCM_TEXT static void PrivateTimerIntrHandler(void *InstancePtr);
+ *   OCM_RODATA const int sine[SINE_TABLE_SIZE] = { ... };
+ *
+ * Link with lscript_ocm.ld and hotpath.c: the OCM copy needs the load symbols of the
+ * script. Functions called from OCM code, like the drivers, stay where they are unless the
+ * script names them.
+ *
+ * Built with HOTPATH_DDR, the macros expand to nothing and nothing refers to the symbols of
+ * the script, so the same source links with the BSP's lscript.ld and keeps the whole
+ * interrupt path, vector table and GIC dispatcher included, in DDR: the baseline to compare
+ * against.
+ *
+ ********************************************************************************************/
+
+#ifndef HOTPATH_H
+#define HOTPATH_H
+
+/* Include Files */
+#include "xil_types.h"
+
+/* Definitions */
+#ifdef HOTPATH_DDR
+#define OCM_TEXT	__attribute__((noinline))
+#define OCM_RODATA
+#define OCM_DATA
+
+#define L2_TEXT		__attribute__((noinline))
+#define L2_RODATA
+#define L2_DATA
+#else
+#define OCM_TEXT	__attribute__((section(".ocm_text"), noinline))
+#define OCM_RODATA	__attribute__((section(".ocm_rodata")))
+#define OCM_DATA	__attribute__((section(".ocm_data")))
+
+#define L2_TEXT		__attribute__((section(".l2lock_text"), noinline))
+#define L2_RODATA	__attribute__((section(".l2lock_rodata")))
+#define L2_DATA		__attribute__((section(".l2lock_data")))
+
+/* Section bounds from lscript_ocm.ld */
+extern char __ocm_start[], __ocm_end[], __ocm_load[];
+extern char __l2lock_start[], __l2lock_end[];
+#endif
+
+#define L2_WAY(n)	(1u << (n))		/* way mask bit, n = 0..7 */
+
+/* Function Prototypes */
+void Hot_LockL2(const void *Start, u32 Len, u32 Ways);
+void Hot_UnlockL2(void);
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ * hotpath_bench.c
+ *
+ *  Private timer interrupt latency with the handler in DDR, locked in L2 or in OCM
+ */
+
+/********************************************************************************************
+ * The private timer interrupts every TIMER_LOAD + 1 ticks and reloads itself, so on entry
+ * to the handler LOAD - counter is the time since the interrupt was raised: vector, IRQ
+ * entry, GIC dispatch and the first lines of the handler. The handler then does what the
+ * sine PWM handlers do, a table read and a GPIO write, and measures that as its duration.
+ * Between interrupts the main loop walks a 1 MB buffer, twice the L2, so every interrupt
+ * finds the caches cold, as after a busy main loop.
+ *
+ * The same handler and table are built three times:
+ *
+ *   DDR		plain, where the BSP puts them
+ *   DDR, L2 locked	L2_TEXT/L2_RODATA, loaded into L2 way 7 and locked there
+ *   OCM		OCM_TEXT/OCM_RODATA
+ *
+ * each with its table position next to it, and each runs SAMPLES interrupts. The statistics
+ * are updated after the second timer read and stay in DDR. Rows print mean and worst case
+ * in CPU cycles (the private timer counts at CPU/2).
+ *
+ * Linked with lscript_ocm.ld the vector table and the GIC dispatcher are in OCM for all
+ * three rows. Built with HOTPATH_DDR and linked with the BSP's lscript.ld, only the first
+ * row runs, as "DDR, all": vectors, dispatcher, handler and table all in DDR, the baseline
+ * for the other rows. No board figures have been recorded for either build.
+ *
+ * HW platform: AXI GPIO 0 with LEDs in Ch1. Build with -O2 and hotpath.c, and either
+ * lscript_ocm.ld or HOTPATH_DDR with lscript.ld.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "mmio.h"
+#include "hotpath.h"
+
+/* Definitions */
+#define INTC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID	/* GIC device ID */
+#define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID	/* Device ID for Private Timer */
+#define TIMER_IRPT_INTR		XPAR_SCUTIMER_INTR		/* Private Timer interrupt ID */
+#define TIMER_LOAD		33349				/* 100 us at PERIPHCLK = 333.5 MHz */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define SAMPLES			2000				/* interrupts per row */
+#define SINE_TABLE_SIZE		50
+#define THRASH_BYTES		(1024 * 1024)
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+/* Same values as the sine table of axi_timer_pwm_student.c */
+#define SINE_VALUES	500000,562667,624345,684062,740877,793893,842274,		\
+			885257,922164,952414,975528,991144,999013,999013,991144,	\
+			975528,952414,922164,885257,842274,793893,740877,684062,	\
+			624345,562667,500000,437333,375655,315938,259123,206107,	\
+			157726,114743,77836,47586,24472,8856,987,987,8856,24472,	\
+			47586,77836,114743,157726,206107,259123,315938,375655,437333
+
+/************************** Hardware Instances  ******************************/
+
+XScuGic INTCInst;		/* Instance of the GIC */
+XScuTimer TimerInst;		/* Cortex A9 Scu Private Timer Instance */
+
+const u32 SineDdr[SINE_TABLE_SIZE] = { SINE_VALUES };
+#ifndef HOTPATH_DDR
+L2_RODATA const u32 SineL2[SINE_TABLE_SIZE] = { SINE_VALUES };
+OCM_RODATA const u32 SineOcm[SINE_TABLE_SIZE] = { SINE_VALUES };
+#endif
+
+/* Table position of each handler, placed with it */
+static u32 IndexDdr;
+#ifndef HOTPATH_DDR
+L2_DATA static u32 IndexL2;
+OCM_DATA static u32 IndexOcm;
+#endif
+
+static volatile struct {
+	u32 Count;
+	u32 LatSum, LatMax;
+	u32 DurSum, DurMax;
+} Stats;
+
+static u8 Thrash[THRASH_BYTES];
+
+/**************  Function Prototypes **************/
+
+static void DdrHandler(void *InstancePtr);
+#ifndef HOTPATH_DDR
+L2_TEXT static void L2Handler(void *InstancePtr);
+OCM_TEXT static void OcmHandler(void *InstancePtr);
+#endif
+static void Run(const char *Name, Xil_ExceptionHandler Handler);
+static int IntcInitFunction(u16 DeviceId);
+
+
+/*************** Main function ********************/
+int main(void){
+	XScuTimer_Config *ConfigPtr;
+
+	gpio_set_direction(GPIO0_BASE, LED_CHANNEL, 0x0);
+
+	ConfigPtr = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	XScuTimer_CfgInitialize(&TimerInst, ConfigPtr, ConfigPtr->BaseAddr);
+	XScuTimer_EnableAutoReload(&TimerInst);
+	XScuTimer_EnableInterrupt(&TimerInst);
+	XScuTimer_LoadTimer(&TimerInst, TIMER_LOAD);
+
+	if (IntcInitFunction(INTC_DEVICE_ID) != XST_SUCCESS) {
+		printf("Failed to initialize Interrupt Controller\r\n");
+		return XST_FAILURE;
+	}
+
+	printf("\r\ncycles from IRQ to handler, handler body\r\n");
+	printf("                      mean  worst    mean  worst\r\n");
+
+#ifdef HOTPATH_DDR
+	Run("DDR, all", DdrHandler);
+#else
+	Run("DDR", DdrHandler);
+
+	Hot_LockL2(__l2lock_start, __l2lock_end - __l2lock_start, L2_WAY(7));
+	Run("DDR, L2 locked", L2Handler);
+	Hot_UnlockL2();
+
+	Run("OCM", OcmHandler);
+#endif
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Handler body, copied into each handler so it lives where the handler does */
+static inline __attribute__((always_inline)) void Sample(const u32 *Table, u32 *Index)
+{
+	u32 Entry, Exit;
+
+	Entry = scutimer_counter(SCUTIMER_BASE);
+	scutimer_clear(SCUTIMER_BASE);
+
+	gpio_write(GPIO0_BASE, LED_CHANNEL, Table[*Index] >> 16);
+	*Index = *Index == SINE_TABLE_SIZE - 1 ? 0 : *Index + 1;
+
+	Exit = scutimer_counter(SCUTIMER_BASE);
+
+	Stats.LatSum += TIMER_LOAD - Entry;
+	if (TIMER_LOAD - Entry > Stats.LatMax)
+		Stats.LatMax = TIMER_LOAD - Entry;
+	Stats.DurSum += Entry - Exit;
+	if (Entry - Exit > Stats.DurMax)
+		Stats.DurMax = Entry - Exit;
+	Stats.Count++;
+}
+
+
+static void DdrHandler(void *InstancePtr)
+{
+	Sample(SineDdr, &IndexDdr);
+}
+
+
+#ifndef HOTPATH_DDR
+static void L2Handler(void *InstancePtr)
+{
+	Sample(SineL2, &IndexL2);
+}
+
+
+static void OcmHandler(void *InstancePtr)
+{
+	Sample(SineOcm, &IndexOcm);
+}
+#endif
+
+
+/* SAMPLES interrupts with Handler while the main loop evicts the caches */
+static void Run(const char *Name, Xil_ExceptionHandler Handler)
+{
+	u32 i, Sink = 0;
+
+	Stats.Count = 0;
+	Stats.LatSum = Stats.LatMax = 0;
+	Stats.DurSum = Stats.DurMax = 0;
+
+	XScuGic_Connect(&INTCInst, TIMER_IRPT_INTR, Handler, NULL);
+	XScuGic_Enable(&INTCInst, TIMER_IRPT_INTR);
+	XScuTimer_Start(&TimerInst);
+
+	while (Stats.Count < SAMPLES)
+		for (i = 0; i < THRASH_BYTES; i += 32)
+			Sink += *(volatile u8 *)&Thrash[i];
+
+	XScuTimer_Stop(&TimerInst);
+	XScuGic_Disable(&INTCInst, TIMER_IRPT_INTR);
+	XScuGic_Disconnect(&INTCInst, TIMER_IRPT_INTR);
+
+	/* timer ticks are two CPU cycles */
+	printf("%-20s %6d %6d  %6d %6d\r\n", Name,
+	       2 * Stats.LatSum / Stats.Count, 2 * Stats.LatMax,
+	       2 * Stats.DurSum / Stats.Count, 2 * Stats.DurMax);
+	(void)Sink;
+}
+
+
+static int IntcInitFunction(u16 DeviceId)
+{
+	XScuGic_Config *IntcConfig;
+	int status;
+
+	IntcConfig = XScuGic_LookupConfig(DeviceId);
+	status = XScuGic_CfgInitialize(&INTCInst, IntcConfig, IntcConfig->CpuBaseAddress);
+	if (status != XST_SUCCESS) return XST_FAILURE;
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				     (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				     &INTCInst);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+}
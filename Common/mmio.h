@@ -0,0 +1,332 @@
+/*
+ * mmio.h
+ *
+ *  Header-only register access for the Zynq peripherals used in the examples
+ */
+
+/********************************************************************************************
+ *
+ * The Xilinx drivers reach a register through the instance struct: XGpio_DiscreteWrite()
+ * is a call that loads BaseAddress from the struct, checks IsReady, adds the channel offset
+ * and stores. Here every base address, offset and field is a compile-time constant and
+ * every accessor is static inline, so with optimisation on an access compiles to the
+ * constant address (MOVW/MOVT or one literal load, shared between accesses) and one LDR
+ * or STR; several fields of one register are merged into a single read-modify-write.
+ *
+ *   gpio_write(GPIO0_BASE, 2, 0x5);			one STR
+ *   n = scutimer_counter(SCUTIMER_BASE);		one LDR
+ *   mmio_update32(SCUTIMER_BASE + SCUTIMER_CONTROL,	one LDR, one STR
+ *	SCUTIMER_CONTROL_PRESCALER | SCUTIMER_CONTROL_AUTO_RELOAD,
+ *	FIELD_PREP(SCUTIMER_CONTROL_PRESCALER, 1) | SCUTIMER_CONTROL_AUTO_RELOAD);
+ *
+ * Fields are masks in place (SCUTIMER_CONTROL_PRESCALER = 0xFF00); FIELD_PREP shifts a
+ * value into a mask and FIELD_GET takes it out, both folded by the compiler when the mask
+ * is a constant. The layouts are the ones the examples use (XGpio, XScuTimer, XTtcPs, global
+ * timer) and the MultiCycle models of them.
+ *
+ * There is no IsReady check and no locking: read-modify-write sequences are not atomic
+ * against interrupt handlers touching the same register; wrap them in irq_save() and
+ * irq_restore() where a handler shares it.
+ *
+ ********************************************************************************************/
+
+#ifndef MMIO_H
+#define MMIO_H
+
+/* Include Files */
+#include <stdint.h>
+#include "xparameters.h"
+
+/* Generic access */
+#define MMIO_INLINE	static inline __attribute__((always_inline))
+
+MMIO_INLINE uint32_t mmio_read32(uintptr_t addr)
+{
+	return *(volatile uint32_t *)addr;
+}
+
+MMIO_INLINE void mmio_write32(uintptr_t addr, uint32_t value)
+{
+	*(volatile uint32_t *)addr = value;
+}
+
+/* One read and one write: the bits in mask are replaced by those of value */
+MMIO_INLINE void mmio_update32(uintptr_t addr, uint32_t mask, uint32_t value)
+{
+	volatile uint32_t *reg = (volatile uint32_t *)addr;
+
+	*reg = (*reg & ~mask) | (value & mask);
+}
+
+#define FIELD_SHIFT(mask)	(__builtin_ctz(mask))
+#define FIELD_PREP(mask, val)	(((uint32_t)(val) << FIELD_SHIFT(mask)) & (mask))
+#define FIELD_GET(mask, reg)	(((uint32_t)(reg) & (mask)) >> FIELD_SHIFT(mask))
+
+
+/********************************************************************************************
+ * CPSR interrupt masks of the calling core, for short critical sections
+ ********************************************************************************************/
+#define CPSR_I			0x00000080		/* IRQ masked */
+#define CPSR_F			0x00000040		/* FIQ masked */
+
+/* IRQ off; returns the CPSR for irq_restore() */
+MMIO_INLINE uint32_t irq_save(void)
+{
+	uint32_t cpsr;
+
+	__asm__ volatile("mrs %0, cpsr\n\tcpsid i" : "=r"(cpsr) :: "memory");
+	return cpsr;
+}
+
+/* IRQ and FIQ off, for data an FIQ handler shares too */
+MMIO_INLINE uint32_t irq_fiq_save(void)
+{
+	uint32_t cpsr;
+
+	__asm__ volatile("mrs %0, cpsr\n\tcpsid if" : "=r"(cpsr) :: "memory");
+	return cpsr;
+}
+
+/* Puts back the I and F bits (and the rest of the control field) saved above */
+MMIO_INLINE void irq_restore(uint32_t cpsr)
+{
+	__asm__ volatile("msr cpsr_c, %0" :: "r"(cpsr) : "memory");
+}
+
+
+/********************************************************************************************
+ * AXI GPIO (XGpio), channel 1 or 2
+ ********************************************************************************************/
+#ifdef XPAR_AXI_GPIO_0_BASEADDR
+#define GPIO0_BASE		XPAR_AXI_GPIO_0_BASEADDR
+#endif
+#ifdef XPAR_AXI_GPIO_1_BASEADDR
+#define GPIO1_BASE		XPAR_AXI_GPIO_1_BASEADDR
+#endif
+
+#define GPIO_DATA(ch)		(((ch) - 1) * 8)	/* 0x000, 0x008 */
+#define GPIO_TRI(ch)		(((ch) - 1) * 8 + 4)	/* 0x004, 0x00C, 1 = input */
+#define GPIO_GIER		0x11C
+#define GPIO_GIER_ENABLE	0x80000000
+#define GPIO_ISR		0x120			/* write 1 to toggle */
+#define GPIO_IER		0x128
+#define GPIO_IR_CH(ch)		(1u << ((ch) - 1))
+
+MMIO_INLINE uint32_t gpio_read(uintptr_t base, unsigned ch)
+{
+	return mmio_read32(base + GPIO_DATA(ch));
+}
+
+MMIO_INLINE void gpio_write(uintptr_t base, unsigned ch, uint32_t value)
+{
+	mmio_write32(base + GPIO_DATA(ch), value);
+}
+
+MMIO_INLINE void gpio_set_direction(uintptr_t base, unsigned ch, uint32_t inputs)
+{
+	mmio_write32(base + GPIO_TRI(ch), inputs);
+}
+
+MMIO_INLINE uint32_t gpio_irq_status(uintptr_t base)
+{
+	return mmio_read32(base + GPIO_ISR);
+}
+
+MMIO_INLINE void gpio_irq_clear(uintptr_t base, uint32_t mask)
+{
+	mmio_write32(base + GPIO_ISR, mask);
+}
+
+
+/********************************************************************************************
+ * Cortex-A9 private timer (XScuTimer), banked per core
+ ********************************************************************************************/
+#define SCUTIMER_BASE			XPAR_PS7_SCUTIMER_0_BASEADDR	/* 0xF8F00600 */
+
+#define SCUTIMER_LOAD			0x00
+#define SCUTIMER_COUNTER		0x04
+#define SCUTIMER_CONTROL		0x08
+#define SCUTIMER_CONTROL_ENABLE		0x00000001
+#define SCUTIMER_CONTROL_AUTO_RELOAD	0x00000002
+#define SCUTIMER_CONTROL_IRQ_ENABLE	0x00000004
+#define SCUTIMER_CONTROL_PRESCALER	0x0000FF00
+#define SCUTIMER_ISR			0x0C		/* event flag, write 1 to clear */
+#define SCUTIMER_ISR_EVENT		0x00000001
+
+MMIO_INLINE uint32_t scutimer_counter(uintptr_t base)
+{
+	return mmio_read32(base + SCUTIMER_COUNTER);
+}
+
+MMIO_INLINE void scutimer_load(uintptr_t base, uint32_t value)
+{
+	mmio_write32(base + SCUTIMER_LOAD, value);
+}
+
+MMIO_INLINE int scutimer_expired(uintptr_t base)
+{
+	return mmio_read32(base + SCUTIMER_ISR) & SCUTIMER_ISR_EVENT;
+}
+
+MMIO_INLINE void scutimer_clear(uintptr_t base)
+{
+	mmio_write32(base + SCUTIMER_ISR, SCUTIMER_ISR_EVENT);
+}
+
+
+/********************************************************************************************
+ * Triple timer counter (XTtcPs), counter n = 0..2 of a TTC
+ ********************************************************************************************/
+#ifdef XPAR_PS7_TTC_0_BASEADDR
+#define TTC0_BASE		XPAR_PS7_TTC_0_BASEADDR		/* 0xF8001000 */
+#endif
+
+#define TTC_CLK_CNTRL(n)	(0x00 + 4 * (n))
+#define TTC_CLK_PS_EN		0x00000001
+#define TTC_CLK_PS_VAL		0x0000001E		/* count every 2^(N+1) */
+#define TTC_CNT_CNTRL(n)	(0x0C + 4 * (n))
+#define TTC_CNT_DIS		0x00000001
+#define TTC_CNT_INTERVAL	0x00000002
+#define TTC_CNT_DECREMENT	0x00000004
+#define TTC_CNT_MATCH		0x00000008
+#define TTC_CNT_RESET		0x00000010
+#define TTC_CNT_WAVE_DIS	0x00000020
+#define TTC_CNT_WAVE_POL	0x00000040
+#define TTC_VALUE(n)		(0x18 + 4 * (n))
+#define TTC_INTERVAL(n)		(0x24 + 4 * (n))
+#define TTC_MATCH_1(n)		(0x30 + 4 * (n))
+#define TTC_MATCH_2(n)		(0x3C + 4 * (n))
+#define TTC_MATCH_3(n)		(0x48 + 4 * (n))
+#define TTC_ISR(n)		(0x54 + 4 * (n))	/* cleared when read */
+#define TTC_IER(n)		(0x60 + 4 * (n))
+#define TTC_IXR_INTERVAL	0x00000001
+#define TTC_IXR_MATCH_1		0x00000002
+#define TTC_IXR_OVERFLOW	0x00000010
+
+MMIO_INLINE uint32_t ttc_value(uintptr_t base, unsigned n)
+{
+	return mmio_read32(base + TTC_VALUE(n));
+}
+
+MMIO_INLINE void ttc_set_match(uintptr_t base, unsigned n, uint32_t match)
+{
+	mmio_write32(base + TTC_MATCH_1(n), match);
+}
+
+MMIO_INLINE uint32_t ttc_irq_status(uintptr_t base, unsigned n)
+{
+	return mmio_read32(base + TTC_ISR(n));
+}
+
+
+/********************************************************************************************
+ * PS UART (XUartPs), 64-byte FIFOs
+ ********************************************************************************************/
+#ifdef XPAR_PS7_UART_1_BASEADDR
+#define UART1_BASE		XPAR_PS7_UART_1_BASEADDR	/* 0xE0001000, Zybo USB-UART */
+#endif
+
+#define UART_FIFO_DEPTH		64
+#define UART_IER		0x08
+#define UART_IDR		0x0C
+#define UART_IMR		0x10
+#define UART_ISR		0x14			/* write 1 to clear */
+#define UART_IXR_TEMPTY		0x00000008
+#define UART_SR			0x2C
+#define UART_SR_TXEMPTY		0x00000008
+#define UART_SR_TXFULL		0x00000010
+#define UART_FIFO		0x30
+
+MMIO_INLINE int uart_tx_full(uintptr_t base)
+{
+	return mmio_read32(base + UART_SR) & UART_SR_TXFULL;
+}
+
+MMIO_INLINE int uart_tx_empty(uintptr_t base)
+{
+	return mmio_read32(base + UART_SR) & UART_SR_TXEMPTY;
+}
+
+MMIO_INLINE void uart_putc(uintptr_t base, char c)
+{
+	mmio_write32(base + UART_FIFO, (uint8_t)c);
+}
+
+
+/********************************************************************************************
+ * AXI Timer (XTmrCtr), timer n = 0 or 1; in PWM mode TLR0 sets the period, TLR1 the high time
+ ********************************************************************************************/
+#ifdef XPAR_TMRCTR_0_BASEADDR
+#define TMRCTR0_BASE		XPAR_TMRCTR_0_BASEADDR
+#endif
+
+#define TMRCTR_TCSR(n)		(0x10 * (n))
+#define TMRCTR_TLR(n)		(0x10 * (n) + 0x04)	/* loaded at the next reload */
+#define TMRCTR_TCR(n)		(0x10 * (n) + 0x08)
+
+MMIO_INLINE void tmrctr_load(uintptr_t base, unsigned n, uint32_t value)
+{
+	mmio_write32(base + TMRCTR_TLR(n), value);
+}
+
+
+/********************************************************************************************
+ * GIC (XScuGic): CPU interface, banked per core, and distributor
+ ********************************************************************************************/
+#define GIC_CPU_BASE		0xF8F00100
+#define GIC_DIST_BASE		0xF8F01000
+#define GIC_IDS			96
+
+#define GIC_ICCICR		0x00
+#define GIC_ICCICR_ENABLE_S	0x00000001
+#define GIC_ICCICR_ENABLE_NS	0x00000002
+#define GIC_ICCICR_ACK_CTL	0x00000004		/* group 1 acknowledged from secure */
+#define GIC_ICCICR_FIQ_EN	0x00000008		/* group 0 signalled as FIQ */
+#define GIC_ICCPMR		0x04
+#define GIC_ICCIAR		0x0C			/* acknowledge: read the ID */
+#define GIC_ICCEOIR		0x10			/* end of interrupt: write the ID */
+
+#define GIC_ICDDCR		0x000
+#define GIC_ICDDCR_ENABLE_S	0x00000001		/* forward group 0 */
+#define GIC_ICDDCR_ENABLE_NS	0x00000002		/* forward group 1 */
+#define GIC_ICDISR(id)		(0x080 + 4 * ((id) / 32))	/* 0 group 0, 1 group 1 */
+#define GIC_ICDISPR(id)		(0x200 + 4 * ((id) / 32))	/* write 1 to set pending */
+#define GIC_BIT(id)		(1u << ((id) % 32))
+
+MMIO_INLINE void gic_set_pending(unsigned id)
+{
+	mmio_write32(GIC_DIST_BASE + GIC_ICDISPR(id), GIC_BIT(id));
+}
+
+
+/********************************************************************************************
+ * Global timer, shared by both cores, counts at the CPU clock / 2
+ ********************************************************************************************/
+#define GTIMER_BASE		0xF8F00200
+
+#define GTIMER_COUNT_LO		0x00
+#define GTIMER_COUNT_HI		0x04
+#define GTIMER_CONTROL		0x08
+#define GTIMER_CONTROL_ENABLE	0x00000001
+#define GTIMER_TICKS_PER_US	(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2 / 1000000)
+
+/* Low word only: enough to time anything shorter than 12 s at 333 MHz */
+MMIO_INLINE uint32_t gtimer_now32(void)
+{
+	return mmio_read32(GTIMER_BASE + GTIMER_COUNT_LO);
+}
+
+/* Both words, read again if the low word wrapped in between */
+MMIO_INLINE uint64_t gtimer_now64(void)
+{
+	uint32_t hi, lo;
+
+	do {
+		hi = mmio_read32(GTIMER_BASE + GTIMER_COUNT_HI);
+		lo = mmio_read32(GTIMER_BASE + GTIMER_COUNT_LO);
+	} while (hi != mmio_read32(GTIMER_BASE + GTIMER_COUNT_HI));
+
+	return ((uint64_t)hi << 32) | lo;
+}
+
+#endif
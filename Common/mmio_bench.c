@@ -0,0 +1,146 @@
+/*
+ * mmio_bench.c
+ *
+ *  Cycles per register access: Xilinx drivers against mmio.h
+ */
+
+/********************************************************************************************
+ * Times the hot-path accesses of the examples both ways, with the Cortex-A9 cycle counter
+ * (PMCCNTR, CPU clock):
+ *
+ *   GPIO write	XGpio_DiscreteWrite()		gpio_write()
+ *   GPIO read	XGpio_DiscreteRead()		gpio_read()
+ *   timer read	XScuTimer_GetCounterValue()	scutimer_counter()
+ *   timer load	XScuTimer_LoadTimer()		scutimer_load()
+ *
+ * Every row runs REPEAT accesses back to back and prints cycles per access, minus the cost
+ * of the empty timing loop. The AXI GPIO rows include the PL bus round trip (reads wait for
+ * it, writes are posted), which is the same for both columns; the difference between the
+ * columns is the driver overhead. The private timer sits on the SCU, so its rows are close
+ * to the pure instruction cost.
+ *
+ * No figures are kept here: they depend on the bitstream and the build, so read them off
+ * the board.
+ *
+ * HW platform: AXI GPIO 0 with LEDs in Ch1 (as in the Timers examples). Build with -O2.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xscutimer.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "mmio.h"
+#include "pmccntr.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID	/* Device ID for Private Timer */
+#define REPEAT			1000				/* accesses per row */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+/************************** Hardware Instances  ******************************/
+
+XGpio GpioInst; 		/* Instance of the AXI GPIO */
+XScuTimer TimerInst;		/* Cortex A9 Scu Private Timer Instance */
+
+/* Keeps the compiler from dropping the reads */
+volatile u32 Sink;
+
+/**************  Function Prototypes **************/
+
+static void Row(const char *Name, u32 Driver, u32 Inline, u32 Loop);
+
+
+/*************** Main function ********************/
+int main(void){
+	XScuTimer_Config *ConfigPtr;
+	u32 t0, Loop, Driver, Inline;
+	u32 Acc;
+	int i;
+
+	XGpio_Initialize(&GpioInst, GPIO_DEVICE_ID);
+	XGpio_SetDataDirection(&GpioInst, LED_CHANNEL, 0x0);
+
+	ConfigPtr = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	XScuTimer_CfgInitialize(&TimerInst, ConfigPtr, ConfigPtr->BaseAddr);
+	XScuTimer_LoadTimer(&TimerInst, 0xFFFFFFFF);
+	XScuTimer_Start(&TimerInst);
+
+	pmccntr_start();
+
+	/* empty loop, subtracted from every row */
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		__asm__ volatile("" ::: "memory");
+	Loop = pmccntr_read() - t0;
+
+	printf("\r\ncycles per access      driver   mmio.h\r\n");
+
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, i);
+	Driver = pmccntr_read() - t0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		gpio_write(GPIO0_BASE, LED_CHANNEL, i);
+	Inline = pmccntr_read() - t0;
+	Row("GPIO write", Driver, Inline, Loop);
+
+	Acc = 0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		Acc += XGpio_DiscreteRead(&GpioInst, LED_CHANNEL);
+	Driver = pmccntr_read() - t0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		Acc += gpio_read(GPIO0_BASE, LED_CHANNEL);
+	Inline = pmccntr_read() - t0;
+	Sink = Acc;
+	Row("GPIO read", Driver, Inline, Loop);
+
+	Acc = 0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		Acc += XScuTimer_GetCounterValue(&TimerInst);
+	Driver = pmccntr_read() - t0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		Acc += scutimer_counter(SCUTIMER_BASE);
+	Inline = pmccntr_read() - t0;
+	Sink = Acc;
+	Row("timer read", Driver, Inline, Loop);
+
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		XScuTimer_LoadTimer(&TimerInst, 0xFFFFFFFF - i);
+	Driver = pmccntr_read() - t0;
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		scutimer_load(SCUTIMER_BASE, 0xFFFFFFFF - i);
+	Inline = pmccntr_read() - t0;
+	Row("timer load", Driver, Inline, Loop);
+
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, 0);
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* cycles per access, both columns */
+static void Row(const char *Name, u32 Driver, u32 Inline, u32 Loop)
+{
+	printf("%-20s", Name);
+	pmccntr_print_per(Driver - Loop, REPEAT);
+	pmccntr_print_per(Inline - Loop, REPEAT);
+	printf("\r\n");
+}
@@ -0,0 +1,57 @@
+/*
+ * pmccntr.h
+ *
+ *  Cortex-A9 cycle counter (PMCCNTR) for the *_bench.c programs
+ */
+
+/********************************************************************************************
+ *
+ * PMCCNTR counts CPU clocks of the core that reads it. pmccntr_start() zeroes and enables
+ * it; pmccntr_read() returns it after an ISB, so the instructions timed before the read
+ * have completed. The difference of two reads is right across one wrap of the 32-bit count
+ * (about 6 s at 667 MHz).
+ *
+ *   pmccntr_start();
+ *   t0 = pmccntr_read();
+ *   for (i = 0; i < REPEAT; i++) ...;
+ *   pmccntr_print_per(pmccntr_read() - t0 - Loop, REPEAT);	cycles per iteration
+ *
+ * The figures depend on the bitstream, the caches and the compiler flags, so the benches
+ * print them on the board and none are kept in the sources.
+ *
+ ********************************************************************************************/
+
+#ifndef PMCCNTR_H
+#define PMCCNTR_H
+
+/* Include Files */
+#include <stdint.h>
+#include "xil_printf.h"
+
+/* Definitions */
+#define PMCCNTR_INLINE	static inline __attribute__((always_inline))
+
+/* PMCR: enable, reset the cycle counter; PMCNTENSET: cycle counter on */
+PMCCNTR_INLINE void pmccntr_start(void)
+{
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(0x5));
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(0x80000000));
+}
+
+PMCCNTR_INLINE uint32_t pmccntr_read(void)
+{
+	uint32_t c;
+
+	__asm__ volatile("isb\n\tmrc p15, 0, %0, c9, c13, 0" : "=r"(c) :: "memory");
+	return c;
+}
+
+/* Cycles / Count as " nnnnnn.n", 9 columns; xil_printf has no %f */
+static inline void pmccntr_print_per(uint32_t Cycles, uint32_t Count)
+{
+	uint32_t c = (uint32_t)((uint64_t)Cycles * 10 / Count);
+
+	xil_printf(" %6d.%d", c / 10, c % 10);
+}
+
+#endif
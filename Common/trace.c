@@ -0,0 +1,84 @@
+/*
+ * trace.c
+ *
+ *  Trace rings and their decoder (see trace.h)
+ */
+
+/* Include Files */
+#include "xil_printf.h"
+#include "trace.h"
+
+/* One ring per core; in an AMP build each application only fills its own */
+trace_ring_t TraceRing[TRACE_CORES];
+
+/* Format of every event, in the order of trace_events.h */
+static const char *const TraceFormat[TRACE_EVENTS] = {
+#define TRACE_EVENT(id, format)	format,
+#include "trace_events.h"
+#undef TRACE_EVENT
+};
+
+
+/*****************************************************************************
+ * Function: trace_init()
+ *
+ * Starts the cycle counter the records are stamped with and empties the ring
+ * of this core
+ *
+ *****************************************************************************/
+void trace_init(void)
+{
+	trace_ring_t *ring = &TraceRing[XPAR_CPU_ID];
+
+	/* PMCR: enable all counters; PMCNTENSET: cycle counter */
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(0x1));
+	__asm__ volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(0x80000000));
+
+	ring->Head = 0;
+	ring->Tail = 0;
+#ifdef TRACE_ENABLE
+	TRACE(TRACE_START, XPAR_CPU_ID, TRACE_SIZE);
+#endif
+}
+
+
+/*****************************************************************************
+ * Function: trace_dump()
+ *
+ * Prints the records of this core written since the last dump, with the
+ * cycles since the previous record. A record overwritten while it was being
+ * printed is skipped and counted as lost, like the ones overwritten before
+ *
+ *****************************************************************************/
+void trace_dump(void)
+{
+	trace_ring_t *ring = &TraceRing[XPAR_CPU_ID];
+	static uint32_t Last;
+	uint32_t head = ring->Head;
+	uint32_t lost = 0;
+	trace_rec_t rec;
+
+	if (head - ring->Tail > TRACE_SIZE) {
+		lost = head - ring->Tail - TRACE_SIZE;
+		ring->Tail = head - TRACE_SIZE;
+	}
+
+	for (; ring->Tail != head; ring->Tail++) {
+		rec = ring->Rec[ring->Tail & (TRACE_SIZE - 1)];
+		if (ring->Head - ring->Tail > TRACE_SIZE) {
+			lost++;
+			continue;
+		}
+
+		xil_printf("%08x +%8d  ", rec.Time, rec.Time - Last);
+		Last = rec.Time;
+		if (rec.Id < TRACE_EVENTS)
+			xil_printf(TraceFormat[rec.Id], rec.Arg0, rec.Arg1);
+		else
+			xil_printf("event %d: %x %x", rec.Id, rec.Arg0, rec.Arg1);
+		xil_printf("\r\n");
+	}
+
+	if (lost)
+		xil_printf("%d trace records lost\r\n", lost);
+}
@@ -0,0 +1,112 @@
+/*
+ * trace.h
+ *
+ *  Binary trace points for interrupt handlers and other hot paths
+ */
+
+/********************************************************************************************
+ *
+ * TRACE(id, arg0, arg1) stores one 16-byte record in the ring of the core it runs on:
+ *
+ *   Time   PMU cycle counter (CPU clock, per core)
+ *   Id     event, from trace_events.h
+ *   Core   XPAR_CPU_ID
+ *   Arg0, Arg1
+ *
+ * It does not format, call or wait, so it is safe in any handler, FIQ included, and costs a
+ * few instructions: the slot is claimed with IRQ and FIQ masked for four instructions, so a
+ * handler tracing in between takes the next slot, then the record is written with
+ * interrupts back on. The ring is a flight recorder: when full the oldest records are
+ * overwritten and never block the writer.
+ *
+ * trace_dump() decodes the records written since the last dump with the format strings of
+ * trace_events.h; call it from the main loop, never from a handler. The ring can also be
+ * read from the debugger (TraceRing, TRACE_SIZE records from Head - TRACE_SIZE).
+ *
+ * Times from different cores come from different counters and are not comparable.
+ *
+ * Build with TRACE_ENABLE defined and trace.c in the application; without it TRACE()
+ * compiles to nothing and the trace code is not needed.
+ *
+ ********************************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Include Files */
+#include <stdint.h>
+#include "xparameters.h"
+#include "mmio.h"
+
+/* Definitions */
+#define TRACE_SIZE	256		/* records per core, power of two */
+#define TRACE_CORES	2
+
+#ifndef XPAR_CPU_ID
+#define XPAR_CPU_ID	0
+#endif
+
+enum {
+#define TRACE_EVENT(id, format)	id,
+#include "trace_events.h"
+#undef TRACE_EVENT
+	TRACE_EVENTS
+};
+
+typedef struct {
+	uint32_t Time;
+	uint16_t Id;
+	uint16_t Core;
+	uint32_t Arg0;
+	uint32_t Arg1;
+} trace_rec_t;
+
+typedef struct {
+	volatile uint32_t Head;		/* records ever written */
+	uint32_t Tail;			/* records ever dumped */
+	trace_rec_t Rec[TRACE_SIZE];
+} trace_ring_t;
+
+extern trace_ring_t TraceRing[TRACE_CORES];
+
+/* Function Prototypes */
+void trace_init(void);
+void trace_dump(void);
+
+#ifdef TRACE_ENABLE
+
+static inline __attribute__((always_inline)) uint32_t trace_cycles(void)
+{
+	uint32_t c;
+
+	__asm__ volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(c));
+	return c;
+}
+
+static inline __attribute__((always_inline))
+void TRACE(uint32_t id, uint32_t arg0, uint32_t arg1)
+{
+	trace_ring_t *ring = &TraceRing[XPAR_CPU_ID];
+	trace_rec_t *rec;
+	uint32_t cpsr, i;
+
+	cpsr = irq_fiq_save();
+	i = ring->Head;
+	ring->Head = i + 1;
+	irq_restore(cpsr);
+
+	rec = &ring->Rec[i & (TRACE_SIZE - 1)];
+	rec->Time = trace_cycles();
+	rec->Id = id;
+	rec->Core = XPAR_CPU_ID;
+	rec->Arg0 = arg0;
+	rec->Arg1 = arg1;
+}
+
+#else
+
+#define TRACE(id, arg0, arg1)	((void)0)
+
+#endif
+
+#endif
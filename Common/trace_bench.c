@@ -0,0 +1,86 @@
+/*
+ * trace_bench.c
+ *
+ *  Cycles per trace point: TRACE() against xil_printf
+ */
+
+/********************************************************************************************
+ * Times, with the Cortex-A9 cycle counter (PMCCNTR, CPU clock):
+ *
+ *   TRACE()	REPEAT trace points back to back, more than the ring holds, so the
+ *		wrap-around is in the figure
+ *   xil_printf	one line with the same information, REPEAT / 100 times
+ *
+ * and prints cycles per call, minus the empty loop. xil_printf waits for the UART FIFO, so
+ * once the FIFO is full it costs one character time (87 us at 115200 baud) per character.
+ * The last records are then dumped to check the decoder and the lost count (REPEAT -
+ * TRACE_SIZE). The cycle figures have not been taken on a board yet.
+ *
+ * Build with TRACE_ENABLE defined, trace.c in the application and -O2.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xil_printf.h"
+#include "trace.h"
+#include "pmccntr.h"
+
+/* Definitions */
+#define REPEAT			1000				/* trace points */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+/**************  Function Prototypes **************/
+
+static void Row(const char *Name, u32 Total, u32 Loop, u32 Count);
+
+
+/*************** Main function ********************/
+int main(void){
+	u32 t0, Loop, Trace, Print;
+	int i;
+
+	trace_init();
+	pmccntr_start();
+
+	/* empty loop, subtracted from every row */
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		__asm__ volatile("" ::: "memory");
+	Loop = pmccntr_read() - t0;
+
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT; i++)
+		TRACE(TRACE_MARK, i, t0);
+	Trace = pmccntr_read() - t0;
+
+	t0 = pmccntr_read();
+	for (i = 0; i < REPEAT / 100; i++)
+		printf("mark %d %d\r\n", i, t0);
+	Print = pmccntr_read() - t0;
+
+	printf("\r\ncycles per call\r\n");
+	Row("TRACE()", Trace, Loop, REPEAT);
+	Row("xil_printf", Print, Loop / 100, REPEAT / 100);
+
+	printf("\r\nlast %d records:\r\n", TRACE_SIZE);
+	trace_dump();
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* cycles per call, minus the share of the empty loop */
+static void Row(const char *Name, u32 Total, u32 Loop, u32 Count)
+{
+	printf("%-20s", Name);
+	pmccntr_print_per(Total - Loop, Count);
+	printf("\r\n");
+}
@@ -0,0 +1,22 @@
+/*
+ * trace_events.h
+ *
+ *  Trace event list: one TRACE_EVENT(id, format) per event
+ */
+
+/********************************************************************************************
+ *
+ * Included twice by the trace code: trace.h turns every line into an enum id, trace.c into
+ * the format string trace_dump() prints the record with. The format takes the record's two
+ * arguments in order (xil_printf conversions). Add new events at the end so the ids of a
+ * trace saved from an older build keep their meaning.
+ *
+ ********************************************************************************************/
+
+TRACE_EVENT(TRACE_START,	"trace start, core %d, ring %d")
+TRACE_EVENT(TRACE_MARK,		"mark %d %d")
+TRACE_EVENT(TRACE_BTN_IRQ,	"BTN_Intr_Handler isr %x buttons %x")
+TRACE_EVENT(TRACE_PTIMER_IRQ,	"PrivateTimerIntrHandler leds %x counter %d")
+TRACE_EVENT(TRACE_SW_IRQ,	"SW_Intr_Handler switches %x load %d")
+TRACE_EVENT(TRACE_PWM_UPDATE,	"PWM update pos %d high %d ns")
+TRACE_EVENT(TRACE_KYPD_EVENT,	"keypad key %x pressed %d")
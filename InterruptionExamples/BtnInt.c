@@ -40,6 +40,13 @@
 #include "xil_exception.h"
 #include "xil_printf.h"
 
+/* Build with TRACE_ENABLE and ../Common/trace.c to log the handler */
+#ifdef TRACE_ENABLE
+#include "trace.h"
+#else
+#define TRACE(id, arg0, arg1)
+#endif
+
 /**************************************************************
 *
 *    SECTION: DEFINITIONS
@@ -101,7 +108,15 @@ int main(void){
 		xil_printf("Successfully initialized Interrupt Controller\r\n");
 	}
 
+#ifdef TRACE_ENABLE
+	trace_init();
+#endif
+
 	while(1){    // Infinite loop
+#ifdef TRACE_ENABLE
+		// Decode what the handler logged, outside the interrupt
+		trace_dump();
+#endif
 	}
 
 	return 0;
@@ -135,6 +150,9 @@ void BTN_Intr_Handler(void *InstancePtr)
 
 	int btn_value;
 
+	// xil_printf here would hold the interrupt for a whole UART line
+	TRACE(TRACE_BTN_IRQ, XGpio_InterruptGetStatus(&Gpio), 0);
+
 	// Disable GPIO interrupts
 	XGpio_InterruptDisable(&Gpio, BTN_INT);
 
@@ -144,6 +162,7 @@ void BTN_Intr_Handler(void *InstancePtr)
 			return;
 		}
 	btn_value = XGpio_DiscreteRead(&Gpio, BTN_CHANNEL);
+	TRACE(TRACE_BTN_IRQ, BTN_INT, btn_value);
 
     XGpio_DiscreteWrite(&Gpio, LED_CHANNEL, btn_value);
 
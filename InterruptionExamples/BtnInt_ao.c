@@ -0,0 +1,225 @@
+/*
+ * BtnInt_ao.c
+ *
+ *  BtnInt.c on the active objects of Common/ao.h
+ */
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* Same behaviour as BtnInt.c: the buttons light the leds. The
+* interrupt handler only reads the buttons and posts the value
+* to the Leds active object; the leds are written, and the
+* event latency printed, by the object's handler outside the
+* interrupt. Every press and release is queued, so two changes
+* between dispatches are both seen, and a change that finds
+* the queue full is counted as lost in the report.
+*
+* Build with ../Common/ao.c.
+*
+**************************************************************/
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xil_printf.h"
+#include "ao.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define GPIO_DEVICE_ID  XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device that LEDs are connected to */
+#define LED_CHANNEL 2					/* GPIO port 2 for leds */
+#define BTN_CHANNEL 1					/* GPIO port 1 for buttons */
+#define printf xil_printf				/* smaller, optimised printf */
+
+#define INTC_DEVICE_ID 		XPAR_PS7_SCUGIC_0_DEVICE_ID // GIC device ID
+
+#define INTC_GPIO_INTERRUPT_ID XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR // GPIO Interrupt ID
+
+#define BTN_INT 			XGPIO_IR_CH1_MASK //Definition of the button interrupt mask
+
+#define SIG_BUTTON		AO_SIG_USER	// Arg: button value
+
+/**************************************************************
+*
+*    SECTION: DEVICE INSTANCES
+*
+***************************************************************/
+XGpio Gpio;		/* GPIO Device driver instance */
+
+XScuGic INTCInst; // Instance of the GIC
+
+static ao_t Leds;		// Active object for the leds
+static ao_event_t LedsQueue[8];
+
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+
+// Interrupt handler
+static void BTN_Intr_Handler(void *baseaddr_p);
+
+// Active object handler
+static void LedsHandler(ao_t *Me, const ao_event_t *Event);
+
+// Interrupt handler configuration
+static int IntcInitFunction(u16 DeviceId, XGpio *GpioInstancePtr);
+
+// Gpio configuration function
+static int GpioInitFunction(u16 DeviceId, XGpio *GpioInstancePtr);
+
+/* Main function. */
+int main(void){
+	int Status;
+
+	/* Initialise Gpio */
+	Status = GpioInitFunction(GPIO_DEVICE_ID,&Gpio);
+	if (Status != XST_SUCCESS) {
+		xil_printf("Failed to initialise Gpio\r\n");
+	} else{
+		xil_printf("Succesfully initialised Gpio\r\n");
+	}
+
+	/* The object must exist before the first interrupt posts to it */
+	AO_Start(&Leds, 1, LedsHandler, LedsQueue, 8);
+
+	/* Initialise Interrupt Controller */
+	Status = IntcInitFunction(INTC_DEVICE_ID,&Gpio);
+	if (Status != XST_SUCCESS) {
+		xil_printf("Failed to initialize Interrupt Controller\r\n");
+	} else{
+		xil_printf("Successfully initialized Interrupt Controller\r\n");
+	}
+
+	/* Dispatch events, sleep in WFI when there are none */
+	AO_Run();
+
+	return 0;
+}
+
+/**************************************************************
+*
+* SECTION: PROTOTYPE FUNCTION IMPLEMENTATIONS
+*
+**************************************************************/
+
+//----------------------------------------------------
+// INTERRUPT HANDLER FUNCTIONS
+// - called by button interrupt
+//----------------------------------------------------
+
+
+void BTN_Intr_Handler(void *InstancePtr)
+{
+	// Ignore interrupts from other channels
+	if ((XGpio_InterruptGetStatus(&Gpio) & BTN_INT) !=
+			BTN_INT) {
+			return;
+		}
+
+	// Hand the value over; the leds are written by LedsHandler
+	AO_Post(&Leds, SIG_BUTTON, XGpio_DiscreteRead(&Gpio, BTN_CHANNEL));
+
+	// Clear the interrupt flag
+	(void)XGpio_InterruptClear(&Gpio, BTN_INT);
+}
+
+
+//----------------------------------------------------
+// ACTIVE OBJECT HANDLER
+// - called by AO_Run for every event posted to Leds
+//----------------------------------------------------
+static void LedsHandler(ao_t *Me, const ao_event_t *Event)
+{
+	if (Event->Sig != SIG_BUTTON)
+		return;
+
+	XGpio_DiscreteWrite(&Gpio, LED_CHANNEL, Event->Arg);
+
+	// Latency of this event and the ones before, after a release
+	if (Event->Arg == 0)
+		AO_Report(Me, "Leds");
+}
+
+
+// Gpio configuration function
+static int GpioInitFunction(u16 DeviceId, XGpio *GpioInstancePtr){
+
+	int Status;
+
+	/* GPIO driver initialization */
+	Status = XGpio_Initialize(GpioInstancePtr, DeviceId);
+	if (Status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/*Set the direction for the LEDs to output. */
+	XGpio_SetDataDirection(GpioInstancePtr, LED_CHANNEL, 0x0);
+
+	/*Set the direction for the BTN to input. */
+	XGpio_SetDataDirection(GpioInstancePtr, BTN_CHANNEL, 0xf);
+
+	return Status;
+
+}
+
+
+int IntcInitFunction(u16 DeviceId, XGpio *GpioInstancePtr)
+{
+	// Pointer to Interruption Configuration
+	XScuGic_Config *IntcConfig;
+	int status;
+
+	// Interrupt controller initialisation and success check
+	IntcConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(&INTCInst, IntcConfig, IntcConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS) return XST_FAILURE;
+
+	// Connect GPIO interrupt to handler and check for success
+	status = XScuGic_Connect(&INTCInst,
+						  	  	 INTC_GPIO_INTERRUPT_ID,
+						  	  	 (Xil_ExceptionHandler)BTN_Intr_Handler,
+						  	  	 (void *)GpioInstancePtr);
+	if(status != XST_SUCCESS) return XST_FAILURE;
+
+	// Enable GIC
+	XScuGic_Enable(&INTCInst, INTC_GPIO_INTERRUPT_ID);
+
+	// Enable GPIO interrupts in the button channel.
+	XGpio_InterruptEnable(GpioInstancePtr, BTN_INT);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+
+	/*
+	 * Initialize the exception table and register the interrupt
+	 * controller handler with the exception table
+	 */
+	Xil_ExceptionInit();
+
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			 	 	 	 	 	 (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+								 &INTCInst);
+
+	/* Enable non-critical exceptions */
+	Xil_ExceptionEnable();
+
+
+	return XST_SUCCESS;
+}
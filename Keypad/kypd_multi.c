@@ -0,0 +1,208 @@
+/*
+ * kypd_multi.c
+ *
+ *  Software sweep of up to eight keypads on one AXI GPIO
+ */
+
+/**************************************************************
+*
+*    SECTION: VERSION HISTORY
+*
+***************************************************************
+*
+*	v1.0 - 18 October 2026
+*		First version created
+*
+***************************************************************/
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* main.c sweeps one keypad and decodes one 4-bit row value per
+* column. Here the columns of all the keypads are driven
+* together and each row read carries a nibble per keypad
+* (wiring in kypd_multi.h). Pack() turns the four row words of a
+* sweep into the 128-bit state with two rounds of masks and
+* shifts, nibbles then bytes, about 30 ALU instructions for any
+* number of keypads. The debounce is a 2-bit vertical counter
+* per key held in two more 128-bit states: a key changes after
+* KYPD_MULTI_DEBOUNCE sweeps in a row read it changed.
+*
+* The GPIO accesses, not the decoding, set the sweep time; NEON
+* would only shorten the part that is already small.
+*
+**************************************************************/
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xparameters.h"
+#include "mmio.h"
+#include "kypd_multi.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define COLUMN_LOW		0x11111111	/* column 0 of every keypad */
+
+/* key value at column*4 + row, as main.c shows it on the LEDs */
+static const u8 KeyCode[16] = {
+	0x1, 0x4, 0x7, 0xE,
+	0x2, 0x5, 0x8, 0x0,
+	0x3, 0x6, 0x9, 0xF,
+	0xA, 0xB, 0xC, 0xD
+};
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+static void Pack(const u32 Rows[4], KypdMulti_State *StatePtr);
+
+/**************************************************************
+*
+* SECTION: PROTOTYPE FUNCTION IMPLEMENTATIONS
+*
+**************************************************************/
+
+/* Rows as inputs, columns as outputs and released, no settle time */
+int KypdMulti_Initialize(KypdMulti *InstancePtr, UINTPTR BaseAddress, u32 Count)
+{
+	int i;
+
+	if (InstancePtr == NULL || Count == 0 || Count > KYPD_MULTI_MAX)
+		return XST_INVALID_PARAM;
+
+	InstancePtr->BaseAddress = BaseAddress;
+	InstancePtr->Count = Count;
+	InstancePtr->Mask = Count == KYPD_MULTI_MAX ? 0xFFFFFFFF : (1u << (4 * Count)) - 1;
+	InstancePtr->SettleTicks = 0;
+	for (i = 0; i < 4; i++) {
+		InstancePtr->Keys.Word[i] = 0;
+		InstancePtr->Cnt0.Word[i] = 0;
+		InstancePtr->Cnt1.Word[i] = 0;
+	}
+
+	gpio_set_direction(BaseAddress, KYPD_MULTI_ROWS_CH, 0xFFFFFFFF);
+	gpio_set_direction(BaseAddress, KYPD_MULTI_COLS_CH, 0x0);
+	gpio_write(BaseAddress, KYPD_MULTI_COLS_CH, 0xFFFFFFFF);
+
+	/* the settle wait reads the global timer */
+	mmio_update32(GTIMER_BASE + GTIMER_CONTROL, GTIMER_CONTROL_ENABLE, GTIMER_CONTROL_ENABLE);
+
+	return XST_SUCCESS;
+}
+
+
+/* Time the rows get to settle after a column is driven, rounded up */
+void KypdMulti_SetSettle(KypdMulti *InstancePtr, u32 SettleNs)
+{
+	InstancePtr->SettleTicks = (SettleNs * GTIMER_TICKS_PER_US + 999) / 1000;
+}
+
+
+/* One sweep of every keypad, not debounced: 1 = pressed */
+void KypdMulti_Sweep(KypdMulti *InstancePtr, KypdMulti_State *RawPtr)
+{
+	UINTPTR Base = InstancePtr->BaseAddress;
+	u32 Rows[4], t0;
+	int c;
+
+	for (c = 0; c < 4; c++) {
+		gpio_write(Base, KYPD_MULTI_COLS_CH, ~(COLUMN_LOW << c));
+		if (InstancePtr->SettleTicks) {
+			t0 = gtimer_now32();
+			while (gtimer_now32() - t0 < InstancePtr->SettleTicks)
+				;
+		}
+		Rows[c] = ~gpio_read(Base, KYPD_MULTI_ROWS_CH) & InstancePtr->Mask;
+	}
+	gpio_write(Base, KYPD_MULTI_COLS_CH, 0xFFFFFFFF);
+
+	Pack(Rows, RawPtr);
+}
+
+
+/*
+ * Sweeps and debounces. A key whose reading differs from Keys for
+ * KYPD_MULTI_DEBOUNCE sweeps in a row changes; ChangedPtr gets the
+ * keys that changed in this call, and the return value is 1 if any
+ * did. Call it at a fixed rate: the debounce time is
+ * KYPD_MULTI_DEBOUNCE periods
+ */
+int KypdMulti_Scan(KypdMulti *InstancePtr, KypdMulti_State *ChangedPtr)
+{
+	KypdMulti_State Raw;
+	u32 Delta, Toggle, Any = 0;
+	int i;
+
+	KypdMulti_Sweep(InstancePtr, &Raw);
+
+	for (i = 0; i < 4; i++) {
+		Delta = Raw.Word[i] ^ InstancePtr->Keys.Word[i];
+		InstancePtr->Cnt1.Word[i] = (InstancePtr->Cnt1.Word[i] ^ InstancePtr->Cnt0.Word[i]) & Delta;
+		InstancePtr->Cnt0.Word[i] = ~InstancePtr->Cnt0.Word[i] & Delta;
+		Toggle = Delta & ~(InstancePtr->Cnt0.Word[i] | InstancePtr->Cnt1.Word[i]);
+		InstancePtr->Keys.Word[i] ^= Toggle;
+		ChangedPtr->Word[i] = Toggle;
+		Any |= Toggle;
+	}
+
+	return Any != 0;
+}
+
+
+/* The 16 keys of one keypad, bit column*4 + row */
+u16 KypdMulti_GetKeys(const KypdMulti_State *StatePtr, u32 Keypad)
+{
+	return StatePtr->Word[Keypad >> 1] >> ((Keypad & 1) * 16);
+}
+
+
+/* Value of the lowest pressed key of a keypad, -1 if none */
+int KypdMulti_Decode(u16 Keys)
+{
+	if (Keys == 0)
+		return -1;
+
+	return KeyCode[__builtin_ctz(Keys)];
+}
+
+
+/*
+ * Rows[c] holds row r of keypad k in bit 4k + r; the state wants
+ * it in bit 4c + r of the 16 bits of keypad k. The first round
+ * pairs columns 0-1 and 2-3 into a byte per keypad (even keypads
+ * in one word, odd in another), the second pairs the bytes into
+ * a halfword per keypad, and the last puts the halfwords in
+ * keypad order
+ */
+static void Pack(const u32 Rows[4], KypdMulti_State *StatePtr)
+{
+	u32 Even01, Odd01, Even23, Odd23;
+	u32 EvenLo, EvenHi, OddLo, OddHi;
+
+	Even01 = (Rows[0] & 0x0F0F0F0F) | ((Rows[1] & 0x0F0F0F0F) << 4);
+	Odd01  = ((Rows[0] >> 4) & 0x0F0F0F0F) | (Rows[1] & 0xF0F0F0F0);
+	Even23 = (Rows[2] & 0x0F0F0F0F) | ((Rows[3] & 0x0F0F0F0F) << 4);
+	Odd23  = ((Rows[2] >> 4) & 0x0F0F0F0F) | (Rows[3] & 0xF0F0F0F0);
+
+	/* keypads 0 and 4, 2 and 6, 1 and 5, 3 and 7 */
+	EvenLo = (Even01 & 0x00FF00FF) | ((Even23 & 0x00FF00FF) << 8);
+	EvenHi = ((Even01 >> 8) & 0x00FF00FF) | (Even23 & 0xFF00FF00);
+	OddLo  = (Odd01 & 0x00FF00FF) | ((Odd23 & 0x00FF00FF) << 8);
+	OddHi  = ((Odd01 >> 8) & 0x00FF00FF) | (Odd23 & 0xFF00FF00);
+
+	StatePtr->Word[0] = (EvenLo & 0xFFFF) | (OddLo << 16);
+	StatePtr->Word[1] = (EvenHi & 0xFFFF) | (OddHi << 16);
+	StatePtr->Word[2] = (EvenLo >> 16) | (OddLo & 0xFFFF0000);
+	StatePtr->Word[3] = (EvenHi >> 16) | (OddHi & 0xFFFF0000);
+}
@@ -0,0 +1,80 @@
+/*
+ * kypd_multi.h
+ *
+ *  Software sweep of up to eight keypads on one AXI GPIO
+ */
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* Keypad k (0 to 7) has its rows on bits 4k..4k+3 of GPIO
+* channel 1 and its columns on the same bits of channel 2, so
+* keypad 0 is wired as in main.c. Column c of every keypad is
+* driven at the same time, and one 32-bit read returns the rows
+* of all of them: a sweep is always four writes and four reads,
+* whatever the number of keypads.
+*
+* The key state of all the keypads is 128 bits, keypad k in
+* bits 16*(k%2)..16*(k%2)+15 of Word[k/2], bit column*4 + row
+* (the KEYS layout of kypd_scan.sv). The four row words are
+* transposed into it, and debounced, with 32-bit word
+* operations that handle all the keypads at once.
+*
+**************************************************************/
+
+#ifndef KYPD_MULTI_H
+#define KYPD_MULTI_H
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xil_types.h"
+#include "xstatus.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define KYPD_MULTI_MAX		8	/* keypads on a 32-bit channel */
+#define KYPD_MULTI_ROWS_CH	1	/* GPIO channel of the rows */
+#define KYPD_MULTI_COLS_CH	2	/* GPIO channel of the columns */
+#define KYPD_MULTI_DEBOUNCE	4	/* sweeps a change must last */
+
+/**************************************************************
+*
+*    SECTION: TYPES
+*
+***************************************************************/
+typedef struct {
+	u32 Word[4];		/* keypads 2i and 2i+1 in Word[i] */
+} KypdMulti_State;
+
+typedef struct {
+	UINTPTR BaseAddress;	/* AXI GPIO of the keypads */
+	u32 Count;		/* keypads connected */
+	u32 Mask;		/* row bits of those keypads */
+	u32 SettleTicks;	/* global timer ticks before a row read */
+	KypdMulti_State Keys;	/* debounced state */
+	KypdMulti_State Cnt0;	/* debounce counters, bit 0 */
+	KypdMulti_State Cnt1;	/* debounce counters, bit 1 */
+} KypdMulti;
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+int KypdMulti_Initialize(KypdMulti *InstancePtr, UINTPTR BaseAddress, u32 Count);
+void KypdMulti_SetSettle(KypdMulti *InstancePtr, u32 SettleNs);
+void KypdMulti_Sweep(KypdMulti *InstancePtr, KypdMulti_State *RawPtr);
+int KypdMulti_Scan(KypdMulti *InstancePtr, KypdMulti_State *ChangedPtr);
+u16 KypdMulti_GetKeys(const KypdMulti_State *StatePtr, u32 Keypad);
+int KypdMulti_Decode(u16 Keys);
+
+#endif
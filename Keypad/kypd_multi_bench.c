@@ -0,0 +1,156 @@
+/*
+ * kypd_multi_bench.c
+ *
+ *  Sweep time of 1 to 8 keypads: one keypad at a time against kypd_multi.c
+ */
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* For every number of keypads, 1 to 8, two sweeps of the same
+* GPIO (wiring in kypd_multi.h) are timed with the cycle
+* counter (PMCCNTR, CPU clock), best and worst of RUNS:
+*
+*   nibble	the keypads swept one after the other, as main.c
+*		sweeps its single keypad: four writes and four
+*		reads per keypad, one 4-bit row value decoded at a
+*		time
+*   swar	KypdMulti_Sweep(): four writes and four reads for
+*		all of them, transposed with word operations
+*
+* both without settle time (bus and CPU cost only) and with
+* SETTLE_NS per column, the realistic case. The two sweeps must
+* read the same keys; keep the keypads still while it runs.
+* No board timings have been recorded yet.
+*
+* HW platform: AXI GPIO 0 with two 32-bit channels, rows on
+* channel 1 and columns on channel 2. Build with -O2,
+* kypd_multi.c and ../Common on the include path.
+*
+**************************************************************/
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xparameters.h"
+#include "xil_printf.h"
+#include "mmio.h"
+#include "pmccntr.h"
+#include "kypd_multi.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define KEYPAD_GPIO_BASE	XPAR_AXI_GPIO_0_BASEADDR	/* GPIO of the keypads */
+#define RUNS			1000
+#define SETTLE_NS		1000
+#define printf xil_printf				/* smaller, optimised printf */
+
+/**************************************************************
+*
+*    SECTION: DEVICE INSTANCES
+*
+***************************************************************/
+static KypdMulti Kypd;
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+static void NibbleSweep(KypdMulti *InstancePtr, KypdMulti_State *RawPtr);
+static void Measure(u32 Count, u32 SettleNs);
+
+
+/* Main function. */
+int main(void){
+	u32 n;
+
+	pmccntr_start();
+
+	printf("\r\nkeypads  nibble min/max  swar min/max (cycles)\r\n");
+	for (n = 1; n <= KYPD_MULTI_MAX; n++)
+		Measure(n, 0);
+
+	printf("\r\nwith %d ns settle per column\r\n", SETTLE_NS);
+	for (n = 1; n <= KYPD_MULTI_MAX; n++)
+		Measure(n, SETTLE_NS);
+
+	return 0;
+}
+
+/**************************************************************
+*
+* SECTION: PROTOTYPE FUNCTION IMPLEMENTATIONS
+*
+**************************************************************/
+
+/* Best and worst of RUNS sweeps of Count keypads, both ways */
+static void Measure(u32 Count, u32 SettleNs)
+{
+	KypdMulti_State Nibble, Swar;
+	u32 c0, t, NibMin = ~0u, NibMax = 0, SwarMin = ~0u, SwarMax = 0;
+	int i, Same = 1;
+
+	KypdMulti_Initialize(&Kypd, KEYPAD_GPIO_BASE, Count);
+	KypdMulti_SetSettle(&Kypd, SettleNs);
+
+	for (i = 0; i < RUNS; i++) {
+		c0 = pmccntr_read();
+		NibbleSweep(&Kypd, &Nibble);
+		t = pmccntr_read() - c0;
+		if (t < NibMin) NibMin = t;
+		if (t > NibMax) NibMax = t;
+
+		c0 = pmccntr_read();
+		KypdMulti_Sweep(&Kypd, &Swar);
+		t = pmccntr_read() - c0;
+		if (t < SwarMin) SwarMin = t;
+		if (t > SwarMax) SwarMax = t;
+
+		Same &= Nibble.Word[0] == Swar.Word[0] && Nibble.Word[1] == Swar.Word[1] &&
+			Nibble.Word[2] == Swar.Word[2] && Nibble.Word[3] == Swar.Word[3];
+	}
+
+	printf("   %d     %6d %6d   %6d %6d%s\r\n", Count, NibMin, NibMax,
+	       SwarMin, SwarMax, Same ? "" : "  keys differ");
+}
+
+
+/*
+ * The sweep of main.c repeated for every keypad: only that
+ * keypad's column is driven, and its 4-bit row value is
+ * extracted and placed in the state
+ */
+static void NibbleSweep(KypdMulti *InstancePtr, KypdMulti_State *RawPtr)
+{
+	UINTPTR Base = InstancePtr->BaseAddress;
+	u32 k, c, Rows, Keys, t0;
+
+	for (k = 0; k < KYPD_MULTI_MAX / 2; k++)
+		RawPtr->Word[k] = 0;
+
+	for (k = 0; k < InstancePtr->Count; k++) {
+		Keys = 0;
+		for (c = 0; c < 4; c++) {
+			gpio_write(Base, KYPD_MULTI_COLS_CH, ~(1u << (4 * k + c)));
+			if (InstancePtr->SettleTicks) {
+				t0 = gtimer_now32();
+				while (gtimer_now32() - t0 < InstancePtr->SettleTicks)
+					;
+			}
+			Rows = (~gpio_read(Base, KYPD_MULTI_ROWS_CH) >> (4 * k)) & 0xf;
+			Keys |= Rows << (4 * c);
+		}
+		RawPtr->Word[k >> 1] |= Keys << ((k & 1) * 16);
+	}
+	gpio_write(Base, KYPD_MULTI_COLS_CH, 0xFFFFFFFF);
+}
+
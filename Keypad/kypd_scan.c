@@ -0,0 +1,165 @@
+/*
+ * kypd_scan.c
+ *
+ *  Keypad scanner IP driver
+ */
+
+/**************************************************************
+*
+*    SECTION: VERSION HISTORY
+*
+***************************************************************
+*
+*	v1.0 - 18 October 2026
+*		First version created
+*
+***************************************************************/
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* Driver for the keypad scanner IP (kypd_scan.sv, registers
+* described there). It replaces the software sweep of main.c:
+* the scan rate, settle time and debounce are set once, then
+* every key change arrives as one event in the IP FIFO and the
+* CPU touches the bus only to read it.
+*
+**************************************************************/
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "kypd_scan.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define KYPD_SCAN_COLUMNS	4	/* columns per sweep */
+#define KYPD_SCAN_DEBOUNCE_MAX	255	/* DEBOUNCE is 8 bits */
+
+/**************************************************************
+*
+* SECTION: PROTOTYPE FUNCTION IMPLEMENTATIONS
+*
+**************************************************************/
+
+/* Stops the IP, empties its FIFO and clears its interrupts */
+int KypdScan_Initialize(KypdScan *InstancePtr, UINTPTR BaseAddress, u32 ClockHz)
+{
+	if (InstancePtr == NULL || ClockHz == 0)
+		return XST_INVALID_PARAM;
+
+	InstancePtr->BaseAddress = BaseAddress;
+	InstancePtr->ClockHz = ClockHz;
+	InstancePtr->Ctrl = 0;
+
+	KypdScan_WriteReg(BaseAddress, KYPD_SCAN_CTRL_OFFSET, KYPD_SCAN_CTRL_FLUSH);
+	KypdScan_WriteReg(BaseAddress, KYPD_SCAN_ISR_OFFSET, KYPD_SCAN_IR_ALL);
+
+	return XST_SUCCESS;
+}
+
+
+/*
+ * Sets the scan clock (columns per second), the time the rows get to
+ * settle after a column is driven, and how long a key must be stable
+ * before it is reported (rounded up to whole sweeps)
+ */
+int KypdScan_SetTiming(KypdScan *InstancePtr, u32 ScanHz, u32 SettleNs, u32 DebounceMs)
+{
+	u32 Div, Settle, Debounce;
+
+	if (ScanHz == 0 || ScanHz > InstancePtr->ClockHz / 2)
+		return XST_INVALID_PARAM;
+
+	Div = InstancePtr->ClockHz / ScanHz;
+	Settle = (u32)(((u64)SettleNs * InstancePtr->ClockHz + 999999999) / 1000000000);
+	if (Settle >= Div)
+		return XST_INVALID_PARAM;
+
+	/* one sweep takes KYPD_SCAN_COLUMNS scan clocks */
+	Debounce = (u32)(((u64)DebounceMs * ScanHz + 1000 * KYPD_SCAN_COLUMNS - 1)
+			/ (1000 * KYPD_SCAN_COLUMNS));
+	if (Debounce > KYPD_SCAN_DEBOUNCE_MAX)
+		return XST_INVALID_PARAM;
+
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_DIV_OFFSET, Div);
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_SETTLE_OFFSET, Settle);
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_DEBOUNCE_OFFSET, Debounce);
+
+	return XST_SUCCESS;
+}
+
+
+void KypdScan_Start(KypdScan *InstancePtr)
+{
+	InstancePtr->Ctrl |= KYPD_SCAN_CTRL_ENABLE;
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+void KypdScan_Stop(KypdScan *InstancePtr)
+{
+	InstancePtr->Ctrl &= ~KYPD_SCAN_CTRL_ENABLE;
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+void KypdScan_InterruptEnable(KypdScan *InstancePtr)
+{
+	InstancePtr->Ctrl |= KYPD_SCAN_CTRL_IRQ;
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+void KypdScan_InterruptDisable(KypdScan *InstancePtr)
+{
+	InstancePtr->Ctrl &= ~KYPD_SCAN_CTRL_IRQ;
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+u32 KypdScan_InterruptGetStatus(KypdScan *InstancePtr)
+{
+	return KypdScan_ReadReg(InstancePtr->BaseAddress, KYPD_SCAN_ISR_OFFSET);
+}
+
+
+/*
+ * Clear before draining the FIFO: an event queued after the clear
+ * raises the interrupt again instead of being left behind
+ */
+void KypdScan_InterruptClear(KypdScan *InstancePtr, u32 Mask)
+{
+	KypdScan_WriteReg(InstancePtr->BaseAddress, KYPD_SCAN_ISR_OFFSET, Mask);
+}
+
+
+/* Pops the oldest event: one bus read, XST_NO_DATA when there is none */
+int KypdScan_GetEvent(KypdScan *InstancePtr, KypdScan_Event *EventPtr)
+{
+	u32 Event;
+
+	Event = KypdScan_ReadReg(InstancePtr->BaseAddress, KYPD_SCAN_EVENT_OFFSET);
+	if ((Event & KYPD_SCAN_EVENT_VALID) == 0)
+		return XST_NO_DATA;
+
+	EventPtr->Key = Event & 0xf;
+	EventPtr->Position = (Event >> 4) & 0xf;
+	EventPtr->Pressed = (Event & KYPD_SCAN_EVENT_PRESSED) != 0;
+
+	return XST_SUCCESS;
+}
+
+
+u16 KypdScan_GetKeys(KypdScan *InstancePtr)
+{
+	return KypdScan_ReadReg(InstancePtr->BaseAddress, KYPD_SCAN_KEYS_OFFSET) & 0xffff;
+}
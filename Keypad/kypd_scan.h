@@ -0,0 +1,102 @@
+/*
+ * kypd_scan.h
+ *
+ *  Keypad scanner IP driver
+ */
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* Driver for the keypad scanner IP (kypd_scan.sv). The IP sweeps
+* the PmodKYPD columns, debounces the keys and queues an event
+* for every press and release; the CPU only reads the events.
+*
+**************************************************************/
+
+#ifndef KYPD_SCAN_H
+#define KYPD_SCAN_H
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+/* Register offsets */
+#define KYPD_SCAN_CTRL_OFFSET		0x00	/* enable, IRQ enable, flush */
+#define KYPD_SCAN_DIV_OFFSET		0x04	/* clock cycles per column */
+#define KYPD_SCAN_SETTLE_OFFSET		0x08	/* cycles to the row sample */
+#define KYPD_SCAN_DEBOUNCE_OFFSET	0x0C	/* sweeps a new state must last */
+#define KYPD_SCAN_STATUS_OFFSET		0x10	/* FIFO state */
+#define KYPD_SCAN_EVENT_OFFSET		0x14	/* oldest event, popped when read */
+#define KYPD_SCAN_KEYS_OFFSET		0x18	/* debounced key state */
+#define KYPD_SCAN_ISR_OFFSET		0x1C	/* interrupt status, write 1 to clear */
+
+/* CTRL bits */
+#define KYPD_SCAN_CTRL_ENABLE		0x1
+#define KYPD_SCAN_CTRL_IRQ		0x2
+#define KYPD_SCAN_CTRL_FLUSH		0x4
+
+/* STATUS bits */
+#define KYPD_SCAN_STATUS_NOT_EMPTY	0x1
+#define KYPD_SCAN_STATUS_FULL		0x2
+
+/* EVENT fields */
+#define KYPD_SCAN_EVENT_VALID		0x80000000
+#define KYPD_SCAN_EVENT_PRESSED		0x100
+
+/* ISR bits */
+#define KYPD_SCAN_IR_EVENT		0x1	/* an event was queued */
+#define KYPD_SCAN_IR_LOST		0x2	/* an event found the FIFO full */
+#define KYPD_SCAN_IR_ALL		0x3
+
+#define KypdScan_ReadReg(BaseAddress, Offset) \
+	Xil_In32((BaseAddress) + (Offset))
+#define KypdScan_WriteReg(BaseAddress, Offset, Data) \
+	Xil_Out32((BaseAddress) + (Offset), (Data))
+
+/**************************************************************
+*
+*    SECTION: TYPES
+*
+***************************************************************/
+typedef struct {
+	UINTPTR BaseAddress;	/* AXI base address of the IP */
+	u32 ClockHz;		/* AXI clock of the IP */
+	u32 Ctrl;		/* last value written to CTRL */
+} KypdScan;
+
+typedef struct {
+	u8 Key;			/* key value, as main.c shows it on the LEDs */
+	u8 Position;		/* column * 4 + row */
+	u8 Pressed;		/* 1 pressed, 0 released */
+} KypdScan_Event;
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+int KypdScan_Initialize(KypdScan *InstancePtr, UINTPTR BaseAddress, u32 ClockHz);
+int KypdScan_SetTiming(KypdScan *InstancePtr, u32 ScanHz, u32 SettleNs, u32 DebounceMs);
+void KypdScan_Start(KypdScan *InstancePtr);
+void KypdScan_Stop(KypdScan *InstancePtr);
+void KypdScan_InterruptEnable(KypdScan *InstancePtr);
+void KypdScan_InterruptDisable(KypdScan *InstancePtr);
+u32 KypdScan_InterruptGetStatus(KypdScan *InstancePtr);
+void KypdScan_InterruptClear(KypdScan *InstancePtr, u32 Mask);
+int KypdScan_GetEvent(KypdScan *InstancePtr, KypdScan_Event *EventPtr);
+u16 KypdScan_GetKeys(KypdScan *InstancePtr);
+
+#endif
@@ -0,0 +1,483 @@
+// kypd_scan.sv
+// Keypad scanner peripheral for the PmodKYPD on the Zybo (AXI4-Lite)
+//
+// Replaces the column sweep of main.c: the IP drives the columns,
+// waits for the rows to settle, reads them, debounces whole sweeps
+// and queues a key event for every change. The CPU only reads the
+// FIFO, ideally from the interrupt (see kypd_scan.c).
+//
+// Simulate with Verilator 5
+//   verilator --binary --timing -Wno-fatal --top-module testbench kypd_scan.sv
+//   obj_dir/Vtestbench
+// or any SystemVerilog simulator, top module testbench.
+// Expect the simulator to print "Simulation succeeded"
+//
+// Status: the testbench has not been run (no simulator was at hand),
+// so the 100 kHz scan rate, the debounce and the key codes are still
+// unverified and the key-to-interrupt times it prints are not known.
+//
+// Scanning
+//   The columns are driven one at a time, low active (1110, 1101,
+//   1011, 0111 as in main.c), each for DIV clock cycles: the scan
+//   clock is f_clk / DIV per column, a full sweep takes 4 * DIV
+//   cycles. SETTLE cycles after a column is driven the rows
+//   (synchronised, low = pressed) are sampled, so SETTLE must cover
+//   the RC delay of the keypad lines and be less than DIV. The 16
+//   samples of a sweep form a key vector, bit column*4 + row. A vector
+//   is taken as the new key state once DEBOUNCE sweeps in a row have
+//   read it (0 and 1: every sweep); a key must be stable for
+//   DEBOUNCE * 4 * DIV cycles to be reported.
+//   Every key whose state differs from the reported one then produces
+//   an event, one per cycle and lowest position first, and the
+//   interrupt is raised only on such changes.
+//
+// Registers (32 bit, word access, WSTRB is ignored)
+//   Offset  Name
+//    0x00   CTRL      [0] enable scanning, [1] IRQ enable,
+//                     [2] flush the FIFO (write only)
+//    0x04   DIV       clock cycles per column
+//    0x08   SETTLE    cycles from the column change to the row sample
+//    0x0C   DEBOUNCE  [7:0] sweeps a new state must last
+//    0x10   STATUS    [0] FIFO not empty, [1] FIFO full,
+//                     [15:8] events in the FIFO
+//    0x14   EVENT     oldest event, removed when read:
+//                     [3:0] key as decoded by main.c,
+//                     [7:4] position column*4 + row,
+//                     [8] 1 pressed, 0 released, [31] valid
+//                     (0 when the FIFO was empty)
+//    0x18   KEYS      [15:0] reported key state, bit column*4 + row
+//    0x1C   ISR       [0] event queued, [1] event lost (FIFO full);
+//                     write 1 to clear. irq = IRQ enable & |ISR
+//   After reset DIV, SETTLE and DEBOUNCE hold DIV_RESET, SETTLE_RESET
+//   and DEBOUNCE_RESET, and scanning is off (columns all high).
+//
+// Testbench
+//   A keypad model pulls a row low through every pressed key of the
+//   driven column, ROW_DELAY ns after the columns change, and each
+//   press and release bounces. For scan clocks from 100 kHz down to
+//   1 kHz (f_clk = 100 MHz) it checks that single and simultaneous
+//   keys give exactly one press and one release event each with the
+//   right codes, that bounces give none, and that the interrupt is
+//   raised for them; it prints the press-to-interrupt latency.
+
+`timescale 1ns/1ps
+
+module testbench();
+
+  parameter ROW_DELAY = 1000;   // keypad line settling, ns
+  parameter BOUNCE    = 2000;   // contact bounce half period, ns
+
+  logic        clk, resetn;
+  logic [4:0]  awaddr, araddr;
+  logic [31:0] wdata, rdata;
+  logic [3:0]  wstrb;
+  logic        awvalid, awready, wvalid, wready, bvalid, bready;
+  logic        arvalid, arready, rvalid, rready;
+  logic [1:0]  bresp, rresp;
+  logic        irq;
+  logic [3:0]  Cols, Rows, RowsNow;
+  logic [15:0] Pressed;
+  int          Errors, Irqs;
+  logic        IrqLast;
+
+  // instantiate device to be tested
+  kypd_scan_axi dut(clk, resetn, awaddr, awvalid, awready, wdata, wstrb,
+                    wvalid, wready, bresp, bvalid, bready, araddr,
+                    arvalid, arready, rdata, rresp, rvalid, rready,
+                    irq, Rows, Cols);
+
+  // keypad: a row is pulled low through every pressed key of the
+  // driven column, and follows the columns ROW_DELAY ns later
+  always_comb
+    for (int r = 0; r < 4; r++) begin
+      RowsNow[r] = 1'b1;
+      for (int c = 0; c < 4; c++)
+        if (~Cols[c] & Pressed[4*c + r]) RowsNow[r] = 1'b0;
+    end
+
+  assign #(ROW_DELAY) Rows = RowsNow;
+
+  // 100 MHz clock
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  always @(posedge clk)
+    begin
+      if (irq & ~IrqLast) Irqs <= Irqs + 1;
+      IrqLast <= irq;
+    end
+
+  // AXI4-Lite master, one transfer at a time
+  task automatic axi_write(input logic [4:0] a, input logic [31:0] d);
+    @(negedge clk);
+    awaddr = a; wdata = d; wstrb = 4'hF;
+    awvalid = 1; wvalid = 1;
+    while (!awready) @(negedge clk);
+    @(negedge clk);
+    awvalid = 0; wvalid = 0;
+  endtask
+
+  task automatic axi_read(input logic [4:0] a, output logic [31:0] d);
+    @(negedge clk);
+    araddr = a; arvalid = 1;
+    while (!arready) @(negedge clk);
+    @(negedge clk);
+    arvalid = 0;
+    d = rdata;
+  endtask
+
+  // contacts bounce before they close or open
+  task automatic key_down(input int k);
+    repeat (4) begin
+      Pressed[k] = 1; # BOUNCE;
+      Pressed[k] = 0; # BOUNCE;
+    end
+    Pressed[k] = 1;
+  endtask
+
+  task automatic key_up(input int k);
+    repeat (4) begin
+      Pressed[k] = 0; # BOUNCE;
+      Pressed[k] = 1; # BOUNCE;
+    end
+    Pressed[k] = 0;
+  endtask
+
+  // waits for an event (at most Timeout ns), clears the interrupt
+  // as a handler would and checks the oldest event; keys that settle
+  // in the same sweep queue their events behind one interrupt, which
+  // the first read has already cleared, so only First checks irq
+  task automatic expect_event(input logic First, input logic Down,
+                              input int Pos, input int Key,
+                              input longint Timeout);
+    logic [31:0] d;
+    longint      t0;
+    t0 = $time;
+    while (dut.Empty & ($time - t0 < Timeout)) @(negedge clk);
+    if (dut.Empty) begin
+      $display("no event for key %0d", Pos);
+      Errors++;
+    end else if (First & ~irq) begin
+      $display("no interrupt for key %0d", Pos);
+      Errors++;
+    end
+    axi_write(5'h1C, 32'h3);
+    axi_read(5'h14, d);
+    if (d[31] !== 1'b1 | d[8] !== Down | d[7:4] !== Pos | d[3:0] !== Key) begin
+      $display("event %h, expected %s of key %0d (%h)", d,
+               Down ? "press" : "release", Pos, Key);
+      Errors++;
+    end
+  endtask
+
+  initial
+    begin
+      int          Rates[3] = '{100000, 20000, 1000};
+      int          Div;
+      longint      Sweep, Start;
+      logic [31:0] d;
+
+      resetn = 0; Pressed = 0; Errors = 0; Irqs = 0;
+      {awvalid, wvalid, arvalid} = 0;
+      bready = 1; rready = 1;
+      # 22; resetn = 1;
+
+      foreach (Rates[i]) begin
+        Div   = 100000000 / Rates[i];
+        Sweep = 4 * 10 * Div;
+        axi_write(5'h00, 32'h0);
+        axi_write(5'h04, Div);
+        axi_write(5'h08, Div / 2);
+        axi_write(5'h0C, 2);
+        axi_write(5'h00, 32'h7);
+        axi_write(5'h1C, 32'h3);
+        Irqs = 0;
+
+        // one key, press then release
+        Start = $time;
+        key_down(5);
+        expect_event(1, 1, 5, 5, 5 * Sweep);
+        $display("%0d Hz: key to interrupt %0d us", Rates[i],
+                 ($time - Start - 8 * BOUNCE) / 1000);
+        axi_read(5'h18, d);
+        if (d[15:0] !== 16'h0020) begin
+          $display("KEYS %h", d);
+          Errors++;
+        end
+        key_up(5);
+        expect_event(1, 0, 5, 5, 5 * Sweep);
+
+        // two keys held together, released together
+        key_down(0);
+        key_down(15);
+        expect_event(1, 1, 0, 1, 5 * Sweep);
+        expect_event(0, 1, 15, 13, 5 * Sweep);
+        key_up(0);
+        key_up(15);
+        expect_event(1, 0, 0, 1, 5 * Sweep);
+        expect_event(0, 0, 15, 13, 5 * Sweep);
+
+        // nothing left over from the bounces
+        # (3 * Sweep);
+        axi_read(5'h10, d);
+        if (d[0] | irq) begin
+          $display("%0d Hz: spurious events, STATUS %h", Rates[i], d);
+          Errors++;
+        end
+        if (Irqs == 0) begin
+          $display("%0d Hz: no interrupt edges", Rates[i]);
+          Errors++;
+        end
+      end
+
+      if (Errors == 0) $display("Simulation succeeded");
+      else             $display("Simulation failed");
+      $finish;
+    end
+endmodule
+
+module kypd_scan_axi #(parameter DEPTH          = 16,
+                       parameter DIV_RESET      = 100000,
+                       parameter SETTLE_RESET   = 50000,
+                       parameter DEBOUNCE_RESET = 3)
+                     (input  logic        s_axi_aclk, s_axi_aresetn,
+                      input  logic [4:0]  s_axi_awaddr,
+                      input  logic        s_axi_awvalid,
+                      output logic        s_axi_awready,
+                      input  logic [31:0] s_axi_wdata,
+                      input  logic [3:0]  s_axi_wstrb,
+                      input  logic        s_axi_wvalid,
+                      output logic        s_axi_wready,
+                      output logic [1:0]  s_axi_bresp,
+                      output logic        s_axi_bvalid,
+                      input  logic        s_axi_bready,
+                      input  logic [4:0]  s_axi_araddr,
+                      input  logic        s_axi_arvalid,
+                      output logic        s_axi_arready,
+                      output logic [31:0] s_axi_rdata,
+                      output logic [1:0]  s_axi_rresp,
+                      output logic        s_axi_rvalid,
+                      input  logic        s_axi_rready,
+                      output logic        irq,
+                      input  logic [3:0]  rows,
+                      output logic [3:0]  cols);
+
+  localparam LBITS = $clog2(DEPTH) + 1;
+
+  logic             clk, reset, we, re;
+  logic [31:0]      Div, Settle, rd;
+  logic [7:0]       Debounce;
+  logic [1:0]       Ctrl, Isr;
+  logic             Flush, Push, Pop, Empty, Full;
+  logic [8:0]       Event, Head;
+  logic [15:0]      Keys;
+  logic [LBITS-1:0] Level;
+
+  assign clk   = s_axi_aclk;
+  assign reset = ~s_axi_aresetn;
+
+  // write channel: address and data are taken together, then the
+  // response is held until accepted
+  assign we            = s_axi_awvalid & s_axi_wvalid & ~s_axi_bvalid;
+  assign s_axi_awready = we;
+  assign s_axi_wready  = we;
+  assign s_axi_bresp   = 2'b00;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)             s_axi_bvalid <= 0;
+    else if (we)           s_axi_bvalid <= 1;
+    else if (s_axi_bready) s_axi_bvalid <= 0;
+
+  // read channel: the data is registered, reading EVENT pops the FIFO
+  assign re            = s_axi_arvalid & ~s_axi_rvalid;
+  assign s_axi_arready = re;
+  assign s_axi_rresp   = 2'b00;
+  assign Pop           = re & (s_axi_araddr[4:2] == 3'd5);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      s_axi_rvalid <= 0;
+      s_axi_rdata  <= 0;
+    end else if (re) begin
+      s_axi_rvalid <= 1;
+      s_axi_rdata  <= rd;
+    end else if (s_axi_rready) s_axi_rvalid <= 0;
+
+  // registers
+  assign Flush = we & (s_axi_awaddr[4:2] == 3'd0) & s_axi_wdata[2];
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Ctrl     <= 0;
+      Div      <= DIV_RESET;
+      Settle   <= SETTLE_RESET;
+      Debounce <= DEBOUNCE_RESET;
+      Isr      <= 0;
+    end else begin
+      if (we)
+        case(s_axi_awaddr[4:2])
+          3'd0:    Ctrl     <= s_axi_wdata[1:0];
+          3'd1:    Div      <= s_axi_wdata;
+          3'd2:    Settle   <= s_axi_wdata;
+          3'd3:    Debounce <= s_axi_wdata[7:0];
+          3'd7:    Isr      <= Isr & ~s_axi_wdata[1:0];
+          default: ;
+        endcase
+      // a new event wins over a clear in the same cycle
+      if (Push)        Isr[0] <= 1;
+      if (Push & Full) Isr[1] <= 1;
+    end
+
+  always_comb
+    case(s_axi_araddr[4:2])
+      3'd0:    rd = {30'b0, Ctrl};
+      3'd1:    rd = Div;
+      3'd2:    rd = Settle;
+      3'd3:    rd = {24'b0, Debounce};
+      3'd4:    rd = {16'b0, 8'(Level), 6'b0, Full, ~Empty};
+      3'd5:    rd = {~Empty, 22'b0, Head};
+      3'd6:    rd = {16'b0, Keys};
+      default: rd = {30'b0, Isr};
+    endcase
+
+  assign irq = Ctrl[1] & |Isr;
+
+  kypd_scan scan(clk, reset, Ctrl[0], Div, Settle, Debounce, rows, cols,
+                 Push, Event, Keys);
+  kypd_fifo #(9, DEPTH) fifo(clk, reset, Flush, Push, Pop, Event, Head,
+                             Empty, Full, Level);
+endmodule
+
+module kypd_scan(input  logic        clk, reset, Enable,
+                 input  logic [31:0] Div, Settle,
+                 input  logic [7:0]  Debounce,
+                 input  logic [3:0]  Rows,
+                 output logic [3:0]  Cols,
+                 output logic        Push,
+                 output logic [8:0]  Event,
+                 output logic [15:0] Keys);
+
+  logic [31:0] Cnt;
+  logic [1:0]  Col;
+  logic [3:0]  RowsMeta, RowsSync, Bit;
+  logic [15:0] Sweep, NewSweep, Last, Target, Diff;
+  logic [7:0]  Stable;
+  logic [8:0]  Count;
+
+  // key code at column*4 + row, the values main.c shows on the LEDs
+  function automatic logic [3:0] keycode(input logic [3:0] pos);
+    case(pos)
+      4'd0:  return 4'h1;   4'd1:  return 4'h4;
+      4'd2:  return 4'h7;   4'd3:  return 4'hE;
+      4'd4:  return 4'h2;   4'd5:  return 4'h5;
+      4'd6:  return 4'h8;   4'd7:  return 4'h0;
+      4'd8:  return 4'h3;   4'd9:  return 4'h6;
+      4'd10: return 4'h9;   4'd11: return 4'hF;
+      4'd12: return 4'hA;   4'd13: return 4'hB;
+      4'd14: return 4'hC;   default: return 4'hD;
+    endcase
+  endfunction
+
+  // the rows come from the keypad pins, asynchronous to clk
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      RowsMeta <= 4'hF;
+      RowsSync <= 4'hF;
+    end else begin
+      RowsMeta <= Rows;
+      RowsSync <= RowsMeta;
+    end
+
+  assign Cols = Enable ? ~(4'b0001 << Col) : 4'b1111;
+
+  // the sweep finishes with the sample of column 3; Count is the number
+  // of sweeps in a row that read the same vector
+  assign NewSweep = {~RowsSync, Sweep[11:0]};
+  assign Count    = (NewSweep == Last) ? Stable + 9'd1 : 9'd1;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Cnt    <= 0;
+      Col    <= 0;
+      Sweep  <= 0;
+      Last   <= 0;
+      Stable <= 0;
+      Target <= 0;
+    end else if (~Enable) begin
+      Cnt    <= 0;
+      Col    <= 0;
+      Stable <= 0;
+    end else begin
+      if (Cnt + 1 >= Div) begin
+        Cnt <= 0;
+        Col <= Col + 1;
+      end else Cnt <= Cnt + 1;
+      if (Cnt == Settle) begin
+        Sweep[{Col, 2'b00} +: 4] <= ~RowsSync;
+        if (Col == 2'd3) begin
+          Last   <= NewSweep;
+          Stable <= Count[8] ? 8'hFF : Count[7:0];
+          if (Count >= {1'b0, Debounce}) Target <= NewSweep;
+        end
+      end
+    end
+
+  // one event per cycle while the reported state lags the debounced one
+  assign Diff = Target ^ Keys;
+
+  always_comb
+    begin
+      Bit = 0;
+      for (int i = 15; i >= 0; i--)
+        if (Diff[i]) Bit = 4'(i);
+    end
+
+  assign Push  = |Diff;
+  assign Event = {Target[Bit], Bit, keycode(Bit)};
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)     Keys <= 0;
+    else if (Push) Keys[Bit] <= Target[Bit];
+endmodule
+
+module kypd_fifo #(parameter WIDTH = 9, DEPTH = 16)
+                 (input  logic                       clk, reset, flush,
+                  input  logic                       push, pop,
+                  input  logic [WIDTH-1:0]           wd,
+                  output logic [WIDTH-1:0]           rd,
+                  output logic                       empty, full,
+                  output logic [$clog2(DEPTH):0]     level);
+
+  // pushes to a full FIFO and pops from an empty one are ignored
+  localparam ABITS = $clog2(DEPTH);
+
+  logic [WIDTH-1:0] Mem[DEPTH];
+  logic [ABITS-1:0] Head, Tail;
+  logic             Put, Take;
+
+  assign empty = (level == 0);
+  assign full  = (level == DEPTH);
+  assign rd    = Mem[Head];
+  assign Put   = push & ~full;
+  assign Take  = pop & ~empty;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Head  <= 0;
+      Tail  <= 0;
+      level <= 0;
+    end else if (flush) begin
+      Head  <= 0;
+      Tail  <= 0;
+      level <= 0;
+    end else begin
+      if (Put) begin
+        Mem[Tail] <= wd;
+        Tail      <= Tail + 1;
+      end
+      if (Take) Head <= Head + 1;
+      level <= level + Put - Take;
+    end
+endmodule
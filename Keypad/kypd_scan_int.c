@@ -0,0 +1,189 @@
+/*
+ * kypd_scan_int.c
+ *
+ *  Keypad decoder on the keypad scanner IP, interrupt driven
+ */
+
+/**************************************************************
+*
+*    SECTION: DESCRIPTION
+*
+***************************************************************
+*
+* Same behaviour as main.c (the value of the key held down is
+* shown in the leds) with the keypad in JA Pmod connected to the
+* keypad scanner IP (kypd_scan.sv) instead of AXI GPIO 0: cols to
+* cols, rows to rows, irq to IRQ_F2P. The AXI GPIO 1 is connected
+* to the LEDs (CH1).
+*
+* The IP sweeps and debounces the keypad by itself; the CPU sleeps
+* in the main loop and only runs the interrupt handler when a key
+* changes, reading one register per event.
+*
+**************************************************************/
+
+/**************************************************************
+*
+*    SECTION: LIBRARIES
+*
+***************************************************************/
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xil_printf.h"
+#include "kypd_scan.h"
+
+/**************************************************************
+*
+*    SECTION: DEFINITIONS
+*
+***************************************************************/
+#define KYPD_BASEADDR		XPAR_KYPD_SCAN_0_S_AXI_BASEADDR	/* keypad scanner IP */
+#define KYPD_CLOCK_HZ		100000000	/* FCLK_CLK0, the AXI clock of the IP */
+#define KYPD_SCAN_HZ		1000		/* columns per second */
+#define KYPD_SETTLE_NS		10000		/* row settling after a column change */
+#define KYPD_DEBOUNCE_MS	20		/* key stable time */
+#define LEDS_GPIO_DEVICE_ID	XPAR_AXI_GPIO_1_DEVICE_ID	/* GPIO device connected to leds */
+#define LED_CHANNEL 1					/* GPIO port 1 for LEDs */
+#define printf xil_printf				/* smaller, optimised printf */
+
+#define INTC_DEVICE_ID 		XPAR_PS7_SCUGIC_0_DEVICE_ID // GIC device ID
+
+#define INTC_KYPD_INTERRUPT_ID XPAR_FABRIC_KYPD_SCAN_0_IRQ_INTR // Keypad scanner interrupt ID
+
+/**************************************************************
+*
+*    SECTION: DEVICE INSTANCES
+*
+***************************************************************/
+KypdScan Kypd;			/* Keypad scanner driver instance */
+XGpio Leds_Gpio;		/* GPIO Device driver instance for leds */
+
+XScuGic INTCInst; // Instance of the GIC
+
+/**************************************************************
+*
+*     SECTION: FUNCTION PROTOTYPES
+*
+***************************************************************/
+
+// Interrupt handler
+static void KYPD_Intr_Handler(void *InstancePtr);
+
+// Interrupt handler configuration
+static int IntcInitFunction(u16 DeviceId, KypdScan *KypdInstancePtr);
+
+/* Main function. */
+int main(void){
+	int Status;
+
+	/* LEDS GPIO driver initialization */
+	Status = XGpio_Initialize(&Leds_Gpio, LEDS_GPIO_DEVICE_ID);
+	if (Status != XST_SUCCESS){
+		xil_printf("Failed to initialise the LEDs\r\n");
+		return XST_FAILURE;
+	}
+	XGpio_SetDataDirection(&Leds_Gpio, LED_CHANNEL, 0x0);
+
+	/* Keypad scanner: timing, then the interrupt, then scanning */
+	KypdScan_Initialize(&Kypd, KYPD_BASEADDR, KYPD_CLOCK_HZ);
+	Status = KypdScan_SetTiming(&Kypd, KYPD_SCAN_HZ, KYPD_SETTLE_NS, KYPD_DEBOUNCE_MS);
+	if (Status != XST_SUCCESS){
+		xil_printf("Keypad scan timing out of range\r\n");
+		return XST_FAILURE;
+	}
+
+	Status = IntcInitFunction(INTC_DEVICE_ID, &Kypd);
+	if (Status != XST_SUCCESS) {
+		xil_printf("Failed to initialize Interrupt Controller\r\n");
+		return XST_FAILURE;
+	}
+
+	KypdScan_Start(&Kypd);
+
+	while(1){    // Infinite loop
+	}
+
+	return 0;
+}
+
+/**************************************************************
+*
+* SECTION: PROTOTYPE FUNCTION IMPLEMENTATIONS
+*
+**************************************************************/
+
+//----------------------------------------------------
+// INTERRUPT HANDLER FUNCTIONS
+// - called by the keypad scanner on every key change
+//----------------------------------------------------
+
+void KYPD_Intr_Handler(void *InstancePtr)
+{
+	KypdScan *KypdPtr = (KypdScan *)InstancePtr;
+	KypdScan_Event Event;
+	u32 Status;
+
+	// Clear first, so an event queued while draining interrupts again
+	Status = KypdScan_InterruptGetStatus(KypdPtr);
+	KypdScan_InterruptClear(KypdPtr, Status);
+
+	if (Status & KYPD_SCAN_IR_LOST)
+		xil_printf("Keypad events lost\r\n");
+
+	// Show the last key pressed, clear the leds when it is released
+	while (KypdScan_GetEvent(KypdPtr, &Event) == XST_SUCCESS) {
+		if (Event.Pressed)
+			XGpio_DiscreteWrite(&Leds_Gpio, LED_CHANNEL, Event.Key);
+		else if (KypdScan_GetKeys(KypdPtr) == 0)
+			XGpio_DiscreteWrite(&Leds_Gpio, LED_CHANNEL, 0x0);
+	}
+}
+
+
+int IntcInitFunction(u16 DeviceId, KypdScan *KypdInstancePtr)
+{
+	// Pointer to Interruption Configuration
+	XScuGic_Config *IntcConfig;
+	int status;
+
+	// Interrupt controller initialisation and success check
+	IntcConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(&INTCInst, IntcConfig, IntcConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS) return XST_FAILURE;
+
+	// The IP holds irq high until the ISR is cleared
+	XScuGic_SetPriorityTriggerType(&INTCInst, INTC_KYPD_INTERRUPT_ID, 0xA0, 0x1);
+
+	// Connect the keypad interrupt to handler and check for success
+	status = XScuGic_Connect(&INTCInst,
+						  	  	 INTC_KYPD_INTERRUPT_ID,
+						  	  	 (Xil_ExceptionHandler)KYPD_Intr_Handler,
+						  	  	 (void *)KypdInstancePtr);
+	if(status != XST_SUCCESS) return XST_FAILURE;
+
+	// Enable GIC
+	XScuGic_Enable(&INTCInst, INTC_KYPD_INTERRUPT_ID);
+
+	// Enable the keypad scanner interrupt
+	KypdScan_InterruptEnable(KypdInstancePtr);
+
+	/*
+	 * Initialize the exception table and register the interrupt
+	 * controller handler with the exception table
+	 */
+	Xil_ExceptionInit();
+
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			 	 	 	 	 	 (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+								 &INTCInst);
+
+	/* Enable non-critical exceptions */
+	Xil_ExceptionEnable();
+
+
+	return XST_SUCCESS;
+}
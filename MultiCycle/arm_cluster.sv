@@ -0,0 +1,242 @@
+// arm_cluster.sv
+// N multicycle ARM cores (arm_multi.sv) sharing one data memory
+//
+// Compile together with arm_multi.sv, top module cluster_testbench
+// run 10000
+// Expect simulator to print "Simulation succeeded"
+// when the value 7 is written to address 100 (0x64)
+//
+// Cluster
+//   Each core is an arm #(FAST, HARVARD = 1): it fetches from its own
+//   local instruction memory, a copy of the program image, in one
+//   cycle and without stalls. Its data accesses go to one shared
+//   single-port data memory (MEM_BYTES bytes, loaded with the same
+//   image) through an arbiter that grants one core per cycle; the
+//   others hold their state (Stall) until they get the memory.
+//    PRIORITY = 0  round robin: the search starts after the core that
+//                  had the last grant, so every core waits at most
+//                  N - 1 accesses
+//    PRIORITY = 1  fixed priority: the lowest CPUID wins
+//   SWP keeps the memory between its load and its store: the core
+//   raises Lock in MEMRD and the arbiter grants it again in the next
+//   cycle, so no other core can reach the word in between. This is
+//   the atomic primitive for locks (see the Swap section of
+//   arm_multi.sv).
+//
+// Core registers
+//   Each core sees its own registers at 0xFFFFFF00 (where the PMU is
+//   in arm_axi); they are read only and never go to the arbiter.
+//   Reach them with SUB Rn, R0, #0x100 (Rn = 0xFFFFFF00)
+//   Offset  Name
+//    0x00   CPUID     0 ... N-1
+//    0x04   NCORES    N
+//    0x08   CYCLES    clock cycles
+//    0x0C   INSTRET   retired instructions
+//    0x10   WAITS     cycles the core waited for the shared memory
+//    0x14   GRANTS    cycles the core had the shared memory
+//   WAITS / (WAITS + GRANTS) is the contention seen by a core.
+//
+// Testbench
+//   cluster_testbench fails on stores to the first 256 bytes other
+//   than to 96 and 100, and on success prints the cycles and the
+//   counters of every core. clusterbench.dat (copy it to memfile.dat,
+//   MEM_BYTES = 2048) sums an array in parallel for N = 1, 2, 4 or 8.
+//   The 1-to-8 core scaling is not measured: no simulator was
+//   available, so the benchmark has not been run at any N.
+
+module cluster_testbench #(parameter N = 4, FAST = 0, PRIORITY = 0,
+                           parameter MEM_BYTES = 2048)();
+
+  logic        clk;
+  logic        reset;
+
+  logic [31:0] WriteData, DataAdr;
+  logic        MemWrite;
+
+  // instantiate device to be tested
+  cluster #(N, FAST, PRIORITY, MEM_BYTES)
+          dut(clk, reset, WriteData, DataAdr, MemWrite);
+
+  // initialize test
+  initial
+    begin
+      reset <= 1; # 22; reset <= 0;
+    end
+
+  // generate clock to sequence tests
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  // check results
+  always @(negedge clk)
+    begin
+      if(MemWrite) begin
+        if(DataAdr === 100 & WriteData === 7) begin
+          $display("Simulation succeeded");
+          $display("N %0d CYCLES %0d", N, dut.Cycles);
+          for (int i = 0; i < N; i++)
+            $display("core %0d INSTRET %0d WAITS %0d GRANTS %0d",
+                     i, dut.InstRet[i], dut.Waits[i], dut.Grants[i]);
+          $stop;
+        end else if (DataAdr !== 96 & DataAdr < 256) begin
+          $display("Simulation failed");
+          $stop;
+        end
+      end
+    end
+endmodule
+
+module cluster #(parameter N = 4, FAST = 0, PRIORITY = 0,
+                 parameter MEM_BYTES = 2048)
+               (input  logic        clk, reset,
+                output logic [31:0] WriteData, Adr,
+                output logic        MemWrite);
+
+  logic [31:0] CAdr[N], CWriteData[N], CReadData[N];
+  logic [31:0] IAdr[N], IReadData[N];
+  logic [31:0] InstRet[N], Waits[N], Grants[N];
+  logic [31:0] Cycles, ReadData;
+  logic [6:0]  Events[N];
+  logic [3:0]  CByteEn[N], ByteEn;
+  logic [N-1:0] CMemWrite, MemRead, Lock, Stall, LocalSel, Req, Grant;
+
+  // cores with their local instruction memories and registers
+  genvar i;
+  generate
+    for (i = 0; i < N; i++) begin : core
+      logic [31:0] LocalData;
+
+      arm #(FAST, 1) arm(clk, reset, 1'b0, 1'b0, CMemWrite[i],
+                         CAdr[i], CWriteData[i], CByteEn[i],
+                         CReadData[i], IAdr[i], IReadData[i],
+                         Events[i], , , MemRead[i], Lock[i], Stall[i]);
+      imem #(MEM_BYTES) imem(IAdr[i], IReadData[i]);
+
+      assign LocalSel[i]  = (CAdr[i][31:8] == 24'hFFFFFF);
+      assign Req[i]       = (MemRead[i] | CMemWrite[i]) & ~LocalSel[i];
+      assign Stall[i]     = Req[i] & ~Grant[i];
+      assign CReadData[i] = LocalSel[i] ? LocalData : ReadData;
+
+      always_ff @(posedge clk, posedge reset)
+        if (reset) begin
+          InstRet[i] <= 0;
+          Waits[i]   <= 0;
+          Grants[i]  <= 0;
+        end else begin
+          InstRet[i] <= InstRet[i] + Events[i][4];
+          Waits[i]   <= Waits[i]   + Stall[i];
+          Grants[i]  <= Grants[i]  + Grant[i];
+        end
+
+      always_comb
+        case(CAdr[i][7:2])
+          6'h00:   LocalData = i;
+          6'h01:   LocalData = N;
+          6'h02:   LocalData = Cycles;
+          6'h03:   LocalData = InstRet[i];
+          6'h04:   LocalData = Waits[i];
+          6'h05:   LocalData = Grants[i];
+          default: LocalData = 32'b0;
+        endcase
+    end
+  endgenerate
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) Cycles <= 0;
+    else       Cycles <= Cycles + 1;
+
+  // shared data memory, driven by the core holding the grant
+  arbiter #(N, PRIORITY) arb(clk, reset, Req, Lock, Grant);
+
+  always_comb
+    begin
+      Adr       = 32'b0;
+      WriteData = 32'b0;
+      ByteEn    = 4'b0;
+      MemWrite  = 0;
+      for (int j = 0; j < N; j++)
+        if (Grant[j]) begin
+          Adr       = CAdr[j];
+          WriteData = CWriteData[j];
+          ByteEn    = CByteEn[j];
+          MemWrite  = CMemWrite[j];
+        end
+    end
+
+  dmem #(MEM_BYTES) dmem(clk, MemWrite, ByteEn, Adr, WriteData, ReadData);
+endmodule
+
+module arbiter #(parameter N = 4, PRIORITY = 0)
+               (input  logic         clk, reset,
+                input  logic [N-1:0] Req, Lock,
+                output logic [N-1:0] Grant);
+
+  // Last had the previous grant; Held keeps the memory for it for one
+  // more cycle after a locked access (the store of a SWP)
+  logic [7:0] Last;
+  logic       Held;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Last <= 0;
+      Held <= 0;
+    end else begin
+      for (int j = 0; j < N; j++)
+        if (Grant[j]) Last <= j;
+      Held <= |(Grant & Lock);
+    end
+
+  // the loops run from the far end, so the winner is assigned last
+  always_comb
+    begin
+      Grant = '0;
+      if (Held & Req[Last]) Grant[Last] = 1'b1;
+      else if (PRIORITY)
+        for (int j = N - 1; j >= 0; j--) begin
+          if (Req[j]) begin
+            Grant    = '0;
+            Grant[j] = 1'b1;
+          end
+        end
+      else
+        for (int k = N; k >= 1; k--) begin
+          if (Req[(Last + k) % N]) begin
+            Grant                = '0;
+            Grant[(Last + k) % N] = 1'b1;
+          end
+        end
+    end
+endmodule
+
+module imem #(parameter BYTES = 2048)
+            (input  logic [31:0] a,
+             output logic [31:0] rd);
+
+  logic [31:0] RAM[BYTES/4-1:0];
+
+  initial
+    $readmemh("memfile.dat", RAM);
+
+  assign rd = RAM[a[$clog2(BYTES)-1:2]]; // word aligned
+endmodule
+
+module dmem #(parameter BYTES = 2048)
+            (input  logic        clk, we,
+             input  logic [3:0]  be,
+             input  logic [31:0] a, wd,
+             output logic [31:0] rd);
+
+  logic [31:0] RAM[BYTES/4-1:0];
+
+  initial
+    $readmemh("memfile.dat", RAM);
+
+  assign rd = RAM[a[$clog2(BYTES)-1:2]]; // word aligned
+
+  always_ff @(posedge clk)
+    if (we)
+      for (int b = 0; b < 4; b++)
+        if (be[b]) RAM[a[$clog2(BYTES)-1:2]][8*b +: 8] <= wd[8*b +: 8];
+endmodule
@@ -1,42 +1,88 @@
 // arm_multi.sv
 // David_Harris@hmc.edu, Sarah_Harris@hmc.edu 25 December 2013
 // Multi-cycle implementation of a subset of ARMv4
+//
+// run 3000
+// Expect simulator to print "Simulation succeeded"
+// when the value 7 is written to address 100 (0x64)
 
 // 16 32-bit registers
 // Data-processing instructions
-//   ADD, SUB, AND, ORR
+//   ADD, SUB, AND, ORR, MOV
 //   INSTR <cond> <S> <Rd>, <Rn>, #immediate
-//   INSTR <cond> <S> <Rd>, <Rn>, <Rm>
+//   INSTR <cond> <S> <Rd>, <Rn>, <Rm> {, <shift> #shamt5}
+//   INSTR <cond> <S> <Rd>, <Rn>, <Rm>, <shift> <Rs>
 //    Rd <- <Rn> INSTR <Rm>	    	if (S) Update Status Flags
 //    Rd <- <Rn> INSTR immediate	if (S) Update Status Flags
+//    MOV ignores Rn: Rd <- immediate / shifted Rm
 //   Instr[31:28] = cond
 //   Instr[27:26] = Op = 00
 //   Instr[25:20] = Funct
 //                  [25]:    1 for immediate, 0 for register
 //                  [24:21]: 0100 (ADD) / 0010 (SUB) /
-//                           0000 (AND) / 1100 (ORR)
+//                           0000 (AND) / 1100 (ORR) / 1101 (MOV)
 //                  [20]:    S (1 = update CPSR status Flags)
 //   Instr[19:16] = Rn
 //   Instr[15:12] = Rd
-//   Instr[11:8]  = 0000
-//   Instr[7:0]   = immed_8  (for #immediate type) / 
-//                  0000<Rm> (for register type)
+//   Instr[11:0]  = <rot><immed_8>        (for #immediate type) /
+//                  <shamt5><sh>0<Rm>     (for register type) /
+//                  <Rs>0<sh>1<Rm>        (for register-shifted type)
+//    immediate = immed_8 rotated right by 2*rot
+//    sh: 00 (LSL) / 01 (LSR) / 10 (ASR) / 11 (ROR)
+//    LSR #0 and ASR #0 shift by 32, ROR #0 (RRX) is not supported
+//    the shifter carry out is not written to C: logical instructions
+//    leave C and V unchanged
 //   
+// Multiply instructions
+//   MUL, MLA, UMULL
+//   MUL<cond><S>   rd, rm, rs         rd <- rm * rs
+//   MLA<cond><S>   rd, rm, rs, ra     rd <- rm * rs + ra
+//   UMULL<cond><S> rdlo, rdhi, rm, rs {rdhi, rdlo} <- rm * rs (unsigned)
+//    if (S) update N and Z (C and V unchanged)
+//   Instr[31:28] = cond
+//   Instr[27:24] = 0000
+//   Instr[23:20] = 000S (MUL) / 001S (MLA) / 100S (UMULL)
+//   Instr[19:16] = rd / rdhi
+//   Instr[15:12] = ra / rdlo (0000 for MUL)
+//   Instr[11:8]  = rs
+//   Instr[7:4]   = 1001
+//   Instr[3:0]   = rm
+//   The multiplier retires 8 bits of rs per cycle and stops as soon as
+//   the remaining bits of rs are zero: DECODE loads the operands and
+//   does the first step, MULEX runs until done, MULWB writes back.
+//   A multiply takes 4 cycles for rs < 2^16, 5 for rs < 2^24, else 6.
+//
 // Load/Store instructions
-//   LDR, STR
+//   LDR, STR, LDRB, STRB
 //   INSTR <Rd>, [<Rn>, #offset]
-//    LDR: Rd <- Mem[<Rn>+offset]
-//    STR: Mem[<Rn>+offset] <- Rd
+//    LDR:  Rd <- Mem[<Rn>+offset]
+//    STR:  Mem[<Rn>+offset] <- Rd
+//    LDRB: Rd <- zero extended byte Mem[<Rn>+offset]
+//    STRB: byte Mem[<Rn>+offset] <- Rd[7:0]
 //   Instr[31:28] = cond
 //   Instr[27:26] = Op = 01 
 //   Instr[25:20] = Funct
 //                  [25]:    0 (A)
-//                  [24:21]: 1100 (P/U/B/W)
+//                  [24:21]: 1100 (P/U/B/W), B = 1 for LDRB/STRB
 //                  [20]:    L (1 for LDR, 0 for STR)
 //   Instr[19:16] = Rn
 //   Instr[15:12] = Rd
 //   Instr[11:0]  = imm (zero extended)
 //
+// Swap instructions
+//   SWP<cond>{B} Rd, Rm, [Rn]   tmp <- Mem[Rn]; Mem[Rn] <- Rm; Rd <- tmp
+//   Instr[27:20] = 00010B00, Instr[11:4] = 00001001
+//   Instr[19:16] = Rn, Instr[15:12] = Rd, Instr[3:0] = Rm
+//   MEMADR, MEMRD (Lock high), MEMWR (store and Rd write back)
+//
+// Block transfer instructions
+//   LDM/STM<cond><IA|IB|DA|DB> Rn{!}, {reglist}, PUSH, POP
+//   Instr[27:25] = Op = 100, Instr[24:20] = P U S W L (S = 0)
+//   Instr[19:16] = Rn, Instr[15:0] = reglist (bit i = Ri)
+//   lowest register at the lowest address; Rn is written back before
+//   the transfers; LDM of R15 branches; empty lists and STM of R15 are
+//   not supported. LSMADR, then one LSMLD/LSMST per register.
+//
 // Branch instruction (PC <= PC + offset, PC holds 8 bytes past Branch
 //   B
 //   INSTR <target>
@@ -49,6 +95,18 @@
 //   Instr[23:0]  = offset (sign extend, shift left 2)
 //   Note: no Branch delay slot on ARM
 //
+// Status registers and interrupts
+//   MRS<cond> Rd, CPSR|SPSR; MSR<cond> CPSR|SPSR_<fields>, Rm|#imm
+//   Instr[25:20] = I 10 R L 0, Instr[19:16] = 1111 (MRS) / fields
+//   CPSR = N Z C V 0... I F 0 M[4:0]; reset: svc, I = F = 1
+//   irq/fiq are level sensitive; EXCEPT replaces the next FETCH:
+//    LR_<mode> <- PC + 4, SPSR_<mode> <- CPSR, PC <- 0x18 / 0x1C
+//   SUBS PC, LR, #4 (S with Rd = R15) restores CPSR from SPSR.
+//   Banked: irq R13-R14; fiq R8-R14 (FIQ_BANK = 1) or R13-R14.
+//   Latency: rest of the current instruction plus EXCEPT; by the
+//   state schedule 2-7 cycles, 4+N for LDM/STM, plus cache stalls.
+//   Left unmeasured: with no simulator here intbench was never run.
+//
 // Other:
 //   R15 reads as PC+8
 //   Conditional Encoding
@@ -68,262 +126,2083 @@
 //    1100  Signed greater                N = V & Z = 0
 //    1101  Signed less/equal             N != V | Z = 1
 //    1110  Always                        any
-//   Writes to register 15 (PC) are ignored 
+//
+// Performance monitoring unit, PMU_BASE = 0xFFFFFF00
+//    0x00 PMCR      [0] enable (1 at reset), [1] clear (write)
+//    0x04 CYCLES    0x08 INSTRET   0x0C BRANCHES  0x10 CONDFAIL
+//    0x14 LOADS     0x18 STORES    0x1C MEMSTALL  0x20 IHITS
+//    0x24 IMISSES   0x28 DHITS     0x2C DMISSES   0x30 DWBACKS
+//    0x34 PFHITS    0x38 WBFULL    0x3C INTLAT
+//    0x40+4*s       cycles in mainfsm state s (EXCEPT = 15)
+//
+// Parameters (top)
+//   FAST         1: write back in EXECUTER/EXECUTEI and MEMRD
+//   HARVARD      1: separate fetch port; the last state of an
+//                instruction fetches the next one
+//   FIQ_BANK     1: bank R8-R12 for fiq as well
+//   MEM_BASE, MEM_BYTES, MEM_LATENCY   axi_mem
+//   IC_/DC_SIZE, _LINE, _WAYS           caches (powers of two)
+//   DC_WRITEBACK, DC_WALLOC             write policy
+//   PREFETCH     1: next-line stream buffer for instruction fills
+//   WBUF         write buffer depth in words
+//   GPIO_WIDTH   bits per GPIO channel
+//   States: B 3, data processing 4 (FAST 3), STR 4, LDR 5 (FAST 4),
+//   MUL 4-6, LDM/STM 3+N; HARVARD = 1 saves one on all but B.
+//   Those come from the state schedule; the average CPI against the
+//   textbook 4-5 is unmeasured, as no simulator was available.
+//   The same holds for the HARVARD = 0 and 1 comparison.
+//   arm_axi exposes i_* (read only) and d_* AXI4 masters.
+//
+// I/O page 0xFFFFF000-0xFFFFFEFF (word accesses, irq = OR of all)
+//   scu_timer 0xFFFFF000  LOAD, COUNTER, CONTROL, ISR (XScuTimer)
+//   ttc       0xFFFFF100  CLK_CNTRL 0x00, CNT_CNTRL 0x0C, VALUE 0x18,
+//                         INTERVAL 0x24, MATCH_1 0x30, ISR 0x54,
+//                         IER 0x60, +4n for counter n (XTtcPs)
+//   gpio      0xFFFFF200  DATA/TRI 0x000/0x004, DATA2/TRI2 0x008/0x00C,
+//                         GIER 0x11C, ISR 0x120, IER 0x128 (XGpio)
+//
+// Testbench
+//   Fails on stores below 256 other than to 96 and 100. IRQ_AT and
+//   FIQ_AT raise irq/fiq (0: never); stores to 0x300/0x304 drop them.
+//   Prints INTLAT, GPIO and TTC wave changes, and the PMU counters.
+//   +define+MEMLOAD_DPI with SimLoader: +image=<file> loads an ELF or
+//   raw binary instead of memfile.dat.
+
+module testbench #(parameter FAST = 0, HARVARD = 0, MEM_BYTES = 256,
+                   parameter IRQ_AT = 0, FIQ_AT = 0)();
+
+  logic        clk;
+  logic        reset;
+  logic        irq, fiq, entered;
+  int          cycle, gpiocycle, wavecycle;
+  logic [7:0]  gpio_o, gpio2_o, lastgpio, lastgpio2;
+  logic [2:0]  wave, lastwave;
+
+  logic [31:0] WriteData, DataAdr;
+  logic        MemWrite;
+
+  // instantiate device to be tested
+  top #(FAST, HARVARD, 32'h0, MEM_BYTES)
+      dut(clk, reset, irq, fiq, WriteData, DataAdr, MemWrite,
+          8'h00, gpio_o, 8'h00, gpio2_o, wave);
+  
+  // initialize test
+  initial
+    begin
+      reset <= 1; # 22; reset <= 0;
+    end
+
+  // generate clock to sequence tests
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  // interrupt sources: raised at a fixed cycle, acknowledged by a
+  // store to 0x300 (irq) or 0x304 (fiq)
+  always @(posedge clk, posedge reset)
+    if (reset) begin
+      cycle <= 0;
+      irq   <= 0;
+      fiq   <= 0;
+    end else begin
+      cycle <= cycle + 1;
+      if (cycle == IRQ_AT & IRQ_AT != 0) irq <= 1;
+      else if (MemWrite & DataAdr === 32'h300) irq <= 0;
+      if (cycle == FIQ_AT & FIQ_AT != 0) fiq <= 1;
+      else if (MemWrite & DataAdr === 32'h304) fiq <= 0;
+    end
+
+  // the PMU updates INTLAT at the end of EXCEPT (state 15)
+  always @(negedge clk)
+    begin
+      if (entered)
+        $display("Interrupt taken at cycle %0d, latency %0d cycles",
+                 cycle, dut.cpu.pmu.IntLat);
+      entered <= (dut.cpu.State === 4'd15);
+    end
+
+  // peripheral outputs, timed in cycles
+  always @(negedge clk)
+    if (~reset) begin
+      if (gpio_o !== lastgpio | gpio2_o !== lastgpio2) begin
+        if (!$isunknown(lastgpio))
+          $display("GPIO %h %h at cycle %0d (+%0d)", gpio_o, gpio2_o,
+                   cycle, cycle - gpiocycle);
+        gpiocycle = cycle;
+      end
+      if (wave !== lastwave) begin
+        if (!$isunknown(lastwave))
+          $display("TTC waves %b at cycle %0d (+%0d)", wave,
+                   cycle, cycle - wavecycle);
+        wavecycle = cycle;
+      end
+      lastgpio  <= gpio_o;
+      lastgpio2 <= gpio2_o;
+      lastwave  <= wave;
+    end
+
+  // check results
+  // stores above the first 256 bytes (stacks, buffers, the PMU) are
+  // left to the program
+  always @(negedge clk)
+    begin
+      if(MemWrite) begin
+        if(DataAdr === 100 & WriteData === 7) begin
+          $display("Simulation succeeded");
+          $display("CYCLES %0d INSTRET %0d CPI %0.2f MEMSTALL %0d",
+                   dut.cpu.pmu.Cycles, dut.cpu.pmu.InstRet,
+                   real'(dut.cpu.pmu.Cycles) / dut.cpu.pmu.InstRet,
+                   dut.cpu.pmu.MemStall);
+          $display("IHITS %0d IMISSES %0d DHITS %0d DMISSES %0d DWBACKS %0d",
+                   dut.cpu.pmu.IHits, dut.cpu.pmu.IMisses,
+                   dut.cpu.pmu.DHits, dut.cpu.pmu.DMisses,
+                   dut.cpu.pmu.DWbacks);
+          $display("PFHITS %0d WBFULL %0d",
+                   dut.cpu.pmu.PfHits, dut.cpu.pmu.WbFulls);
+          $stop;
+        end else if (DataAdr !== 96 & DataAdr < 256) begin
+          $display("Simulation failed");
+          $stop;
+        end
+      end
+    end
+endmodule
+
+module top #(parameter FAST         = 0,   HARVARD   = 0,
+             parameter MEM_BASE     = 32'h0, MEM_BYTES = 256,
+             parameter MEM_LATENCY  = 4,
+             parameter IC_SIZE      = 128, IC_LINE = 16, IC_WAYS = 1,
+             parameter DC_SIZE      = 128, DC_LINE = 16, DC_WAYS = 2,
+             parameter DC_WRITEBACK = 1,   DC_WALLOC = 1,
+             parameter PREFETCH     = 1,   WBUF = 8,
+             parameter FIQ_BANK     = 1,   GPIO_WIDTH = 8)
+           (input  logic        clk, reset,
+            input  logic        irq, fiq,
+            output logic [31:0] WriteData, Adr,
+            output logic        MemWrite,
+            input  logic [GPIO_WIDTH-1:0] gpio_i,
+            output logic [GPIO_WIDTH-1:0] gpio_o,
+            input  logic [GPIO_WIDTH-1:0] gpio2_i,
+            output logic [GPIO_WIDTH-1:0] gpio2_o,
+            output logic [2:0]  ttc_wave);
+
+  // AXI4 signals, port 0 = instruction master, port 1 = data master
+  logic        awid[2], awvalid[2], awready[2];
+  logic [31:0] awaddr[2];
+  logic [7:0]  awlen[2];
+  logic [2:0]  awsize[2];
+  logic [1:0]  awburst[2];
+  logic [31:0] wdata[2];
+  logic [3:0]  wstrb[2];
+  logic        wlast[2], wvalid[2], wready[2];
+  logic        bid[2], bvalid[2], bready[2];
+  logic [1:0]  bresp[2];
+  logic        arid[2], arvalid[2], arready[2];
+  logic [31:0] araddr[2];
+  logic [7:0]  arlen[2];
+  logic [2:0]  arsize[2];
+  logic [1:0]  arburst[2];
+  logic        rid[2], rlast[2], rvalid[2], rready[2];
+  logic [31:0] rdata[2];
+  logic [1:0]  rresp[2];
+
+  // I/O page
+  logic        io_we, io_re, TimerIrq, GpioIrq;
+  logic [11:0] io_a;
+  logic [31:0] io_wd, io_rd, TimerRd, TtcRd, GpioRd;
+  logic [2:0]  TtcIrq;
+
+  // instantiate processor with its caches
+  arm_axi #(FAST, HARVARD, IC_SIZE, IC_LINE, IC_WAYS,
+            DC_SIZE, DC_LINE, DC_WAYS, DC_WRITEBACK, DC_WALLOC,
+            PREFETCH, WBUF, FIQ_BANK)
+      cpu(clk, reset, irq | TimerIrq | (|TtcIrq) | GpioIrq, fiq,
+          WriteData, Adr, MemWrite,
+          arid[0], araddr[0], arlen[0], arsize[0], arburst[0],
+          arvalid[0], arready[0],
+          rid[0], rdata[0], rresp[0], rlast[0], rvalid[0], rready[0],
+          awid[1], awaddr[1], awlen[1], awsize[1], awburst[1],
+          awvalid[1], awready[1],
+          wdata[1], wstrb[1], wlast[1], wvalid[1], wready[1],
+          bid[1], bresp[1], bvalid[1], bready[1],
+          arid[1], araddr[1], arlen[1], arsize[1], arburst[1],
+          arvalid[1], arready[1],
+          rid[1], rdata[1], rresp[1], rlast[1], rvalid[1], rready[1],
+          io_we, io_re, io_a, io_wd, io_rd);
+
+  // the instruction master never writes
+  assign awvalid[0] = 0;
+  assign wvalid[0]  = 0;
+  assign bready[0]  = 1;
+  assign {awid[0], awaddr[0], awlen[0], awsize[0], awburst[0]} = 0;
+  assign {wdata[0], wstrb[0], wlast[0]} = 0;
 
-module top(input  logic        clk, reset, 
-           output logic [31:0] WriteData, Adr, 
-           output logic        MemWrite);
+  // instantiate memory
+  axi_mem #(MEM_BASE, MEM_BYTES, MEM_LATENCY)
+      mem(clk, reset,
+          awid, awaddr, awlen, awsize, awburst, awvalid, awready,
+          wdata, wstrb, wlast, wvalid, wready,
+          bid, bresp, bvalid, bready,
+          arid, araddr, arlen, arsize, arburst, arvalid, arready,
+          rid, rdata, rresp, rlast, rvalid, rready);
 
-  logic [31:0] PC, Instr, ReadData;
+  // instantiate peripherals: 0x000 timer, 0x100 ttc, 0x200-0x3FF gpio
+  scu_timer timer(clk, reset, io_we & (io_a[11:8] == 4'h0), io_a[7:0],
+                  io_wd, TimerRd, TimerIrq);
+  ttc       ttc(clk, reset, io_we & (io_a[11:8] == 4'h1),
+                io_re & (io_a[11:8] == 4'h1), io_a[7:0], io_wd, TtcRd,
+                TtcIrq, ttc_wave);
+  gpio #(GPIO_WIDTH)
+            gpio(clk, reset, io_we & (io_a[11:9] == 3'b001), io_a[8:0],
+                 io_wd, GpioRd, GpioIrq, gpio_i, gpio_o, gpio2_i, gpio2_o);
+
+  always_comb
+    case(io_a[11:8])
+      4'h0:       io_rd = TimerRd;
+      4'h1:       io_rd = TtcRd;
+      4'h2, 4'h3: io_rd = GpioRd;
+      default:    io_rd = 32'b0;
+    endcase
+endmodule
+
+module arm_axi #(parameter FAST         = 0,   HARVARD   = 0,
+                 parameter IC_SIZE      = 128, IC_LINE = 16, IC_WAYS = 1,
+                 parameter DC_SIZE      = 128, DC_LINE = 16, DC_WAYS = 2,
+                 parameter DC_WRITEBACK = 1,   DC_WALLOC = 1,
+                 parameter PREFETCH     = 1,   WBUF = 8,
+                 parameter FIQ_BANK     = 1)
+               (input  logic        clk, reset,
+                input  logic        irq, fiq,
+                output logic [31:0] WriteData, Adr,
+                output logic        MemWrite,
+                // instruction AXI4 master (read only)
+                output logic        i_arid,
+                output logic [31:0] i_araddr,
+                output logic [7:0]  i_arlen,
+                output logic [2:0]  i_arsize,
+                output logic [1:0]  i_arburst,
+                output logic        i_arvalid,
+                input  logic        i_arready,
+                input  logic        i_rid,
+                input  logic [31:0] i_rdata,
+                input  logic [1:0]  i_rresp,
+                input  logic        i_rlast, i_rvalid,
+                output logic        i_rready,
+                // data AXI4 master
+                output logic        d_awid,
+                output logic [31:0] d_awaddr,
+                output logic [7:0]  d_awlen,
+                output logic [2:0]  d_awsize,
+                output logic [1:0]  d_awburst,
+                output logic        d_awvalid,
+                input  logic        d_awready,
+                output logic [31:0] d_wdata,
+                output logic [3:0]  d_wstrb,
+                output logic        d_wlast, d_wvalid,
+                input  logic        d_wready,
+                input  logic        d_bid,
+                input  logic [1:0]  d_bresp,
+                input  logic        d_bvalid,
+                output logic        d_bready,
+                output logic        d_arid,
+                output logic [31:0] d_araddr,
+                output logic [7:0]  d_arlen,
+                output logic [2:0]  d_arsize,
+                output logic [1:0]  d_arburst,
+                output logic        d_arvalid,
+                input  logic        d_arready,
+                input  logic        d_rid,
+                input  logic [31:0] d_rdata,
+                input  logic [1:0]  d_rresp,
+                input  logic        d_rlast, d_rvalid,
+                output logic        d_rready,
+                // I/O page 0xFFFFF000-0xFFFFFEFF, not cached
+                output logic        io_we, io_re,
+                output logic [11:0] io_a,
+                output logic [31:0] io_wd,
+                input  logic [31:0] io_rd);
+
+  logic [31:0] ReadData, IAdr, IReadData, DReadData, PmuReadData;
+  logic [31:0] IMAdr, IMWriteData, IMReadData;
+  logic [31:0] DMAdr, DMWriteData, DMReadData;
+  logic [7:0]  IMLen, DMLen;
+  logic [6:0]  Events;
+  logic [3:0]  State, ByteEn, DMByteEn;
+  logic [2:0]  IEvents, DEvents;
+  logic [1:0]  IAxiEvents, DAxiEvents;
+  logic        PmuSel, IoSel, IFetch, MemRead, Stall, IReq, DReq;
+  logic        IReady, DReady, IDone, DDone;
+  logic        IMReq, IMWe, IMBurst, IMReady;
+  logic        DMReq, DMWe, DMBurst, DMReady;
   
-  // instantiate processor and shared memory
-  arm arm(clk, reset, MemWrite, Adr, 
-          WriteData, ReadData);
-  mem mem(clk, MemWrite, Adr, WriteData, ReadData);
+  // instantiate processor
+  arm #(FAST, HARVARD, FIQ_BANK)
+      arm(clk, reset, irq, fiq, MemWrite, Adr, WriteData, ByteEn,
+          ReadData, IAdr, IReadData,
+          Events, State, IFetch, MemRead, , Stall);
+
+  // address decoding: PMU in the last 256 bytes, the I/O page below
+  // it, neither cached
+  assign PmuSel = (Adr[31:8] == 24'hFFFFFF);
+  assign IoSel  = (Adr[31:12] == 20'hFFFFF) & ~PmuSel;
+  assign ReadData = PmuSel ? PmuReadData :
+                    IoSel  ? io_rd       : DReadData;
+
+  // peripheral accesses take effect once, in the cycle the state ends
+  // (with HARVARD a fetch stall can hold it); reads can have side
+  // effects, so MemRead, like MemWrite, is already gated by the
+  // condition
+  assign io_we = MemWrite & IoSel & ~Stall;
+  assign io_re = MemRead  & IoSel & ~Stall;
+  assign io_a  = Adr[11:0];
+  assign io_wd = WriteData;
+
+  // with HARVARD a state can fetch and access data at once; a side
+  // that finishes first is masked until the other one is done too,
+  // so a store or a hit is not repeated while the state is held
+  always_ff @(posedge clk, posedge reset)
+    if (reset | ~Stall) begin
+      IDone <= 0;
+      DDone <= 0;
+    end else begin
+      if (IReq & IReady) IDone <= 1;
+      if (DReq & DReady) DDone <= 1;
+    end
+
+  assign IReq  = IFetch & ~IDone;
+  assign DReq  = (MemRead | MemWrite) & ~PmuSel & ~IoSel & ~DDone;
+  assign Stall = (IReq & ~IReady) | (DReq & ~DReady);
+
+  // instantiate caches
+  cache #(IC_SIZE, IC_LINE, IC_WAYS, 0, 0)
+        icache(clk, reset, IReq, 1'b0, 4'b0000, IAdr, WriteData,
+               IReadData, IReady, IEvents,
+               IMReq, IMWe, IMBurst, IMLen, , IMAdr, IMWriteData,
+               IMReadData, IMReady);
+  cache #(DC_SIZE, DC_LINE, DC_WAYS, DC_WRITEBACK, DC_WALLOC)
+        dcache(clk, reset, DReq, MemWrite, ByteEn, Adr, WriteData,
+               DReadData, DReady, DEvents,
+               DMReq, DMWe, DMBurst, DMLen, DMByteEn, DMAdr, DMWriteData,
+               DMReadData, DMReady);
+
+  // AXI4 masters: next-line prefetch for instructions, a write buffer
+  // for data
+  axi_master #(IC_LINE, PREFETCH, WBUF)
+        imaster(clk, reset, IMReq, IMWe, IMBurst, IMLen, 4'b0000, IMAdr,
+                IMWriteData, IMReadData, IMReady, IAxiEvents,
+                , , , , , , 1'b0,
+                , , , , 1'b0,
+                1'b0, 2'b00, 1'b0, ,
+                i_arid, i_araddr, i_arlen, i_arsize, i_arburst,
+                i_arvalid, i_arready,
+                i_rid, i_rdata, i_rresp, i_rlast, i_rvalid, i_rready);
+  axi_master #(DC_LINE, 0, WBUF)
+        dmaster(clk, reset, DMReq, DMWe, DMBurst, DMLen, DMByteEn, DMAdr,
+                DMWriteData, DMReadData, DMReady, DAxiEvents,
+                d_awid, d_awaddr, d_awlen, d_awsize, d_awburst,
+                d_awvalid, d_awready,
+                d_wdata, d_wstrb, d_wlast, d_wvalid, d_wready,
+                d_bid, d_bresp, d_bvalid, d_bready,
+                d_arid, d_araddr, d_arlen, d_arsize, d_arburst,
+                d_arvalid, d_arready,
+                d_rid, d_rdata, d_rresp, d_rlast, d_rvalid, d_rready);
+
+  pmu pmu(clk, reset, MemWrite & PmuSel, Adr[7:0], WriteData,
+          PmuReadData, Events, State,
+          {Stall, IEvents[2:1], DEvents, IAxiEvents[1], DAxiEvents[0]});
 endmodule
 
-module mem(input  logic        clk, we,
-           input  logic [31:0] a, wd,
-           output logic [31:0] rd);
+module pmu(input  logic        clk, reset, we,
+           input  logic [7:0]  a,
+           input  logic [31:0] wd,
+           output logic [31:0] rd,
+           input  logic [6:0]  Events,
+           input  logic [3:0]  State,
+           input  logic [7:0]  MemEvents);
+
+  logic        En, Retire, Branch, CondFailed, Load, Store;
+  logic        IntPend, IntEntry;
+  logic        Stalled, IHit, IMiss, DHit, DMiss, DWback, PfHit, WbFull;
+  logic [31:0] Cycles, InstRet, Branches, CondFail, Loads, Stores;
+  logic [31:0] MemStall, IHits, IMisses, DHits, DMisses, DWbacks;
+  logic [31:0] PfHits, WbFulls, IntWait, IntLat;
+  logic [31:0] StateCycles[15:0];
+
+  assign {IntPend, IntEntry, Retire, Branch, CondFailed, Load, Store} =
+         Events;
+  assign {Stalled, IHit, IMiss, DHit, DMiss, DWback, PfHit, WbFull} =
+         MemEvents;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      En <= 1;
+      {Cycles, InstRet, Branches, CondFail, Loads, Stores} <= 0;
+      {MemStall, IHits, IMisses, DHits, DMisses, DWbacks} <= 0;
+      {PfHits, WbFulls, IntWait, IntLat} <= 0;
+      for (int i = 0; i < 16; i++) StateCycles[i] <= 0;
+    end else if (we & (a[7:2] == 6'h00)) begin
+      En <= wd[0];
+      if (wd[1]) begin
+        {Cycles, InstRet, Branches, CondFail, Loads, Stores} <= 0;
+        {MemStall, IHits, IMisses, DHits, DMisses, DWbacks} <= 0;
+        {PfHits, WbFulls, IntWait, IntLat} <= 0;
+        for (int i = 0; i < 16; i++) StateCycles[i] <= 0;
+      end
+    end else if (En) begin
+      Cycles   <= Cycles   + 1;
+      InstRet  <= InstRet  + Retire;
+      Branches <= Branches + Branch;
+      CondFail <= CondFail + CondFailed;
+      Loads    <= Loads    + Load;
+      Stores   <= Stores   + Store;
+      MemStall <= MemStall + Stalled;
+      IHits    <= IHits    + IHit;
+      IMisses  <= IMisses  + IMiss;
+      DHits    <= DHits    + DHit;
+      DMisses  <= DMisses  + DMiss;
+      DWbacks  <= DWbacks  + DWback;
+      PfHits   <= PfHits   + PfHit;
+      WbFulls  <= WbFulls  + WbFull;
+      StateCycles[State] <= StateCycles[State] + 1;
+      // interrupt latency: cycles from an unmasked request to EXCEPT,
+      // plus EXCEPT itself
+      if (IntEntry) begin
+        IntLat  <= IntWait + 1;
+        IntWait <= 0;
+      end else if (IntPend) IntWait <= IntWait + 1;
+      else                  IntWait <= 0;
+    end
+
+  always_comb
+    if (a[7:6] == 2'b01) rd = StateCycles[a[5:2]];
+    else
+      case(a[7:2])
+        6'h00:   rd = {31'b0, En};
+        6'h01:   rd = Cycles;
+        6'h02:   rd = InstRet;
+        6'h03:   rd = Branches;
+        6'h04:   rd = CondFail;
+        6'h05:   rd = Loads;
+        6'h06:   rd = Stores;
+        6'h07:   rd = MemStall;
+        6'h08:   rd = IHits;
+        6'h09:   rd = IMisses;
+        6'h0A:   rd = DHits;
+        6'h0B:   rd = DMisses;
+        6'h0C:   rd = DWbacks;
+        6'h0D:   rd = PfHits;
+        6'h0E:   rd = WbFulls;
+        6'h0F:   rd = IntLat;
+        default: rd = 32'b0;
+      endcase
+endmodule
+
+module axi_master #(parameter LINE = 16, PREFETCH = 0, WBUF = 8)
+                  (input  logic        clk, reset,
+                   // cache side
+                   input  logic        mreq, mwe, mburst,
+                   input  logic [7:0]  mlen,
+                   input  logic [3:0]  mbe,
+                   input  logic [31:0] ma, mwd,
+                   output logic [31:0] mrd,
+                   output logic        mready,
+                   output logic [1:0]  Events,
+                   // AXI4 write address, write data, write response
+                   output logic        awid,
+                   output logic [31:0] awaddr,
+                   output logic [7:0]  awlen,
+                   output logic [2:0]  awsize,
+                   output logic [1:0]  awburst,
+                   output logic        awvalid,
+                   input  logic        awready,
+                   output logic [31:0] wdata,
+                   output logic [3:0]  wstrb,
+                   output logic        wlast, wvalid,
+                   input  logic        wready,
+                   input  logic        bid,
+                   input  logic [1:0]  bresp,
+                   input  logic        bvalid,
+                   output logic        bready,
+                   // AXI4 read address, read data
+                   output logic        arid,
+                   output logic [31:0] araddr,
+                   output logic [7:0]  arlen,
+                   output logic [2:0]  arsize,
+                   output logic [1:0]  arburst,
+                   output logic        arvalid,
+                   input  logic        arready,
+                   input  logic        rid,
+                   input  logic [31:0] rdata,
+                   input  logic [1:0]  rresp,
+                   input  logic        rlast, rvalid,
+                   output logic        rready);
+
+  localparam WORDS   = LINE / 4;
+  localparam OFFBITS = $clog2(LINE);
+  localparam PTRBITS = $clog2(WBUF);
+
+  logic [31:0]        line;
+  logic [OFFBITS-1:0] word;
+  logic               rd, wr, rdready, wrready;
+  logic               ardemand, arsent, hazard;
+  logic               pfvalid, pfar, pfhit, pfbusy;
+  logic [31:0]        pfline;
+  logic [31:0]        pfdata[WORDS-1:0];
+  logic [7:0]         pfbeats;
+  logic [31:0]        wba[WBUF-1:0], wbd[WBUF-1:0];
+  logic [3:0]         wbbe[WBUF-1:0];
+  logic [7:0]         wblen[WBUF-1:0];
+  logic               wbvalid[WBUF-1:0];
+  logic [PTRBITS-1:0] tail, head, free;
+  logic [PTRBITS:0]   used, pending;
+  logic [7:0]         beat, wlen;
+  logic               awdone, push, wsend, full;
+
+  // all transfers are INCR bursts of 32-bit words
+  assign {awid, awsize, awburst} = {1'b0, 3'b010, 2'b01};
+  assign {arsize, arburst}       = {3'b010, 2'b01};
+
+  assign rd   = mreq & ~mwe;
+  assign wr   = mreq & mwe;
+  assign line = ma >> OFFBITS << OFFBITS;
+  assign word = ma[OFFBITS-1:2];
+
+  // Reads
+  // A line fill (the first word of a read, ~mburst) issues one burst
+  // with ID 0 and the cache takes the beats as they arrive. With
+  // PREFETCH every fill also requests the next line with ID 1 into a
+  // one-line stream buffer; a fill of that line is served from the
+  // buffer, without waiting for beats that have already arrived, and
+  // prefetches the line after it. Only for read-only (instruction)
+  // ports: the buffer is not kept coherent with writes.
+  assign pfhit    = PREFETCH & pfvalid & (pfline == line);
+  assign pfbusy   = pfvalid & ~pfar & (pfbeats != WORDS);
+  assign ardemand = rd & ~mburst & ~pfhit & ~arsent & ~hazard;
+
+  // the address channel is registered so it holds while ARVALID waits
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      arvalid <= 0;
+      arsent  <= 0;
+      pfvalid <= 0;
+      pfar    <= 0;
+      pfbeats <= 0;
+    end else begin
+      if (~arvalid | arready)
+        if (ardemand) begin
+          {arvalid, arid, araddr, arlen} <= {1'b1, 1'b0, line, mlen};
+          arsent <= 1;
+        end else if (pfar) begin
+          {arvalid, arid, araddr, arlen} <= {1'b1, 1'b1, pfline, 8'(WORDS-1)};
+          pfar   <= 0;
+        end else
+          arvalid <= 0;
+
+      // demand beats end with RLAST, prefetch beats fill the buffer
+      if (rvalid & rready & ~rid & rlast) arsent <= 0;
+      if (rvalid & rready & rid) begin
+        pfdata[pfbeats] <= rdata;
+        pfbeats <= pfbeats + 1;
+      end
 
-  logic [31:0] RAM[63:0];
+      // arm the next prefetch when a fill starts from memory (unless
+      // an older prefetch is still arriving) or finishes from the
+      // buffer
+      if (PREFETCH)
+        if (ardemand & (~arvalid | arready) & ~pfbusy) begin
+          pfline  <= line + LINE;
+          pfvalid <= 1;
+          pfar    <= 1;
+          pfbeats <= 0;
+        end else if (pfhit & mready & (word == WORDS - 1)) begin
+          pfline  <= pfline + LINE;
+          pfar    <= 1;
+          pfbeats <= 0;
+        end
+    end
+
+  assign rready  = rid | rd;
+  assign rdready = pfhit ? rd & (pfbeats > word) : rd & rvalid & ~rid;
+  assign mrd     = pfhit ? pfdata[word] : rdata;
+
+  // Writes
+  // Stores and dirty lines go into a write buffer of WBUF words and
+  // the cache goes on at once; a burst's words stay in the buffer
+  // until its write response arrives. A fill waits while the buffer
+  // holds a word of the same line, since AXI does not order reads
+  // after writes. WBUF must be a power of two and at least LINE/4.
+  assign full    = (used == WBUF);
+  assign push    = wr & ~full;
+  assign wrready = push;
+  assign wsend   = wvalid & wready;
+
+  always_comb begin
+    hazard = 0;
+    for (int i = 0; i < WBUF; i++)
+      if (wbvalid[i] & ((wba[i] >> OFFBITS) == (ma >> OFFBITS)))
+        hazard = 1;
+  end
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      {tail, head, free} <= 0;
+      {used, pending}    <= 0;
+      {awdone, beat}     <= 0;
+      for (int i = 0; i < WBUF; i++) wbvalid[i] <= 0;
+    end else begin
+      if (push) begin
+        wba[tail]   <= ma;
+        wbd[tail]   <= mwd;
+        wbbe[tail]  <= mbe;
+        wblen[tail] <= mlen;
+        wbvalid[tail] <= 1;
+        tail <= tail + 1;
+      end
+      // one address per burst, then its words in order
+      if (awvalid & awready) begin
+        awdone <= 1;
+        wlen   <= awlen;
+      end
+      if (wsend) begin
+        head <= head + 1;
+        beat <= wlast ? 0 : beat + 1;
+        if (wlast) awdone <= 0;
+      end
+      // a response frees the oldest burst
+      if (bvalid) begin
+        for (int k = 0; k < WBUF; k++)
+          if (k <= wblen[free]) wbvalid[(free + k) % WBUF] <= 0;
+        free <= free + wblen[free] + 1;
+      end
+      used    <= used + push - (bvalid ? wblen[free] + 1 : 0);
+      pending <= pending + push - wsend;
+    end
+
+  assign awvalid = ~awdone & (pending != 0);
+  assign awaddr  = wba[head];
+  assign awlen   = wblen[head];
+  assign wvalid  = awdone & (pending != 0);
+  assign wdata   = wbd[head];
+  assign wstrb   = wbbe[head];
+  assign wlast   = (beat == wlen);
+  assign bready  = 1;
+
+  assign mready = rdready | wrready;
+
+  // events: fills served by the prefetch buffer, stores held by a full
+  // write buffer
+  assign Events = {pfhit & rd & ~mburst & mready, wr & full};
+endmodule
+
+module axi_mem #(parameter BASE = 32'h0, BYTES = 256, LATENCY = 4,
+                 parameter PORTS = 2, DEPTH = 4)
+               (input  logic        clk, reset,
+                input  logic        awid[PORTS],
+                input  logic [31:0] awaddr[PORTS],
+                input  logic [7:0]  awlen[PORTS],
+                input  logic [2:0]  awsize[PORTS],
+                input  logic [1:0]  awburst[PORTS],
+                input  logic        awvalid[PORTS],
+                output logic        awready[PORTS],
+                input  logic [31:0] wdata[PORTS],
+                input  logic [3:0]  wstrb[PORTS],
+                input  logic        wlast[PORTS], wvalid[PORTS],
+                output logic        wready[PORTS],
+                output logic        bid[PORTS],
+                output logic [1:0]  bresp[PORTS],
+                output logic        bvalid[PORTS],
+                input  logic        bready[PORTS],
+                input  logic        arid[PORTS],
+                input  logic [31:0] araddr[PORTS],
+                input  logic [7:0]  arlen[PORTS],
+                input  logic [2:0]  arsize[PORTS],
+                input  logic [1:0]  arburst[PORTS],
+                input  logic        arvalid[PORTS],
+                output logic        arready[PORTS],
+                output logic        rid[PORTS],
+                output logic [31:0] rdata[PORTS],
+                output logic [1:0]  rresp[PORTS],
+                output logic        rlast[PORTS], rvalid[PORTS],
+                input  logic        rready[PORTS]);
+
+  // Simulation model of an AXI4 memory with PORTS slave ports on one
+  // RAM. Each port queues up to DEPTH read bursts and DEPTH write
+  // bursts. A read burst's first word is ready LATENCY cycles after
+  // its address was accepted, the others follow one per cycle, so
+  // outstanding reads overlap their latency. A write burst takes one
+  // word per cycle after its address and responds LATENCY cycles
+  // after its last word. Bursts are INCR of 32-bit words; AxSIZE and
+  // AxBURST are not checked.
+
+  localparam ADRBITS = $clog2(BYTES);
+  localparam QBITS   = $clog2(DEPTH);
+
+  logic [31:0]      RAM[BYTES/4-1:0];
+  logic [31:0]      now;
+  // read queue
+  logic [31:0]      ra[PORTS][DEPTH], rat[PORTS][DEPTH];
+  logic [7:0]       rlen[PORTS][DEPTH], rbeat[PORTS];
+  logic             rqid[PORTS][DEPTH];
+  logic [QBITS:0]   rcount[PORTS];
+  logic [QBITS-1:0] rhead[PORTS], rtail[PORTS];
+  // write address and response queues
+  logic [31:0]      wa[PORTS][DEPTH], bt[PORTS][DEPTH];
+  logic             wqid[PORTS][DEPTH], bqid[PORTS][DEPTH];
+  logic [7:0]       wbeat[PORTS];
+  logic [QBITS:0]   wcount[PORTS], bcount[PORTS];
+  logic [QBITS-1:0] whead[PORTS], wtail[PORTS], bhead[PORTS], btail[PORTS];
+
+`ifdef MEMLOAD_DPI
+`include "memload.svh"
+`endif
 
   initial
+`ifdef MEMLOAD_DPI
+    if (!loadimage())
+`endif
       $readmemh("memfile.dat",RAM);
 
-  assign rd = RAM[a[31:2]]; // word aligned
+  function automatic logic [ADRBITS-3:0] index(input logic [31:0] a);
+    logic [31:0] offset;
+    offset = a - BASE;
+    return offset[ADRBITS-1:2];
+  endfunction
+
+  always_comb
+    for (int p = 0; p < PORTS; p++) begin
+      arready[p] = (rcount[p] != DEPTH);
+      rvalid[p]  = (rcount[p] != 0) & (now >= rat[p][rhead[p]]);
+      rid[p]     = rqid[p][rhead[p]];
+      rdata[p]   = RAM[index(ra[p][rhead[p]] + 4 * rbeat[p])];
+      rlast[p]   = (rbeat[p] == rlen[p][rhead[p]]);
+      rresp[p]   = 2'b00;
+      awready[p] = (wcount[p] != DEPTH);
+      wready[p]  = (wcount[p] != 0) & (bcount[p] != DEPTH);
+      bvalid[p]  = (bcount[p] != 0) & (now >= bt[p][bhead[p]]);
+      bid[p]     = bqid[p][bhead[p]];
+      bresp[p]   = 2'b00;
+    end
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      now <= 0;
+      for (int p = 0; p < PORTS; p++) begin
+        {rcount[p], rhead[p], rtail[p], rbeat[p]} <= 0;
+        {wcount[p], whead[p], wtail[p], wbeat[p]} <= 0;
+        {bcount[p], bhead[p], btail[p]} <= 0;
+      end
+    end else begin
+      now <= now + 1;
+      for (int p = 0; p < PORTS; p++) begin
+        // read bursts
+        if (arvalid[p] & arready[p]) begin
+          ra[p][rtail[p]]   <= araddr[p];
+          rlen[p][rtail[p]] <= arlen[p];
+          rqid[p][rtail[p]] <= arid[p];
+          rat[p][rtail[p]]  <= now + LATENCY;
+          rtail[p] <= rtail[p] + 1;
+        end
+        if (rvalid[p] & rready[p]) begin
+          rbeat[p] <= rlast[p] ? 0 : rbeat[p] + 1;
+          if (rlast[p]) rhead[p] <= rhead[p] + 1;
+        end
+        rcount[p] <= rcount[p] + (arvalid[p] & arready[p])
+                               - (rvalid[p] & rready[p] & rlast[p]);
+
+        // write bursts
+        if (awvalid[p] & awready[p]) begin
+          wa[p][wtail[p]]   <= awaddr[p];
+          wqid[p][wtail[p]] <= awid[p];
+          wtail[p] <= wtail[p] + 1;
+        end
+        if (wvalid[p] & wready[p]) begin
+          for (int i = 0; i < 4; i++)
+            if (wstrb[p][i])
+              RAM[index(wa[p][whead[p]] + 4 * wbeat[p])][8*i +: 8]
+                <= wdata[p][8*i +: 8];
+          wbeat[p] <= wlast[p] ? 0 : wbeat[p] + 1;
+          if (wlast[p]) begin
+            whead[p] <= whead[p] + 1;
+            bt[p][btail[p]]   <= now + LATENCY;
+            bqid[p][btail[p]] <= wqid[p][whead[p]];
+            btail[p] <= btail[p] + 1;
+          end
+        end
+        if (bvalid[p] & bready[p]) bhead[p] <= bhead[p] + 1;
+        wcount[p] <= wcount[p] + (awvalid[p] & awready[p])
+                               - (wvalid[p] & wready[p] & wlast[p]);
+        bcount[p] <= bcount[p] + (wvalid[p] & wready[p] & wlast[p])
+                               - (bvalid[p] & bready[p]);
+      end
+    end
+endmodule
+
+module scu_timer(input  logic        clk, reset, we,
+                 input  logic [7:0]  a,
+                 input  logic [31:0] wd,
+                 output logic [31:0] rd,
+                 output logic        irq);
+
+  // Cortex-A9 private timer: 32-bit down counter with prescaler and
+  // auto reload
+  logic [31:0] Load, Counter;
+  logic [15:0] Control;
+  logic [7:0]  PreCount;
+  logic        Event, Tick;
+
+  assign Tick = Control[0] & (PreCount == Control[15:8]);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      {Load, Counter, Control, PreCount, Event} <= 0;
+    end else begin
+      if (Control[0]) PreCount <= Tick ? 8'b0 : PreCount + 1;
+      if (we & (a[3:2] == 2'b00)) begin
+        Load     <= wd;
+        Counter  <= wd;
+        PreCount <= 0;
+      end else if (Tick)
+        if (Counter != 0) begin
+          Counter <= Counter - 1;
+          if (Counter == 1) Event <= 1;
+        end else if (Control[1]) Counter <= Load;
+      if (we & (a[3:2] == 2'b10)) Control <= wd[15:0];
+      if (we & (a[3:2] == 2'b11) & wd[0]) Event <= 0;
+    end
+
+  always_comb
+    case(a[3:2])
+      2'b00: rd = Load;
+      2'b01: rd = Counter;
+      2'b10: rd = {16'b0, Control};
+      2'b11: rd = {31'b0, Event};
+    endcase
+
+  assign irq = Event & Control[2];
+endmodule
+
+module ttc(input  logic        clk, reset, we, re,
+           input  logic [7:0]  a,
+           input  logic [31:0] wd,
+           output logic [31:0] rd,
+           output logic [2:0]  irq, wave);
+
+  // triple timer counter: three 16-bit counters with prescaler,
+  // interval and match registers, each driving a waveform output
+  logic [4:0]  ClkCtrl[3];
+  logic [6:0]  CntCtrl[3];
+  logic [15:0] Value[3], Interval[3], Match[3], PreCount[3];
+  logic [5:0]  Isr[3], Ier[3];
+  logic [1:0]  n;
+  logic [5:0]  r;
+  logic        Tick[3];
+
+  // register r (offset / 12) of counter n (offset / 4 mod 3)
+  assign r = a[7:2] / 3;
+  assign n = a[7:2] % 3;
+
+  always_comb
+    for (int i = 0; i < 3; i++) begin
+      Tick[i] = ~CntCtrl[i][0] &
+                (~ClkCtrl[i][0] |
+                 (PreCount[i] == (16'hFFFF >> (15 - ClkCtrl[i][4:1]))));
+      irq[i]  = |(Isr[i] & Ier[i]);
+      wave[i] = ~CntCtrl[i][5] & ((Value[i] < Match[i]) ^ CntCtrl[i][6]);
+    end
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      for (int i = 0; i < 3; i++) begin
+        ClkCtrl[i]  <= 0;
+        CntCtrl[i]  <= 7'h21;
+        {Value[i], Interval[i], Match[i], PreCount[i]} <= 0;
+        {Isr[i], Ier[i]} <= 0;
+      end
+    end else begin
+      // reading ISR clears it (an event in the same cycle stays)
+      if (re & (r == 7)) Isr[n] <= 0;
+      for (int i = 0; i < 3; i++) begin
+        if (~CntCtrl[i][0])
+          PreCount[i] <= Tick[i] ? 16'b0 : PreCount[i] + 1;
+        if (Tick[i]) begin
+          // interval mode counts between 0 and INTERVAL, overflow
+          // mode wraps
+          if (CntCtrl[i][1] &
+              (Value[i] == (CntCtrl[i][2] ? 16'b0 : Interval[i]))) begin
+            Value[i]  <= CntCtrl[i][2] ? Interval[i] : 16'b0;
+            Isr[i][0] <= 1;
+          end else begin
+            Value[i] <= CntCtrl[i][2] ? Value[i] - 1 : Value[i] + 1;
+            if (~CntCtrl[i][1] &
+                (Value[i] == (CntCtrl[i][2] ? 16'h0000 : 16'hFFFF)))
+              Isr[i][4] <= 1;
+          end
+          if (CntCtrl[i][3] & (Value[i] == Match[i])) Isr[i][1] <= 1;
+        end
+      end
+      if (we)
+        case(r)
+          0: ClkCtrl[n]  <= wd[4:0];
+          1: begin
+               CntCtrl[n] <= {wd[6:5], 1'b0, wd[3:0]};
+               if (wd[4]) begin
+                 Value[n]    <= wd[2] ? Interval[n] : 16'b0;
+                 PreCount[n] <= 0;
+               end
+             end
+          3: Interval[n] <= wd[15:0];
+          4: Match[n]    <= wd[15:0];
+          8: Ier[n]      <= wd[5:0];
+        endcase
+    end
+
+  always_comb
+    case(r)
+      0:       rd = {27'b0, ClkCtrl[n]};
+      1:       rd = {25'b0, CntCtrl[n]};
+      2:       rd = {16'b0, Value[n]};
+      3:       rd = {16'b0, Interval[n]};
+      4:       rd = {16'b0, Match[n]};
+      7:       rd = {26'b0, Isr[n]};
+      8:       rd = {26'b0, Ier[n]};
+      default: rd = 32'b0;
+    endcase
+endmodule
+
+module gpio #(parameter WIDTH = 8)
+            (input  logic             clk, reset, we,
+             input  logic [8:0]       a,
+             input  logic [31:0]      wd,
+             output logic [31:0]      rd,
+             output logic             irq,
+             input  logic [WIDTH-1:0] gpio_i,
+             output logic [WIDTH-1:0] gpio_o,
+             input  logic [WIDTH-1:0] gpio2_i,
+             output logic [WIDTH-1:0] gpio2_o);
+
+  // dual-channel GPIO with the AXI GPIO register layout; an interrupt
+  // flags any change on an input of a channel
+  logic [WIDTH-1:0] Data, Tri, Data2, Tri2, In, In2;
+  logic [1:0]       Isr, Ier;
+  logic             Gier;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      {Data, Data2, Isr, Ier, Gier} <= 0;
+      Tri  <= '1;
+      Tri2 <= '1;
+      In   <= 0;
+      In2  <= 0;
+    end else begin
+      In  <= gpio_i;
+      In2 <= gpio2_i;
+      if (|((gpio_i  ^ In)  & Tri))  Isr[0] <= 1;
+      if (|((gpio2_i ^ In2) & Tri2)) Isr[1] <= 1;
+      if (we)
+        case(a)
+          9'h000: Data  <= wd[WIDTH-1:0];
+          9'h004: Tri   <= wd[WIDTH-1:0];
+          9'h008: Data2 <= wd[WIDTH-1:0];
+          9'h00C: Tri2  <= wd[WIDTH-1:0];
+          9'h11C: Gier  <= wd[31];
+          9'h120: Isr   <= Isr ^ wd[1:0];
+          9'h128: Ier   <= wd[1:0];
+          default: ;
+        endcase
+    end
+
+  assign gpio_o  = Data  & ~Tri;
+  assign gpio2_o = Data2 & ~Tri2;
+
+  always_comb
+    case(a)
+      9'h000:  rd = (gpio_i  & Tri)  | (Data  & ~Tri);
+      9'h004:  rd = Tri;
+      9'h008:  rd = (gpio2_i & Tri2) | (Data2 & ~Tri2);
+      9'h00C:  rd = Tri2;
+      9'h11C:  rd = {Gier, 31'b0};
+      9'h120:  rd = {30'b0, Isr};
+      9'h128:  rd = {30'b0, Ier};
+      default: rd = 32'b0;
+    endcase
+
+  assign irq = Gier & |(Isr & Ier);
+endmodule
+
+module cache #(parameter SIZE = 128, LINE = 16, WAYS = 1,
+               parameter WRITEBACK = 1, WALLOC = 1)
+             (input  logic        clk, reset,
+              // processor side
+              input  logic        req, we,
+              input  logic [3:0]  be,
+              input  logic [31:0] a, wd,
+              output logic [31:0] rd,
+              output logic        ready,
+              output logic [2:0]  Events,
+              // memory side
+              output logic        mreq, mwe, mburst,
+              output logic [7:0]  mlen,
+              output logic [3:0]  mbe,
+              output logic [31:0] ma, mwd,
+              input  logic [31:0] mrd,
+              input  logic        mready);
+
+  localparam WORDS   = LINE / 4;
+  localparam SETS    = SIZE / (LINE * WAYS);
+  localparam OFFBITS = $clog2(LINE);
+  localparam IDXBITS = $clog2(SETS);
+  localparam TAGBITS = 32 - OFFBITS - IDXBITS;
+  localparam WAYBITS = (WAYS  > 1) ? $clog2(WAYS)  : 1;
+  localparam CNTBITS = (WORDS > 1) ? $clog2(WORDS) : 1;
+
+  typedef enum logic [1:0] {IDLE, WBACK, FILL, WRMEM} statetype;
+
+  statetype             state, nextstate;
+  logic [31:0]          data[SETS-1:0][WAYS-1:0][WORDS-1:0];
+  logic [TAGBITS-1:0]   tags[SETS-1:0][WAYS-1:0];
+  logic                 valid[SETS-1:0][WAYS-1:0];
+  logic                 dirty[SETS-1:0][WAYS-1:0];
+  logic [WAYBITS-1:0]   victims[SETS-1:0];
+  logic [TAGBITS-1:0]   tag;
+  logic [31:0]          set, word;
+  logic [WAYBITS-1:0]   hitway, victim;
+  logic [CNTBITS-1:0]   count;
+  logic                 hit, missed, last;
+  logic                 Hit, Miss, Wback;
+
+  // address fields
+  assign tag    = a[31:OFFBITS+IDXBITS];
+  assign set    = (a >> OFFBITS) % SETS;
+  assign word   = (a >> 2) % WORDS;
+  assign victim = victims[set];
+  assign last   = (count == WORDS - 1);
+
+  // tag compare across the ways of the set
+  always_comb begin
+    hit = 0; hitway = 0;
+    for (int w = 0; w < WAYS; w++)
+      if (valid[set][w] & (tags[set][w] == tag)) begin
+        hit = 1; hitway = w;
+      end
+  end
+
+  assign rd = data[set][hitway][word];
 
-  always_ff @(posedge clk)
-    if (we) RAM[a[31:2]] <= wd;
+  // state register and line storage
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      state  <= IDLE;
+      count  <= 0;
+      missed <= 0;
+      for (int s = 0; s < SETS; s++) begin
+        victims[s] <= 0;
+        for (int w = 0; w < WAYS; w++) begin
+          valid[s][w] <= 0;
+          dirty[s][w] <= 0;
+        end
+      end
+    end else begin
+      state <= nextstate;
+      if (Miss)  missed <= 1;
+      if (ready) missed <= 0;
+      case(state)
+        // write-back store hit: update the line only
+        IDLE:  if (req & we & hit & WRITEBACK) begin
+                 for (int i = 0; i < 4; i++)
+                   if (be[i]) data[set][hitway][word][8*i +: 8] <= wd[8*i +: 8];
+                 dirty[set][hitway] <= 1;
+               end
+        WBACK: if (mready) begin
+                 count <= last ? 0 : count + 1;
+                 if (last) dirty[set][victim] <= 0;
+               end
+        FILL:  if (mready) begin
+                 data[set][victim][count] <= mrd;
+                 count <= last ? 0 : count + 1;
+                 if (last) begin
+                   tags[set][victim]  <= tag;
+                   valid[set][victim] <= 1;
+                   victims[set] <= (victim == WAYS - 1) ? 0 : victim + 1;
+                 end
+               end
+        // write-through store: keep a hit line up to date
+        WRMEM: if (mready & hit)
+                 for (int i = 0; i < 4; i++)
+                   if (be[i]) data[set][hitway][word][8*i +: 8] <= wd[8*i +: 8];
+      endcase
+    end
+
+  // next state logic
+  always_comb
+    case(state)
+      IDLE:    if (~req)                         nextstate = IDLE;
+               else if (hit)
+                 if (we & ~WRITEBACK)            nextstate = WRMEM;
+                 else                            nextstate = IDLE;
+               else if (we & ~WALLOC)            nextstate = WRMEM;
+               else if (valid[set][victim] & dirty[set][victim])
+                                                 nextstate = WBACK;
+               else                              nextstate = FILL;
+      WBACK:   if (mready & last)                nextstate = FILL;
+               else                              nextstate = WBACK;
+      FILL:    if (mready & last)                nextstate = IDLE;
+               else                              nextstate = FILL;
+      WRMEM:   if (mready)                       nextstate = IDLE;
+               else                              nextstate = WRMEM;
+      default:                                   nextstate = IDLE;
+    endcase
+
+  // processor handshake: hits finish in IDLE, memory writes in WRMEM;
+  // after a fill the access is retried and hits
+  always_comb
+    case(state)
+      IDLE:    ready = req & hit & (~we | WRITEBACK);
+      WRMEM:   ready = mready;
+      default: ready = 0;
+    endcase
+
+  // memory side
+  // line transfers are bursts of WORDS words: mlen (words - 1) comes
+  // with the first word, mburst marks the ones that follow
+  always_comb begin
+    mreq   = (state != IDLE);
+    mwe    = (state == WBACK) | (state == WRMEM);
+    mburst = (count != 0);
+    mlen   = (state == WRMEM) ? 8'd0 : WORDS - 1;
+    case(state)
+      WBACK:   ma = (tags[set][victim] << (OFFBITS + IDXBITS)) |
+                    (set << OFFBITS) | (count << 2);
+      FILL:    ma = (a >> OFFBITS << OFFBITS) | (count << 2);
+      default: ma = a;
+    endcase
+    mwd = (state == WBACK) ? data[set][victim][count] : wd;
+    mbe = (state == WBACK) ? 4'b1111 : be;
+  end
+
+  // events for the performance monitoring unit
+  assign Hit    = ready & ~missed;
+  assign Miss   = (state == IDLE) & req & ~hit;
+  assign Wback  = Miss & (nextstate == WBACK);
+  assign Events = {Hit, Miss, Wback};
 endmodule
 
-module arm(input  logic        clk, reset,
+module arm #(parameter FAST = 0, HARVARD = 0, FIQ_BANK = 1)
+           (input  logic        clk, reset,
+           input  logic        Irq, Fiq,
            output logic        MemWrite,
            output logic [31:0] Adr, WriteData,
-           input  logic [31:0] ReadData);
+           output logic [3:0]  ByteEn,
+           input  logic [31:0] ReadData,
+           output logic [31:0] IAdr,
+           input  logic [31:0] IReadData,
+           output logic [6:0]  Events,
+           output logic [3:0]  State,
+           output logic        IFetch, MemRead, Lock,
+           input  logic        Stall);
 
-  logic [31:0] Instr;
+  logic [31:0] Instr, ALUResult, Psr;
+  logic [4:0]  Mode;
+  logic        Exc, ExcFiq, PsrRead, SwpOp;
   logic [3:0]  ALUFlags;
   logic        PCWrite, RegWrite, IRWrite;
-  logic        AdrSrc;
+  logic        AdrSrc, PCInc, MovOp, ByteOp;
+  logic        MulOp, MulStart, MulEn, MulWr, MulDone;
+  logic        LsmOp, LsmStart, LsmBase, LsmNext, LsmXfer;
+  logic        LsmPC, LsmLast, LsmEmpty;
   logic [1:0]  RegSrc, ALUSrcA, ALUSrcB, ImmSrc, ALUControl, ResultSrc;
+  logic [1:0]  MulCtrl;
 
-  controller c(clk, reset, Instr[31:12], ALUFlags, 
+  controller #(FAST, HARVARD) c(clk, reset, Instr[31:4], ALUFlags,
                PCWrite, MemWrite, RegWrite, IRWrite,
-               AdrSrc, RegSrc, ALUSrcA, ALUSrcB, ResultSrc,
-               ImmSrc, ALUControl);
-  datapath dp(clk, reset, Adr, WriteData, ReadData, Instr, ALUFlags,
+               AdrSrc, PCInc, RegSrc, ALUSrcA, ALUSrcB, ResultSrc,
+               ImmSrc, ALUControl, MovOp, ByteOp,
+               MulDone, MulOp, MulStart, MulEn, MulWr, MulCtrl,
+               LsmPC, LsmLast, LsmEmpty,
+               LsmOp, LsmStart, LsmBase, LsmNext, LsmXfer,
+               Irq, Fiq, ALUResult, Mode, Exc, ExcFiq, PsrRead, Psr,
+               SwpOp, Lock, Events, State, IFetch, MemRead, Stall);
+  datapath #(FAST, HARVARD, FIQ_BANK)
+            dp(clk, reset, Adr, WriteData, ReadData,
+              IAdr, IReadData, Instr, ALUFlags,
               PCWrite, RegWrite, IRWrite,
-              AdrSrc, RegSrc, ALUSrcA, ALUSrcB, ResultSrc,
-              ImmSrc, ALUControl);
+              AdrSrc, PCInc, RegSrc, ALUSrcA, ALUSrcB, ResultSrc,
+              ImmSrc, ALUControl, MovOp, ByteOp, ByteEn,
+              MulOp, MulStart, MulEn, MulWr, MulCtrl, MulDone,
+              LsmOp, LsmStart, LsmBase, LsmNext, LsmXfer,
+              LsmPC, LsmLast, LsmEmpty,
+              ALUResult, Mode, Exc, ExcFiq, PsrRead, Psr, SwpOp, Stall);
 endmodule
 
-module controller(input  logic         clk,
+module controller #(parameter FAST = 0, HARVARD = 0)
+                 (input  logic         clk,
                   input  logic         reset,
-                  input  logic [31:12] Instr,
+                  input  logic [31:4]  Instr,
                   input  logic [3:0]   ALUFlags,
                   output logic         PCWrite,
                   output logic         MemWrite,
                   output logic         RegWrite,
                   output logic         IRWrite,
-                  output logic         AdrSrc,
+                  output logic         AdrSrc, PCInc,
                   output logic [1:0]   RegSrc,
                   output logic [1:0]   ALUSrcA,
                   output logic [1:0]   ALUSrcB,
                   output logic [1:0]   ResultSrc,
                   output logic [1:0]   ImmSrc,
-                  output logic [1:0]   ALUControl);
+                  output logic [1:0]   ALUControl,
+                  output logic         MovOp, ByteOp,
+                  input  logic         MulDone,
+                  output logic         MulOp, MulStart, MulEn, MulWr,
+                  output logic [1:0]   MulCtrl,
+                  input  logic         LsmPC, LsmLast, LsmEmpty,
+                  output logic         LsmOp, LsmStart, LsmBase, LsmNext,
+                  output logic         LsmXfer,
+                  input  logic         Irq, Fiq,
+                  input  logic [31:0]  ALUResult,
+                  output logic [4:0]   Mode,
+                  output logic         Exc, ExcFiq, PsrRead,
+                  output logic [31:0]  Psr,
+                  output logic         SwpOp, Lock,
+                  output logic [6:0]   Events,
+                  output logic [3:0]   State,
+                  output logic         IFetch, MemRead,
+                  input  logic         Stall);
                   
   logic [1:0] FlagW;
-  logic       PCS, NextPC, RegW, MemW;
+  logic       PCS, NextPC, RegW, MemW, MemR, CondEx, IsMul, IsSwp, Decoded;
+  logic       MsrW, DpOp, Restore, FlagLoad, I, F, IntTake, FiqTake;
+  logic [3:0] Flags, FlagsIn, FlagsPend;
   
-  decode dec(clk, reset, Instr[27:26], Instr[25:20], Instr[15:12],
+  // multiplies and swaps share Op = 00 with data processing
+  assign IsMul = (Instr[27:24] == 4'b0000) & (Instr[7:4] == 4'b1001);
+  assign IsSwp = (Instr[27:23] == 5'b00010) & (Instr[21:20] == 2'b00) &
+                 (Instr[11:4] == 8'b00001001);
+
+  decode #(FAST, HARVARD) dec(clk, reset,
+             Instr[27:26], Instr[25:20], Instr[15:12],
+             IsMul, IsSwp, MulDone,
              FlagW, PCS, NextPC, RegW, MemW,
-             IRWrite, AdrSrc, ResultSrc, 
-             ALUSrcA, ALUSrcB, ImmSrc, RegSrc, ALUControl);
-  condlogic cl(clk, reset, Instr[31:28], ALUFlags,
+             IRWrite, AdrSrc, PCInc, ResultSrc,
+             ALUSrcA, ALUSrcB, ImmSrc, RegSrc, ALUControl, MovOp, ByteOp,
+             MulOp, MulStart, MulEn, MulWr, MulCtrl,
+             LsmPC, LsmLast, LsmEmpty,
+             LsmOp, LsmStart, LsmBase, LsmNext, LsmXfer,
+             IntTake, FiqTake, Exc, ExcFiq, DpOp, PsrRead, MsrW,
+             SwpOp, Lock, State, IFetch, MemR, Stall);
+  // EXCEPT writes LR whatever the condition of the last instruction
+  condlogic cl(clk, reset, Exc ? 4'b1110 : Instr[31:28], ALUFlags,
                FlagW, PCS, NextPC, RegW, MemW,
-               PCWrite, RegWrite, MemWrite);
+               PCWrite, RegWrite, MemWrite, CondEx,
+               FlagLoad, FlagsIn, Flags, FlagsPend, Stall);
+
+  // reads are conditional too: a load that fails its condition must
+  // not pop a FIFO or clear a read-to-clear flag on the I/O page
+  assign MemRead = MemR & CondEx;
+
+  // status registers
+  // a data-processing instruction with S that writes R15 restores
+  // the CPSR from the SPSR (exception return)
+  assign Restore = RegWrite & DpOp & Instr[20] & (Instr[15:12] == 4'b1111) &
+                   ~Exc;
+  psr ps(clk, reset, Exc, ExcFiq, Restore, MsrW & CondEx, Instr[22],
+         Instr[19:16], ALUResult, Flags, FlagsPend, FlagLoad, FlagsIn,
+         Psr, Mode, I, F);
+
+  // interrupt requests are taken between instructions, FIQ first
+  assign FiqTake = Fiq & ~F;
+  assign IntTake = FiqTake | (Irq & ~I);
+
+  // events for the performance monitoring unit
+  // one instruction is fetched per instruction retired; the condition
+  // is sampled the cycle after DECODE (a flag write delayed from the
+  // previous instruction can land in DECODE), loads write back the
+  // Data register
+  flopr #(1) decodedreg(clk, reset, State == 4'd1, Decoded);
+  assign Events = {IntTake, Exc, IRWrite, PCWrite & ~NextPC,
+                   Decoded & ~CondEx,
+                   RegWrite & (ResultSrc == 2'b01), MemWrite};
 endmodule
 
-module decode(input  logic       clk, reset,
+module decode #(parameter FAST = 0, HARVARD = 0)
+             (input  logic       clk, reset,
               input  logic [1:0] Op,
               input  logic [5:0] Funct,
               input  logic [3:0] Rd,
+              input  logic       IsMul, IsSwp, MulDone,
               output logic [1:0] FlagW,
               output logic       PCS, NextPC, RegW, MemW,
-              output logic       IRWrite, AdrSrc,
+              output logic       IRWrite, AdrSrc, PCInc,
               output logic [1:0] ResultSrc, ALUSrcA, ALUSrcB, 
-              output logic [1:0] ImmSrc, RegSrc, ALUControl);
+              output logic [1:0] ImmSrc, RegSrc, ALUControl,
+              output logic       MovOp, ByteOp,
+              output logic       MulOp, MulStart, MulEn, MulWr,
+              output logic [1:0] MulCtrl,
+              input  logic       LsmPC, LsmLast, LsmEmpty,
+              output logic       LsmOp, LsmStart, LsmBase, LsmNext,
+              output logic       LsmXfer,
+              input  logic       IntTake, FiqTake,
+              output logic       Exc, ExcFiq, DpOp, PsrRead, MsrW,
+              output logic       SwpOp, Lock,
+              output logic [3:0] State,
+              output logic       IFetch, MemRead,
+              input  logic       Stall);
 
-  logic       Branch, ALUOp;
+  logic       Branch, ALUOp, RdPC, RegWs, PsrOp, MsrOp;
 
   // Main FSM
-  mainfsm fsm(clk, reset, Op, Funct, 
-              IRWrite, AdrSrc, 
+  mainfsm #(FAST, HARVARD) fsm(clk, reset, Op, Funct, IsMul, SwpOp,
+              MulDone,
+              RdPC, LsmLast, LsmEmpty,
+              IRWrite, AdrSrc, PCInc,
               ALUSrcA, ALUSrcB, ResultSrc,
-              NextPC, RegW, MemW, Branch, ALUOp);
+              NextPC, RegWs, MemW, Branch, ALUOp,
+              MulStart, MulEn, MulWr,
+              LsmStart, LsmBase, LsmNext, LsmXfer,
+              IntTake, FiqTake, Exc, ExcFiq, Lock,
+              State, IFetch, MemRead, Stall);
 
-  // ADD CODE BELOW
-  // Add code for the ALU Decoder and PC Logic.
-  // Remember, you may reuse code from previous labs.
   // ALU Decoder
+  always_comb
+    if (ALUOp) begin                 // which DP Instr?
+      case(Funct[4:1])
+  	    4'b0100: ALUControl = 2'b00; // ADD
+  	    4'b0010: ALUControl = 2'b01; // SUB
+        4'b0000: ALUControl = 2'b10; // AND
+  	    4'b1100: ALUControl = 2'b11; // ORR
+  	    4'b1101: ALUControl = 2'b11; // MOV (ORR with SrcA = 0)
+  	    default: ALUControl = PsrOp ? 2'b11 : 2'bx;  // MRS/MSR as MOV
+      endcase
+      MovOp         = (Funct[4:1] == 4'b1101) | PsrOp;
+      // update flags if S bit is set
+	// (C & V only updated for arith instructions)
+      // with Rd = R15, S restores the CPSR instead
+      FlagW[1]      = Funct[0] & (Rd != 4'b1111); // FlagW[1] = S-bit
+	// FlagW[0] = S-bit & (ADD | SUB)
+      FlagW[0]      = FlagW[1] &
+        (ALUControl == 2'b00 | ALUControl == 2'b01);
+    end else begin
+      ALUControl = 2'b00; // add for non-DP instructions
+      MovOp      = 1'b0;
+      // multiplies with S update N and Z in MULWB
+      FlagW      = {MulWr & Funct[0], 1'b0};
+    end
 
-  // PC Logic
+  // Multiply Decoder
+  // MulCtrl = {long (UMULL), accumulate (MLA)}
+  assign MulOp   = (Op == 2'b00) & ~Funct[5] & IsMul;
+  assign MulCtrl = {Funct[3], Funct[1]};
+
+  // SWP/SWPB (Funct[2] = B)
+  assign SwpOp   = (Op == 2'b00) & IsSwp;
 
+  // LDRB/STRB
+  assign ByteOp  = ((Op == 2'b01) | SwpOp) & Funct[2];
 
-  // Add code for the Instruction Decoder (Instr Decoder) below.
-  // Recall that the input to Instr Decoder is Op, and the outputs are
-  // ImmSrc and RegSrc. We've completed the ImmSrc logic for you.
+  // MRS/MSR take the TST/TEQ/CMP/CMN encodings without S and run as
+  // MOV: MRS moves the PSR in place of the register operand to Rd,
+  // MSR moves its operand to the PSR at the end of EXECUTER/EXECUTEI
+  // instead of writing Rd (which reads 1111). EXCEPT runs with the
+  // previous instruction still in the IR, so its LR write is not
+  // masked when that was an MSR
+  assign PsrOp   = (Op == 2'b00) & ~IsMul & ~IsSwp &
+                   (Funct[4:3] == 2'b10) & ~Funct[0];
+  assign MsrOp   = PsrOp & Funct[1];
+  assign DpOp    = (Op == 2'b00) & ~IsMul & ~IsSwp & ~PsrOp;
+  assign PsrRead = PsrOp & ~Funct[1] & ALUOp;
+  assign MsrW    = MsrOp & ALUOp & ~Stall;
+  assign RegW    = RegWs & ~(MsrOp & ~Exc);
+
+  // LDM/STM share Op = 10 with B
+  assign LsmOp   = (Op == 2'b10) & ~Funct[5];
+
+  // PC Logic
+  // (multiplies write Instr[19:16], never the PC; LDM writes the PC
+  //  when it loads R15, the last register of the list)
+  // RdPC: the instruction may write the PC (Instr[15] is the R15 bit
+  // of a register list)
+  assign RdPC = LsmOp ? Rd[3] : ((Rd == 4'b1111) & ~MsrOp);
+  assign PCS  = ((Rd == 4'b1111) & RegW & ~MulOp & ~LsmOp) |
+                (LsmPC & RegW & LsmXfer) | Branch;
 
   // Instr Decoder
   assign ImmSrc    = Op;
+  assign RegSrc[0] = (Op == 2'b10) & Funct[5]; // read PC on Branch
+  assign RegSrc[1] = (Op == 2'b01);            // read Rd on STR
 
 endmodule
 
-module mainfsm(input  logic         clk,
+module mainfsm #(parameter FAST = 0, HARVARD = 0)
+              (input  logic         clk,
                input  logic         reset,
                input  logic [1:0]   Op,
                input  logic [5:0]   Funct,
+               input  logic         IsMul, SwpOp, MulDone,
+               input  logic         RdPC, LsmLast, LsmEmpty,
                output logic         IRWrite,
-               output logic         AdrSrc,
+               output logic         AdrSrc, PCInc,
                output logic [1:0]   ALUSrcA, ALUSrcB, ResultSrc,
-               output logic         NextPC, RegW, MemW, Branch, ALUOp);  
+               output logic         NextPC, RegW, MemW, Branch, ALUOp,
+               output logic         MulStart, MulEn, MulWr,
+               output logic         LsmStart, LsmBase, LsmNext, LsmXfer,
+               input  logic         IntTake, FiqTake,
+               output logic         Exc, ExcFiq, Lock,
+               output logic [3:0]   State,
+               output logic         IFetch, MemRead,
+               input  logic         Stall);
               
   typedef enum logic [3:0] {FETCH, DECODE, MEMADR, MEMRD, MEMWB, 
                             MEMWR, EXECUTER, EXECUTEI, ALUWB, BRANCH, 
-				     UNKNOWN} 
+                            MULEX, MULWB, LSMADR, LSMLD, LSMST, EXCEPT}
 statetype;
   
-  statetype state, nextstate;
+  statetype state, nextstate, nextstates;
   logic [12:0] controls;
+  logic        NextPCs, IRWrites, RegWs, LastState, Prefetch;
   
   // state register
+  // hold the state while a cache stalls the memory access
   always @(posedge clk or posedge reset)
     if (reset) state <= FETCH;
-    else state <= nextstate;
+    else if (~Stall) state <= nextstate;
   
-  // ADD CODE BELOW
-  // Finish entering the next state logic below.  We've completed the 
-  // first two states, FETCH and DECODE, for you.
+  // FAST = 0 follows the textbook schedule:
+  //   B 3, data processing and STR 4, LDR 5 cycles
+  // FAST = 1 uses the free register write port to drop a state:
+  //   data processing writes ALUResult back in EXECUTER/EXECUTEI
+  //   (no ALUWB), LDR writes the memory data back in MEMRD (no MEMWB)
+  //   B 3, data processing 3, STR 4, LDR 4 cycles
+  // HARVARD = 1 fetches the next instruction in the last state of the
+  // current one through the separate instruction port and goes on to
+  // DECODE, saving FETCH. The PC steps through its own PC+4 adder
+  // (PCInc) since the ALU and Result are busy. Branches and
+  // instructions with Rd = R15 may write the PC and still use FETCH.
+  // LDM/STM take LSMADR, which computes the start address and writes
+  // the base back, then one LSMLD/LSMST per register.
+  // SWP goes through MEMADR, MEMRD and MEMWR; MEMWR writes the loaded
+  // word back from the Data register.
+  // An unmasked interrupt turns the FETCH that would follow an
+  // instruction into EXCEPT, which saves LR and the CPSR and loads the
+  // vector into the PC; the vector is then fetched as usual.
+  // Undefined instructions (Op = 11) do nothing.
 
   // next state logic
   always_comb
     casex(state)
-      FETCH:                     nextstate = DECODE;
+      FETCH:                     nextstates = DECODE;
       DECODE: case(Op)
                 2'b00: 
-                  if (Funct[5])  nextstate = EXECUTEI;
-                  else           nextstate = EXECUTER;
-                2'b01:           nextstate = MEMADR;
-                2'b10:           nextstate = BRANCH;
-                default:         nextstate = UNKNOWN;
+                  if (Funct[5])  nextstates = EXECUTEI;
+                  else if (IsMul) nextstates = MULEX;
+                  else if (SwpOp) nextstates = MEMADR;
+                  else           nextstates = EXECUTER;
+                2'b01:           nextstates = MEMADR;
+                2'b10:
+                  if (Funct[5])  nextstates = BRANCH;
+                  else           nextstates = LSMADR;
+                default:         nextstates = FETCH;
               endcase
-      EXECUTER:                  
-      EXECUTEI:                  
-      MEMADR: 
-      MEMRD:                     
-      default:                   nextstate = FETCH; 
+      EXECUTER,
+      EXECUTEI: if (FAST)        nextstates = FETCH;
+                else             nextstates = ALUWB;
+      MEMADR: if (Funct[0] | SwpOp) nextstates = MEMRD;
+              else               nextstates = MEMWR;
+      MEMRD:  if (SwpOp)         nextstates = MEMWR;
+              else if (FAST)     nextstates = FETCH;
+              else               nextstates = MEMWB;
+      MULEX:  if (MulDone)       nextstates = MULWB;
+              else               nextstates = MULEX;
+      LSMADR: if (Funct[0])      nextstates = LSMLD;
+              else               nextstates = LSMST;
+      LSMLD:  if (LsmLast)       nextstates = FETCH;
+              else               nextstates = LSMLD;
+      LSMST:  if (LsmEmpty)      nextstates = FETCH;
+              else               nextstates = LSMST;
+      default:                   nextstates = FETCH;
     endcase
     
-  // ADD CODE BELOW
-  // Finish entering the output logic below.  We've entered the
-  // output logic for the first two states, FETCH and DECODE, for you.
+  // overlapped fetch
+  always_comb
+    case(state)
+      EXECUTER, EXECUTEI:        LastState = (FAST != 0);
+      MEMRD:                     LastState = (FAST != 0) & ~SwpOp;
+      ALUWB, MEMWB:              LastState = (FAST == 0);
+      MEMWR, MULWB:              LastState = 1;
+      LSMLD:                     LastState = LsmLast;
+      LSMST:                     LastState = LsmEmpty;
+      default:                   LastState = 0;
+    endcase
+
+  assign Prefetch  = HARVARD & LastState & ~RdPC & ~IntTake;
+  assign nextstate = Prefetch ? DECODE :
+                     ((nextstates == FETCH) & IntTake & (state != EXCEPT)) ?
+                     EXCEPT : nextstates;
+
+  // the interrupt taken is chosen on the way into EXCEPT
+  always_ff @(posedge clk, posedge reset)
+    if (reset) ExcFiq <= 0;
+    else if (~Stall & (nextstate == EXCEPT)) ExcFiq <= FiqTake;
 
   // state-dependent output logic
+  // MEMRD and MEMWR keep the ALU on A + ExtImm so ALUOut still holds
+  // the address when a cache stall makes them last several cycles
   always_comb
     case(state)
       FETCH: 	controls = 13'b10001_010_01100; 
       DECODE:  	controls = 13'b00000_010_01100;      
-      EXECUTER: 
-      EXECUTEI: 
-      ALUWB: 
-      MEMADR: 
-      MEMWR: 
-      MEMRD: 
-      MEMWB: 
-      BRANCH: 
+      EXECUTER: if (FAST) controls = 13'b00010_010_00001;
+                else      controls = 13'b00000_000_00001;
+      EXECUTEI: if (FAST) controls = 13'b00010_010_00011;
+                else      controls = 13'b00000_000_00011;
+      ALUWB:    controls = 13'b00010_000_00000;
+      MEMADR:   controls = 13'b00000_000_00010;
+      MEMWR:    controls = 13'b00100_101_00010;
+      MEMRD:    if (FAST) controls = 13'b00010_101_00010;
+                else      controls = 13'b00000_100_00010;
+      MEMWB:    controls = 13'b00010_001_00000;
+      BRANCH:   controls = 13'b01000_010_10010;
+      MULEX:    controls = 13'b00000_000_00000;
+      MULWB:    controls = 13'b00010_011_00000;
+      LSMADR:   controls = 13'b00000_010_00110;
+      LSMLD:    controls = 13'b00010_001_00000;
+      LSMST:    controls = 13'b00100_000_00000;
+      EXCEPT:   controls = 13'b10010_010_01100;
       default: 	controls = 13'bxxxxx_xxx_xxxxx;
     endcase
 
-  assign {NextPC, Branch, MemW, RegW, IRWrite,
+  assign {NextPCs, Branch, MemW, RegWs, IRWrites,
           AdrSrc, ResultSrc,   
           ALUSrcA, ALUSrcB, ALUOp} = controls;
+
+  // a stalled fetch must not advance the PC or load the IR and a
+  // stalled state must not write back; MemW stays asserted until the
+  // data cache takes the store
+  // LSMADR writes the base back only with W (Instr[21]), SWP writes
+  // Rd in MEMWR and not in a FAST MEMRD
+  assign NextPC  = (NextPCs  | Prefetch) & ~Stall;
+  assign IRWrite = (IRWrites | Prefetch) & ~Stall;
+  assign RegW    = ((RegWs & ~(SwpOp & (state == MEMRD))) |
+                    ((state == LSMADR) & Funct[1]) |
+                    ((state == MEMWR) & SwpOp)) & ~Stall;
+  assign PCInc   = Prefetch;
+
+  // memory requests for the caches
+  assign IFetch  = (state == FETCH) | Prefetch;
+  assign MemRead = (state == MEMRD) | (state == LSMLD);
+  assign Lock    = (state == MEMRD) & SwpOp;
+
+  // block transfer control: DECODE loads the register list, LSMADR the
+  // address; STM reads its first register in LSMADR, so the list runs
+  // one register ahead of the stores
+  assign LsmXfer  = (state == LSMLD) | (state == LSMST);
+  assign LsmStart = (state == DECODE);
+  assign LsmBase  = (state == LSMADR);
+  assign LsmNext  = (LsmXfer | (LsmBase & ~Funct[0])) & ~Stall;
+
+  // multiplier control: DECODE loads the operands
+  assign MulStart = (state == DECODE) & IsMul;
+  assign MulEn    = (state == MULEX);
+  assign MulWr    = (state == MULWB);
+
+  // exception entry: LR <- PC + 4 through the ALU, PC <- vector
+  assign Exc = (state == EXCEPT);
+
+  // current state for the performance monitoring unit
+  assign State = state;
 endmodule              
 
-// ADD CODE BELOW
-// Add code for the condlogic and condcheck modules. Remember, you may
-// reuse code from prior labs.
 module condlogic(input  logic       clk, reset,
                  input  logic [3:0] Cond,
                  input  logic [3:0] ALUFlags,
                  input  logic [1:0] FlagW,
                  input  logic       PCS, NextPC, RegW, MemW,
-                 output logic       PCWrite, RegWrite, MemWrite);
+                 output logic       PCWrite, RegWrite, MemWrite,
+                 output logic       CondEx,
+                 input  logic       FlagLoad,
+                 input  logic [3:0] FlagsIn,
+                 output logic [3:0] Flags, FlagsPend,
+                 input  logic       Stall);
 
   logic [1:0] FlagWrite;
-  logic [3:0] Flags;
-  logic       CondEx;
+  logic [3:0] FlagsNext;
+
+  // FlagLoad writes all four flags from the PSR unit (MSR, exception
+  // return)
+  mux2 #(4)   flagmux(ALUFlags, FlagsIn, FlagLoad, FlagsNext);
+  flopenr #(2)flagreg1(clk, reset, (FlagWrite[1] & ~Stall) | FlagLoad,
+                       FlagsNext[3:2], Flags[3:2]);
+  flopenr #(2)flagreg0(clk, reset, (FlagWrite[0] & ~Stall) | FlagLoad,
+                       FlagsNext[1:0], Flags[1:0]);
 
+  // write controls are conditional
+  condcheck cc(Cond, Flags, CondEx);
 
-  // Delay writing flags until ALUWB state
-  flopr #(2)flagwritereg(clk, reset, FlagW&{2{CondEx}}, FlagWrite);
+  // Delay writing flags by one cycle (ALUWB state, or the next FETCH);
+  // ALUFlags are registered with ALUOut, so they still hold the flags
+  // of the executing instruction. A cache stall holds the pending
+  // write, so the flags change together with the register write that
+  // ends a stalled ALUWB
+  flopenr #(2)flagwritereg(clk, reset, ~Stall, FlagW&{2{CondEx}},
+                           FlagWrite);
 
-  // ADD CODE HERE
+  // the flags with that pending write applied, for the SPSR saved by
+  // an EXCEPT that follows a flag-setting EXECUTE (FAST) or MULWB
+  assign FlagsPend = {FlagWrite[1] ? ALUFlags[3:2] : Flags[3:2],
+                      FlagWrite[0] ? ALUFlags[1:0] : Flags[1:0]};
 
+  assign RegWrite = RegW & CondEx;
+  assign MemWrite = MemW & CondEx;
+  assign PCWrite  = (PCS & CondEx) | NextPC;
 endmodule    
 
 module condcheck(input  logic [3:0] Cond,
                  input  logic [3:0] Flags,
                  output logic       CondEx);
+  
+  logic neg, zero, carry, overflow, ge;
+  
+  assign {neg, zero, carry, overflow} = Flags;
+  assign ge = (neg == overflow);
+                  
+  always_comb
+    case(Cond)
+      4'b0000: CondEx = zero;             // EQ
+      4'b0001: CondEx = ~zero;            // NE
+      4'b0010: CondEx = carry;            // CS
+      4'b0011: CondEx = ~carry;           // CC
+      4'b0100: CondEx = neg;              // MI
+      4'b0101: CondEx = ~neg;             // PL
+      4'b0110: CondEx = overflow;         // VS
+      4'b0111: CondEx = ~overflow;        // VC
+      4'b1000: CondEx = carry & ~zero;    // HI
+      4'b1001: CondEx = ~(carry & ~zero); // LS
+      4'b1010: CondEx = ge;               // GE
+      4'b1011: CondEx = ~ge;              // LT
+      4'b1100: CondEx = ~zero & ge;       // GT
+      4'b1101: CondEx = ~(~zero & ge);    // LE
+      4'b1110: CondEx = 1'b1;             // Always
+      default: CondEx = 1'bx;             // undefined
+    endcase
+endmodule
+
+module psr(input  logic        clk, reset,
+           input  logic        Exc, ExcFiq, Restore, MsrW, MsrR,
+           input  logic [3:0]  MsrMask,
+           input  logic [31:0] MsrData,
+           input  logic [3:0]  Flags, FlagsPend,
+           output logic        FlagLoad,
+           output logic [3:0]  FlagsIn,
+           output logic [31:0] Psr,
+           output logic [4:0]  Mode,
+           output logic        I, F);
+
+  // CPSR control bits and the SPSRs of the IRQ and FIQ modes; the
+  // CPSR flags stay in condlogic
+  // MsrR selects the SPSR for MRS and MSR, MsrMask[3] the flags field,
+  // MsrMask[0] the control field
+  logic [31:0] Cpsr, CpsrExc, Spsr, SpsrIrq, SpsrFiq;
+  logic        HasSpsr, Priv;
+
+  // the flag write of the state before EXCEPT is still pending in
+  // condlogic, so the SPSR takes the flags it is about to write
+  assign Cpsr    = {Flags, 20'b0, I, F, 1'b0, Mode};
+  assign CpsrExc = {FlagsPend, Cpsr[27:0]};
+  assign HasSpsr = (Mode == 5'b10001) | (Mode == 5'b10010);
+  assign Spsr    = (Mode == 5'b10001) ? SpsrFiq : SpsrIrq;
+  assign Priv    = (Mode != 5'b10000);
 
-  // ADD CODE HERE
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Mode    <= 5'b10011;
+      I       <= 1;
+      F       <= 1;
+      SpsrIrq <= 0;
+      SpsrFiq <= 0;
+    end else if (Exc) begin
+      if (ExcFiq) begin
+        SpsrFiq <= CpsrExc;
+        Mode    <= 5'b10001;
+        F       <= 1;
+      end else begin
+        SpsrIrq <= CpsrExc;
+        Mode    <= 5'b10010;
+      end
+      I <= 1;
+    end else if (Restore & HasSpsr)
+      {I, F, Mode} <= {Spsr[7:6], Spsr[4:0]};
+    else if (MsrW & MsrR & HasSpsr) begin
+      if (Mode == 5'b10001) begin
+        if (MsrMask[3]) SpsrFiq[31:28] <= MsrData[31:28];
+        if (MsrMask[0]) SpsrFiq[7:0]   <= MsrData[7:0];
+      end else begin
+        if (MsrMask[3]) SpsrIrq[31:28] <= MsrData[31:28];
+        if (MsrMask[0]) SpsrIrq[7:0]   <= MsrData[7:0];
+      end
+    end else if (MsrW & ~MsrR & MsrMask[0] & Priv)
+      {I, F, Mode} <= {MsrData[7:6], MsrData[4:0]};
 
+  // the flags are loaded through condlogic
+  assign FlagLoad = (Restore & HasSpsr) | (MsrW & ~MsrR & MsrMask[3]);
+  assign FlagsIn  = Restore ? Spsr[31:28] : MsrData[31:28];
+
+  // MRS reads the SPSR as 0 in modes without one
+  assign Psr = MsrR ? (HasSpsr ? Spsr : 32'b0) : Cpsr;
 endmodule
 
 
-// ADD CODE BELOW
-// Complete the datapath module below for Lab 11.
-// You do not need to complete this module for Lab 10.
 // The datapath unit is a structural SystemVerilog module. That is,
 // it is composed of instances of its sub-modules. For example,
 // the instruction register is instantiated as a 32-bit flopenr.
-// The other submodules are likewise instantiated. 
+// ALUSrcA:   00 A, 01 PC, 10 ALUOut
+// ALUSrcB:   00 shifted WriteData, 01 ExtImm, 10 4
+// ResultSrc: 00 ALUOut, 01 Data (memory data when FAST), 10 ALUResult,
+//            11 MulResult
 
-module datapath(input  logic        clk, reset,
+module datapath #(parameter FAST = 0, HARVARD = 0, FIQ_BANK = 1)
+               (input  logic        clk, reset,
                 output logic [31:0] Adr, WriteData,
                 input  logic [31:0] ReadData,
+                output logic [31:0] IAdr,
+                input  logic [31:0] IReadData,
                 output logic [31:0] Instr,
                 output logic [3:0]  ALUFlags,
                 input  logic        PCWrite, RegWrite,
                 input  logic        IRWrite,
-                input  logic        AdrSrc, 
+                input  logic        AdrSrc, PCInc,
                 input  logic [1:0]  RegSrc, 
                 input  logic [1:0]  ALUSrcA, ALUSrcB, ResultSrc,
-                input  logic [1:0]  ImmSrc, ALUControl);
+                input  logic [1:0]  ImmSrc, ALUControl,
+                input  logic        MovOp, ByteOp,
+                output logic [3:0]  ByteEn,
+                input  logic        MulOp, MulStart, MulEn, MulWr,
+                input  logic [1:0]  MulCtrl,
+                output logic        MulDone,
+                input  logic        LsmOp, LsmStart, LsmBase, LsmNext,
+                input  logic        LsmXfer,
+                output logic        LsmPC, LsmLast, LsmEmpty,
+                output logic [31:0] ALUResult,
+                input  logic [4:0]  Mode,
+                input  logic        Exc, ExcFiq, PsrRead,
+                input  logic [31:0] Psr,
+                input  logic        SwpOp,
+                input  logic        Stall);
+
+  logic [31:0] PCNext, PC, PCPlus4, Vector;
+  logic [31:0] ExtImmS, ExtImm, SrcA, SrcB, Result;
+  logic [31:0] Data, MemData, RD1, RD2, A, ALUOut;
+  logic [31:0] RD3, Rs, ShiftedB, SrcAsel, SrcBsel;
+  logic [31:0] MulResult, MulLo, LoadData, StoreData;
+  logic [31:0] AdrS, LsmAdr, LsmOff;
+  logic [3:0]  RA1, RA2S, RA2, WA3S, WA3, LsmReg;
+  logic [4:0]  WMode;
+  logic [3:0]  AluFlags, FlagsNext;
+  logic [1:0]  MulFlags;
+
+  // next PC logic
+  // an overlapped fetch (HARVARD) steps the PC with its own adder,
+  // EXCEPT loads the IRQ or FIQ vector
+  adder   #(32) pcadd(PC, 32'd4, PCPlus4);
+  assign Vector = ExcFiq ? 32'h1C : 32'h18;
+  mux3    #(32) pcmux(Result, PCPlus4, Vector, {Exc, PCInc}, PCNext);
+  flopenr #(32) pcreg(clk, reset, PCWrite, PCNext, PC);
 
-  logic [31:0] PCNext, PC;
-  logic [31:0] ExtImm, SrcA, SrcB, Result;
-  logic [31:0] Data, RD1, RD2, A, ALUResult, ALUOut;
-  logic [3:0]  RA1, RA2;
+  // memory logic
+  // data accesses use ALUOut, so Result is free to carry the load data
+  // in the FAST schedule, which writes back straight from memory
+  // HARVARD gives instruction fetches their own port at the PC
+  // LDM/STM address memory from the block transfer unit and load
+  // straight into the register file
+  mux2    #(32) adrmux(PC, ALUOut, AdrSrc, AdrS);
+  mux2    #(32) lsmadrmux(AdrS, LsmAdr, LsmXfer, Adr);
+  assign IAdr = HARVARD ? PC : Adr;
+  flopenr #(32) ir(clk, reset, IRWrite, IReadData, Instr);
+  flopenr #(32) datareg(clk, reset, ~Stall, LoadData, Data);
+  // SWP writes back from Data in MEMWR, after the bus has moved on
+  assign MemData = (((FAST != 0) & ~SwpOp) | LsmXfer) ? LoadData : Data;
 
-  // Your datapath hardware goes below. Instantiate each of the 
-  // submodules that you need. Remember that you can reuse hardware
-  // from previous labs. Be sure to give your instantiated modules 
-  // applicable names such as pcreg (PC register), adrmux 
-  // (Address Mux), etc. so that your code is easier to understand.
+  // byte access logic
+  // LDRB zero extends the addressed lane, STRB drives the byte on all
+  // lanes and enables the addressed one
+  mux2    #(32) ldmux(ReadData, {24'b0, ReadData[8*Adr[1:0] +: 8]},
+                      ByteOp, LoadData);
+  mux2    #(32) wdmux(RD2, {4{RD2[7:0]}}, ByteOp, StoreData);
+  mux2    #(4)  bemux(4'b1111, 4'b0001 << Adr[1:0], ByteOp, ByteEn);
 
-  // ADD CODE HERE
+  // register file logic
+  // R15 reads as Result, which holds PC+8 during DECODE
+  // multiplies read ra from Instr[15:12] and write rd to Instr[19:16]
+  // LDM/STM write the base back to Instr[19:16] in LSMADR and then
+  // read or write the registers of the list in turn
+  mux3    #(4)  ra1mux(Instr[19:16], 4'b1111, Instr[15:12],
+                       {MulOp, RegSrc[0]}, RA1);
+  mux2    #(4)  ra2mux(Instr[3:0], Instr[15:12], RegSrc[1], RA2S);
+  mux2    #(4)  lsmra2mux(RA2S, LsmReg, LsmOp, RA2);
+  // EXCEPT writes PC + 4 to R14 of the mode it enters
+  mux3    #(4)  wa3mux(Instr[15:12], Instr[19:16], LsmReg,
+                       {LsmXfer, MulOp | LsmOp}, WA3S);
+  mux2    #(4)  lrmux(WA3S, 4'd14, Exc, WA3);
+  assign WMode = Exc ? (ExcFiq ? 5'b10001 : 5'b10010) : Mode;
+  regfile #(FIQ_BANK)
+                rf(clk, Mode, WMode, RegWrite, RA1, RA2, Instr[11:8],
+                   WA3, Result, Result,
+                   RegWrite & MulWr & MulCtrl[1], Instr[15:12], MulLo,
+                   RD1, RD2, RD3);
+  flopr   #(32) areg(clk, reset, RD1, A);
+  flopenr #(32) wdreg(clk, reset, ~Stall, StoreData, WriteData);
+  flopr   #(32) rsreg(clk, reset, RD3, Rs);
+  extend        ext(Instr[23:0], ImmSrc, ExtImmS);
+  // SWP addresses memory at Rn + 0
+  mux2    #(32) swpmux(ExtImmS, 32'b0, SwpOp, ExtImm);
 
+  // ALU logic
+  // the register operand goes through the barrel shifter,
+  // MOV replaces SrcA with 0, MRS (a MOV) replaces SrcB with the PSR
+  shifter       sh(WriteData, Instr[11:4], Rs[7:0], ShiftedB);
+  mux3    #(32) srcamux(A, PC, ALUOut, ALUSrcA, SrcAsel);
+  mux2    #(32) movmux(SrcAsel, 32'b0, MovOp, SrcA);
+  mux4    #(32) srcbmux(ShiftedB, ExtImm, 32'd4, LsmOff, ALUSrcB, SrcBsel);
+  mux2    #(32) psrmux(SrcBsel, Psr, PsrRead, SrcB);
+  alu           alu(SrcA, SrcB, ALUControl, ALUResult, AluFlags);
+  flopenr #(32) aluoutreg(clk, reset, ~Stall, ALUResult, ALUOut);
+  mux4    #(32) resmux(ALUOut, MemData, ALUResult, MulResult,
+                       ResultSrc, Result);
 
+  // multiplier logic
+  // operands come straight from the register file during DECODE
+  mulunit #(8)  mul(clk, reset, MulStart, MulEn, MulCtrl,
+                    RD2, RD3, RD1, MulResult, MulLo, MulFlags, MulDone);
+  assign FlagsNext = MulOp ? {MulFlags, AluFlags[1:0]} : AluFlags;
+
+  // block transfer logic
+  // LSMADR adds LsmOff (+/- 4 * registers) to the base for writeback
+  lsmunit       lsm(clk, reset, LsmStart, LsmBase, LsmNext, LsmXfer,
+                    Instr[24:23], Instr[15:0], A, ALUResult,
+                    LsmReg, LsmAdr, LsmOff, LsmLast, LsmEmpty);
+  assign LsmPC = (LsmReg == 4'b1111);
+
+  // flags are registered like ALUOut and written one cycle later
+  // ALUOut, Data and the flags hold while a cache stalls, since with
+  // HARVARD a fetch can stall ALUWB or MEMWB, which consume them
+  flopenr #(4)  flagsreg(clk, reset, ~Stall, FlagsNext, ALUFlags);
 endmodule
 
 
-// ADD CODE BELOW
-// Add needed building blocks below (i.e., parameterizable muxes, 
-// registers, etc.). Remember, you can reuse code from previous labs.
-// We've also provided a parameterizable 3:1 mux below for your 
-// convenience.
+// Building blocks
+
+module regfile #(parameter FIQ_BANK = 1)
+              (input  logic        clk,
+               input  logic [4:0]  mode, wmode,
+               input  logic        we3,
+               input  logic [3:0]  ra1, ra2, ra4, wa3,
+               input  logic [31:0] wd3, r15,
+               input  logic        we5,
+               input  logic [3:0]  wa5,
+               input  logic [31:0] wd5,
+               output logic [31:0] rd1, rd2, rd4);
+
+  logic [31:0] rf[23:0];
+
+  // five ported register file
+  // read three ports combinationally
+  //   (the third read port supplies Rs for register-shifted operands
+  //    and multiplies)
+  // write two ports on rising edge of clock
+  //   (the second write port is only used by UMULL for RdLo)
+  // register 15 reads PC+8 instead
+  // banked registers: 0-14 user (shared by usr, svc and sys), 15-16
+  // R13-R14 of irq, 17-23 R8-R14 of fiq (R13-R14 only if FIQ_BANK = 0)
+  // mode selects the bank for reads and the second write port, wmode
+  // for the first write port (EXCEPT writes LR of the mode it enters)
+
+  function automatic logic [4:0] bank(input logic [3:0] r,
+                                      input logic [4:0] m);
+    if (r == 4'b1111)                    // the PC, not in the file
+      return 5'd31;
+    else if (m == 5'b10001 & (r >= ((FIQ_BANK != 0) ? 8 : 13)))
+      return r + 9;
+    else if (m == 5'b10010 & r >= 13)
+      return r + 2;
+    else
+      return r;
+  endfunction
+
+  always_ff @(posedge clk) begin
+    if (we3) rf[bank(wa3, wmode)] <= wd3;
+    if (we5) rf[bank(wa5, mode)]  <= wd5;
+  end
+
+  assign rd1 = (ra1 == 4'b1111) ? r15 : rf[bank(ra1, mode)];
+  assign rd2 = (ra2 == 4'b1111) ? r15 : rf[bank(ra2, mode)];
+  assign rd4 = (ra4 == 4'b1111) ? r15 : rf[bank(ra4, mode)];
+endmodule
+
+module extend(input  logic [23:0] Instr,
+              input  logic [1:0]  ImmSrc,
+              output logic [31:0] ExtImm);
+
+  always_comb
+    case(ImmSrc)
+               // 8-bit unsigned immediate
+               //   rotated right by 2*rot (Instr[11:8])
+      2'b00:   ExtImm = {2{24'b0, Instr[7:0]}} >> {Instr[11:8], 1'b0};
+               // 12-bit unsigned immediate
+      2'b01:   ExtImm = {20'b0, Instr[11:0]};
+               // 24-bit two's complement shifted branch
+      2'b10:   ExtImm = {{6{Instr[23]}}, Instr[23:0], 2'b00};
+      default: ExtImm = 32'bx; // undefined
+    endcase
+endmodule
+
+module shifter(input  logic [31:0] a,
+               input  logic [11:4] Shift,
+               input  logic [7:0]  Rs,
+               output logic [31:0] y);
+
+  logic [7:0]  shamt;
+  logic [31:0] asr;
+
+  // shift amount: Rs[7:0] when Shift[4] is set, else the 5-bit
+  // immediate. LSR #0 and ASR #0 encode a shift by 32.
+  always_comb
+    if (Shift[4])              shamt = Rs;
+    else if (Shift[11:7] == 5'b0 & (Shift[6:5] == 2'b01 |
+                                    Shift[6:5] == 2'b10))
+                               shamt = 8'd32;
+    else                       shamt = {3'b0, Shift[11:7]};
+
+  // kept apart so the shift stays signed
+  assign asr = $signed(a) >>> shamt[4:0];
+
+  always_comb
+    case(Shift[6:5])
+      2'b00:   y = (shamt > 31) ? 32'b0 : a << shamt[4:0];       // LSL
+      2'b01:   y = (shamt > 31) ? 32'b0 : a >> shamt[4:0];       // LSR
+      2'b10:   y = (shamt > 31) ? {32{a[31]}} : asr;             // ASR
+      default: y = {a, a} >> shamt[4:0];                          // ROR
+    endcase
+endmodule
+
+module mulunit #(parameter STEP = 8)
+               (input  logic        clk, reset, start, en,
+                input  logic [1:0]  MulCtrl,
+                input  logic [31:0] a, b, acc,
+                output logic [31:0] Result, Lo,
+                output logic [1:0]  Flags,
+                output logic        done);
+
+  logic [63:0] P, M;
+  logic [31:0] Q;
+
+  // iterative multiplier: each cycle adds a * (next STEP bits of b)
+  // to the partial product. start loads the operands and does the
+  // first step, en does the following steps.
+  // MulCtrl = {long, accumulate}
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      {P, M, Q} <= 0;
+    end else if (start) begin
+      P <= (MulCtrl[0] ? {32'b0, acc} : 64'b0) +
+           {32'b0, a} * b[STEP-1:0];
+      M <= {32'b0, a} << STEP;
+      Q <= b >> STEP;
+    end else if (en) begin
+      P <= P + M * Q[STEP-1:0];
+      M <= M << STEP;
+      Q <= Q >> STEP;
+    end
+
+  // the current step is the last one once the remaining bits are zero
+  assign done   = ((Q >> STEP) == 0);
+
+  // Result goes to Instr[19:16]: RdHi for UMULL, Rd otherwise
+  assign Lo     = P[31:0];
+  assign Result = MulCtrl[1] ? P[63:32] : P[31:0];
+
+  // N and Z
+  assign Flags  = MulCtrl[1] ? {P[63], P == 64'b0} :
+                               {P[31], P[31:0] == 32'b0};
+endmodule
+
+module lsmunit(input  logic        clk, reset,
+               input  logic        start, base, next, xfer,
+               input  logic [1:0]  PU,
+               input  logic [15:0] RegList,
+               input  logic [31:0] Rn, WbAdr,
+               output logic [3:0]  Reg,
+               output logic [31:0] Adr, Offset,
+               output logic        Last, Empty);
+
+  logic [15:0] List;
+  logic [4:0]  N;
+
+  // number of registers in the list
+  always_comb begin
+    N = 0;
+    for (int i = 0; i < 16; i++) N = N + RegList[i];
+  end
+
+  // U: base + 4N, else base - 4N
+  assign Offset = PU[0] ? {25'b0, N, 2'b00} : -{25'b0, N, 2'b00};
+
+  // remaining registers, lowest first
+  always_ff @(posedge clk, posedge reset)
+    if (reset)      List <= 0;
+    else if (start) List <= RegList;
+    else if (next)  List <= List & (List - 1);
+
+  always_comb begin
+    Reg = 0;
+    for (int i = 15; i >= 0; i--)
+      if (List[i]) Reg = i;
+  end
+
+  assign Last  = (List & (List - 1)) == 0;
+  assign Empty = (List == 0);
+
+  // address counter
+  //   IA: Rn        IB: Rn + 4
+  //   DA: Rn - 4N + 4   DB: Rn - 4N
+  // (WbAdr is the written-back base Rn +/- 4N)
+  always_ff @(posedge clk, posedge reset)
+    if (reset)             Adr <= 0;
+    else if (base)         Adr <= (PU[0] ? Rn : WbAdr) +
+                                  ((PU[1] == PU[0]) ? 4 : 0);
+    else if (xfer & next)  Adr <= Adr + 4;
+endmodule
+
+module adder #(parameter WIDTH=8)
+              (input  logic [WIDTH-1:0] a, b,
+               output logic [WIDTH-1:0] y);
+
+  assign y = a + b;
+endmodule
+
+module flopenr #(parameter WIDTH = 8)
+                (input  logic             clk, reset, en,
+                 input  logic [WIDTH-1:0] d,
+                 output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)   q <= 0;
+    else if (en) q <= d;
+endmodule
+
+module flopr #(parameter WIDTH = 8)
+              (input  logic             clk, reset,
+               input  logic [WIDTH-1:0] d,
+               output logic [WIDTH-1:0] q);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) q <= 0;
+    else       q <= d;
+endmodule
+
+module mux2 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1,
+              input  logic             s,
+              output logic [WIDTH-1:0] y);
+
+  assign y = s ? d1 : d0;
+endmodule
 
 module mux3 #(parameter WIDTH = 8)
              (input  logic [WIDTH-1:0] d0, d1, d2,
@@ -333,3 +2212,17 @@ module mux3 #(parameter WIDTH = 8)
   assign y = s[1] ? d2 : (s[0] ? d1 : d0); 
 endmodule
 
+module mux4 #(parameter WIDTH = 8)
+             (input  logic [WIDTH-1:0] d0, d1, d2, d3,
+              input  logic [1:0]       s, 
+              output logic [WIDTH-1:0] y);
+
+  always_comb
+    case(s)
+      2'b00: y = d0;
+      2'b01: y = d1;
+      2'b10: y = d2;
+      2'b11: y = d3;
+    endcase
+endmodule
+
@@ -0,0 +1,57 @@
+// clusterbench.asm
+// Parallel sum for the cluster in arm_cluster.sv: each of the NCORES
+// cores adds every NCORES-th element of a[0..255] = 1..256 at 0x400,
+// starting at its CPUID, then adds its partial sum to the total at
+// 0x304 under a spinlock at 0x300 taken with SWP, and counts itself
+// done at 0x308. Core 0 waits for all of them, writes the total
+// (32896) to address 96 and the value 7 to address 100; the other
+// cores stop in HALT.
+// The lock is test-and-test-and-set: cores wait with LDR and only
+// swap once it looks free, so waiting cores do not lock the memory.
+// Run cluster_testbench with MEM_BYTES = 2048. The .dat file holds
+// the program, zeros up to 0x400 and the array.
+
+// clusterbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          SUB  R1, R0, #0x100      ; R1 = 0xFFFFFF00, core registers  E2401C01 0x04
+//          LDR  R2, [R1]            ; R2 = CPUID                       E5912000 0x08
+//          LDR  R3, [R1, #4]        ; R3 = NCORES                      E5913004 0x0c
+//          ADD  R4, R0, #0x400      ;                                  E2804B01 0x10
+//          ADD  R4, R4, R2, LSL #2  ; R4 = &a[CPUID]                   E0844102 0x14
+//          ADD  R5, R0, #0x800      ; R5 = &a[256], end of the array   E2805B02 0x18
+//          MOV  R6, R3, LSL #2      ; R6 = stride, NCORES words        E1A06103 0x1c
+//          ADD  R7, R0, #0          ; R7 = partial sum                 E2807000 0x20
+//          ADD  R9, R0, #0x300      ; R9 = lock, total at +4, done at +8 E2809C03 0x24
+//          ADD  R10, R0, #1         ;                                  E280A001 0x28
+// SUM      LDR  R8, [R4]            ; every NCORES-th element from CPUID E5948000 0x2c
+//          ADD  R7, R7, R8          ;                                  E0877008 0x30
+//          ADD  R4, R4, R6          ;                                  E0844006 0x34
+//          SUBS R8, R4, R5          ;                                  E0548005 0x38
+//          BCC  SUM                 ;                                  3AFFFFFA 0x3c
+// SPIN     LDR  R11, [R9]           ; wait until the lock looks free   E599B000 0x40
+//          ANDS R11, R11, R11       ;                                  E01BB00B 0x44
+//          BNE  SPIN                ;                                  1AFFFFFC 0x48
+//          SWP  R11, R10, [R9]      ; then try to take it              E109B09A 0x4c
+//          ANDS R11, R11, R11       ;                                  E01BB00B 0x50
+//          BNE  SPIN                ; someone else got there first     1AFFFFF9 0x54
+//          LDR  R11, [R9, #4]       ;                                  E599B004 0x58
+//          B    CRIT                ;                                  EA000001 0x5c
+//          .WORD 0                  ; mem[96]                          00000000 0x60
+//          .WORD 0                  ; mem[100]                         00000000 0x64
+// CRIT     ADD  R11, R11, R7        ;                                  E08BB007 0x68
+//          STR  R11, [R9, #4]       ; total += partial sum             E589B004 0x6c
+//          LDR  R11, [R9, #8]       ;                                  E599B008 0x70
+//          ADD  R11, R11, #1        ;                                  E28BB001 0x74
+//          STR  R11, [R9, #8]       ; done += 1                        E589B008 0x78
+//          STR  R0, [R9]            ; release the lock                 E5890000 0x7c
+//          ANDS R2, R2, R2          ;                                  E0122002 0x80
+//          BNE  HALT                ; core 0 reports                   1A000006 0x84
+// WAIT     LDR  R11, [R9, #8]       ;                                  E599B008 0x88
+//          SUBS R11, R11, R3        ;                                  E05BB003 0x8c
+//          BNE  WAIT                ; until every core is done         1AFFFFFC 0x90
+//          LDR  R11, [R9, #4]       ;                                  E599B004 0x94
+//          STR  R11, [R0, #96]      ; mem[96] = 32896                  E580B060 0x98
+//          ADD  R11, R0, #7         ;                                  E280B007 0x9c
+//          STR  R11, [R0, #100]     ; mem[100] = 7                     E580B064 0xa0
+// HALT     B    HALT                ;                                  EAFFFFFE 0xa4
@@ -0,0 +1,66 @@
+// intbench.asm
+// Interrupt test: the testbench raises irq and fiq once each; the
+// handlers count them at 0x308 (IRQ) and 0x30C (FIQ) and acknowledge
+// by storing to 0x300 and 0x304, while the main loop waits for both
+// counts. If successful, it writes 21 (2 interrupts + svc mode 0x13)
+// to address 96 and the value 7 to address 100
+// Run testbench with MEM_BYTES = 1024 and IRQ_AT, FIQ_AT set (e.g.
+// 200 and 230) and FIQ_BANK = 1: the FIQ handler keeps its count and
+// pointer in the banked R8 and R9. A FIQ raised during the IRQ
+// handler preempts it.
+//
+// The vector table fills 0x00-0x1C, the FIQ handler follows the FIQ
+// vector in place, and the main program starts past the result
+// words at 96 and 100.
+
+// intbench.dat
+
+//          B    MAIN                ; reset                            EA000018 0x00
+//          B    MAIN                ; undefined (not used)             EA000017 0x04
+//          B    MAIN                ; SWI (not used)                   EA000016 0x08
+//          B    MAIN                ; prefetch abort (not used)        EA000015 0x0c
+//          B    MAIN                ; data abort (not used)            EA000014 0x10
+//          B    MAIN                ; reserved                         EA000013 0x14
+//          B    IRQH                ; IRQ                              EA000003 0x18
+// FIQH     ADD  R8, R8, #1          ; FIQ in place, count in R8_fiq    E2888001 0x1c
+//          STR  R8, [R9, #12]       ; mem[0x30C] = FIQs taken          E589800C 0x20
+//          STR  R8, [R9, #4]        ; acknowledge, drops fiq           E5898004 0x24
+//          SUBS PC, LR, #4          ; return, CPSR <= SPSR_fiq         E25EF004 0x28
+// IRQH     PUSH {R1, R2}            ; IRQ banks SP and LR only         E92D0006 0x2c
+//          ADD  R1, R0, #0x300      ;                                  E2801C03 0x30
+//          LDR  R2, [R1, #8]        ;                                  E5912008 0x34
+//          ADD  R2, R2, #1          ;                                  E2822001 0x38
+//          STR  R2, [R1, #8]        ; mem[0x308] = IRQs taken          E5812008 0x3c
+//          STR  R2, [R1]            ; acknowledge, drops irq           E5812000 0x40
+//          POP  {R1, R2}            ;                                  E8BD0006 0x44
+//          SUBS PC, LR, #4          ; return, CPSR <= SPSR_irq         E25EF004 0x48
+//          .WORD 0                  ;                                  00000000 0x4c
+//          .WORD 0                  ;                                  00000000 0x50
+//          .WORD 0                  ;                                  00000000 0x54
+//          .WORD 0                  ;                                  00000000 0x58
+//          .WORD 0                  ;                                  00000000 0x5c
+//          .WORD 0                  ; mem[96]                          00000000 0x60
+//          .WORD 0                  ; mem[100]                         00000000 0x64
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x68
+//          MSR  CPSR_c, #0xD2       ; IRQ mode, IRQ and FIQ masked     E321F0D2 0x6c
+//          ADD  SP, R0, #0x400      ; IRQ stack at the top of memory   E280DB01 0x70
+//          MSR  CPSR_c, #0xD1       ; FIQ mode                         E321F0D1 0x74
+//          ADD  R9, R0, #0x300      ; FIQ registers set up once        E2809C03 0x78
+//          ADD  R8, R0, #0          ;                                  E2808000 0x7c
+//          ADD  R1, R0, #0x300      ;                                  E2801C03 0x80
+//          STR  R0, [R1, #8]        ; clear the counts                 E5810008 0x84
+//          STR  R0, [R1, #12]       ;                                  E581000C 0x88
+//          MSR  CPSR_c, #0x13       ; back to SVC, IRQ and FIQ enabled E321F013 0x8c
+//          ADD  R4, R0, #0          ;                                  E2804000 0x90
+// WAIT     ADD  R4, R4, #1          ; background work                  E2844001 0x94
+//          LDR  R5, [R1, #8]        ; wait for one IRQ and one FIQ     E5915008 0x98
+//          LDR  R6, [R1, #12]       ;                                  E591600C 0x9c
+//          ANDS R7, R5, R6          ;                                  E0157006 0xa0
+//          BEQ  WAIT                ;                                  0AFFFFFA 0xa4
+//          MRS  R3, CPSR            ; back in SVC with both enabled    E10F3000 0xa8
+//          AND  R3, R3, #0xFF       ; R3 = 0x13                        E20330FF 0xac
+//          ADD  R2, R5, R6          ; R2 = 2                           E0852006 0xb0
+//          ADD  R2, R2, R3          ; R2 = 21                          E0822003 0xb4
+//          STR  R2, [R0, #96]       ; mem[96] = 21                     E5802060 0xb8
+//          ADD  R2, R0, #7          ;                                  E2802007 0xbc
+//          STR  R2, [R0, #100]      ; mem[100] = 7                     E5802064 0xc0
@@ -0,0 +1,146 @@
+// lsmbench.asm
+// Block transfer benchmark: 8 calls of a routine that saves R3-R11,
+// copies 8 words from 0x200 to 0x220 and restores R3-R11
+// If successful, it writes the sum of the copy (36) to address 96
+// and the value 7 to address 100
+// Needs 1 KB of memory: run testbench with MEM_BYTES = 1024
+//
+// Two versions of the same kernel:
+//   lsmbench.dat       PUSH/POP and LDM/STM
+//   lsmbench_base.dat  one LDR/STR per word
+// Copy either one to memfile.dat to run it in the testbench, which
+// prints the cycle count when it succeeds.
+//
+// The code is longer than 96 bytes, so it branches over the result
+// words at 96 and 100.
+// No cycle counts are given for the two versions: with no simulator
+// at hand neither has been run, at FAST = 0 or 1.
+
+// lsmbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          ADD  SP, R0, #0x400      ; SP = top of memory (1 KB)        E280DB01 0x04
+//          ADD  R1, R0, #0x200      ; R1 = src                         E2801C02 0x08
+//          ADD  R4, R0, #1          ; src = 1, 2, ... 8                E2804001 0x0c
+//          ADD  R5, R0, #2          ;                                  E2805002 0x10
+//          ADD  R6, R0, #3          ;                                  E2806003 0x14
+//          ADD  R7, R0, #4          ;                                  E2807004 0x18
+//          ADD  R8, R0, #5          ;                                  E2808005 0x1c
+//          ADD  R9, R0, #6          ;                                  E2809006 0x20
+//          ADD  R10, R0, #7         ;                                  E280A007 0x24
+//          ADD  R11, R0, #8         ;                                  E280B008 0x28
+//          STMIA R1, {R4-R11}       ; mem[0x200..0x21C] = 1..8         E8810FF0 0x2c
+//          ADD  R12, R0, #8         ; R12 = n = 8 calls                E280C008 0x30
+//          ADD  R3, R0, #36         ; R3 = live value across the calls E2803024 0x34
+// LOOP     PUSH {R3-R11}            ; save registers (prologue)        E92D0FF8 0x38
+//          ADD  R1, R0, #0x200      ; R1 = src                         E2801C02 0x3c
+//          ADD  R2, R0, #0x220      ; R2 = dst                         E2802E22 0x40
+//          LDMIA R1!, {R4-R11}      ; copy 8 words                     E8B10FF0 0x44
+//          STMIA R2!, {R4-R11}      ;                                  E8A20FF0 0x48
+//          POP  {R3-R11}            ; restore registers (epilogue)     E8BD0FF8 0x4c
+//          SUBS R12, R12, #1        ; n--                              E25CC001 0x50
+//          BNE  LOOP                ;                                  1AFFFFF7 0x54
+//          LDMDB R2, {R4-R11}       ; R4..R11 = dst[0..7]              E9120FF0 0x58
+//          B    CONT                ; skip the result words            EA000001 0x5c
+//          .WORD 0                  ; mem[96]                          00000000 0x60
+//          .WORD 0                  ; mem[100]                         00000000 0x64
+// CONT     ADD  R4, R4, R5          ; sum of dst                       E0844005 0x68
+//          ADD  R4, R4, R6          ;                                  E0844006 0x6c
+//          ADD  R4, R4, R7          ;                                  E0844007 0x70
+//          ADD  R4, R4, R8          ;                                  E0844008 0x74
+//          ADD  R4, R4, R9          ;                                  E0844009 0x78
+//          ADD  R4, R4, R10         ;                                  E084400A 0x7c
+//          ADD  R4, R4, R11         ;                                  E084400B 0x80
+//          STR  R4, [R0, #96]       ; mem[96] = 36                     E5804060 0x84
+//          SUBS R4, R4, R3          ; Z = 1 if R3 survived the calls   E0544003 0x88
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x8c
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x90
+
+// lsmbench_base.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          ADD  SP, R0, #0x400      ; SP = top of memory (1 KB)        E280DB01 0x04
+//          ADD  R1, R0, #0x200      ; R1 = src                         E2801C02 0x08
+//          ADD  R4, R0, #1          ; src = 1, 2, ... 8                E2804001 0x0c
+//          ADD  R5, R0, #2          ;                                  E2805002 0x10
+//          ADD  R6, R0, #3          ;                                  E2806003 0x14
+//          ADD  R7, R0, #4          ;                                  E2807004 0x18
+//          ADD  R8, R0, #5          ;                                  E2808005 0x1c
+//          ADD  R9, R0, #6          ;                                  E2809006 0x20
+//          ADD  R10, R0, #7         ;                                  E280A007 0x24
+//          ADD  R11, R0, #8         ;                                  E280B008 0x28
+//          STR  R4, [R1, #0]        ; mem[0x200..0x21C] = 1..8         E5814000 0x2c
+//          STR  R5, [R1, #4]        ;                                  E5815004 0x30
+//          STR  R6, [R1, #8]        ;                                  E5816008 0x34
+//          STR  R7, [R1, #12]       ;                                  E581700C 0x38
+//          STR  R8, [R1, #16]       ;                                  E5818010 0x3c
+//          STR  R9, [R1, #20]       ;                                  E5819014 0x40
+//          STR  R10, [R1, #24]      ;                                  E581A018 0x44
+//          STR  R11, [R1, #28]      ;                                  E581B01C 0x48
+//          ADD  R12, R0, #8         ; R12 = n = 8 calls                E280C008 0x4c
+//          ADD  R3, R0, #36         ; R3 = live value across the calls E2803024 0x50
+// LOOP     SUB  SP, SP, #36         ; save registers (prologue)        E24DD024 0x54
+//          STR  R3, [SP, #0]        ;                                  E58D3000 0x58
+//          B    CONT                ; skip the result words            EA000001 0x5c
+//          .WORD 0                  ; mem[96]                          00000000 0x60
+//          .WORD 0                  ; mem[100]                         00000000 0x64
+// CONT     STR  R4, [SP, #4]        ;                                  E58D4004 0x68
+//          STR  R5, [SP, #8]        ;                                  E58D5008 0x6c
+//          STR  R6, [SP, #12]       ;                                  E58D600C 0x70
+//          STR  R7, [SP, #16]       ;                                  E58D7010 0x74
+//          STR  R8, [SP, #20]       ;                                  E58D8014 0x78
+//          STR  R9, [SP, #24]       ;                                  E58D9018 0x7c
+//          STR  R10, [SP, #28]      ;                                  E58DA01C 0x80
+//          STR  R11, [SP, #32]      ;                                  E58DB020 0x84
+//          ADD  R1, R0, #0x200      ; R1 = src                         E2801C02 0x88
+//          ADD  R2, R0, #0x220      ; R2 = dst                         E2802E22 0x8c
+//          LDR  R4, [R1, #0]        ; copy 8 words                     E5914000 0x90
+//          LDR  R5, [R1, #4]        ;                                  E5915004 0x94
+//          LDR  R6, [R1, #8]        ;                                  E5916008 0x98
+//          LDR  R7, [R1, #12]       ;                                  E591700C 0x9c
+//          LDR  R8, [R1, #16]       ;                                  E5918010 0xa0
+//          LDR  R9, [R1, #20]       ;                                  E5919014 0xa4
+//          LDR  R10, [R1, #24]      ;                                  E591A018 0xa8
+//          LDR  R11, [R1, #28]      ;                                  E591B01C 0xac
+//          STR  R4, [R2, #0]        ;                                  E5824000 0xb0
+//          STR  R5, [R2, #4]        ;                                  E5825004 0xb4
+//          STR  R6, [R2, #8]        ;                                  E5826008 0xb8
+//          STR  R7, [R2, #12]       ;                                  E582700C 0xbc
+//          STR  R8, [R2, #16]       ;                                  E5828010 0xc0
+//          STR  R9, [R2, #20]       ;                                  E5829014 0xc4
+//          STR  R10, [R2, #24]      ;                                  E582A018 0xc8
+//          STR  R11, [R2, #28]      ;                                  E582B01C 0xcc
+//          ADD  R1, R1, #32         ;                                  E2811020 0xd0
+//          ADD  R2, R2, #32         ;                                  E2822020 0xd4
+//          LDR  R3, [SP, #0]        ; restore registers (epilogue)     E59D3000 0xd8
+//          LDR  R4, [SP, #4]        ;                                  E59D4004 0xdc
+//          LDR  R5, [SP, #8]        ;                                  E59D5008 0xe0
+//          LDR  R6, [SP, #12]       ;                                  E59D600C 0xe4
+//          LDR  R7, [SP, #16]       ;                                  E59D7010 0xe8
+//          LDR  R8, [SP, #20]       ;                                  E59D8014 0xec
+//          LDR  R9, [SP, #24]       ;                                  E59D9018 0xf0
+//          LDR  R10, [SP, #28]      ;                                  E59DA01C 0xf4
+//          LDR  R11, [SP, #32]      ;                                  E59DB020 0xf8
+//          ADD  SP, SP, #36         ;                                  E28DD024 0xfc
+//          SUBS R12, R12, #1        ; n--                              E25CC001 0x100
+//          BNE  LOOP                ;                                  1AFFFFD2 0x104
+//          SUB  R2, R2, #32         ;                                  E2422020 0x108
+//          LDR  R4, [R2, #0]        ; R4..R11 = dst[0..7]              E5924000 0x10c
+//          LDR  R5, [R2, #4]        ;                                  E5925004 0x110
+//          LDR  R6, [R2, #8]        ;                                  E5926008 0x114
+//          LDR  R7, [R2, #12]       ;                                  E592700C 0x118
+//          LDR  R8, [R2, #16]       ;                                  E5928010 0x11c
+//          LDR  R9, [R2, #20]       ;                                  E5929014 0x120
+//          LDR  R10, [R2, #24]      ;                                  E592A018 0x124
+//          LDR  R11, [R2, #28]      ;                                  E592B01C 0x128
+//          ADD  R4, R4, R5          ; sum of dst                       E0844005 0x12c
+//          ADD  R4, R4, R6          ;                                  E0844006 0x130
+//          ADD  R4, R4, R7          ;                                  E0844007 0x134
+//          ADD  R4, R4, R8          ;                                  E0844008 0x138
+//          ADD  R4, R4, R9          ;                                  E0844009 0x13c
+//          ADD  R4, R4, R10         ;                                  E084400A 0x140
+//          ADD  R4, R4, R11         ;                                  E084400B 0x144
+//          STR  R4, [R0, #96]       ; mem[96] = 36                     E5804060 0x148
+//          SUBS R4, R4, R3          ; Z = 1 if R3 survived the calls   E0544003 0x14c
+//          ADDEQ R7, R0, #7         ; R7 = 7                           02807007 0x150
+//          STR  R7, [R0, #100]      ; mem[100] = 7                     E5807064 0x154
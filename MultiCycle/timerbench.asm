@@ -0,0 +1,53 @@
+// timerbench.asm
+// Port of Timers/private_timer_polling.c to the multicycle core and
+// its scu_timer and gpio peripherals (see arm_multi.sv):
+//   XScuTimer_LoadTimer, _EnableAutoReload, _SetPrescaler, _Start and
+//   _GetCounterValue become accesses to the timer at 0xFFFFF000,
+//   XGpio_SetDataDirection and _DiscreteWrite to the GPIO at
+//   0xFFFFF200. The one second offset is scaled down to 64 counts,
+//   so each period polls for 64 * (TIMER_PRESCALER + 1) = 256 cycles
+//   plus the loop. The testbench prints the cycle of every LED change
+//   and the cycles since the previous one.
+// Unlike the C it stops after 4 periods: it writes the final LED
+// value (9) to address 96 and the value 7 to address 100.
+// The core has no CMP or MVN: SUBS sets C for CntValue >= offset and
+// ~led is 0xFFFFFFFF - led.
+
+// timerbench.dat
+
+// MAIN     SUB  R0, R15, R15        ; R0 = 0                           E04F000F 0x00
+//          SUB  R10, R0, #0x1000    ; R10 = 0xFFFFF000, private timer  E240AA01 0x04
+//          ADD  R11, R10, #0x200    ; R11 = 0xFFFFF200, GPIO           E28ABC02 0x08
+//          STR  R0, [R11, #4]       ; SetDataDirection(CH1, 0): LEDs out E58B0004 0x0c
+//          SUB  R2, R0, #1          ; TIMER_LOAD_VALUE = 0xFFFFFFFF    E2402001 0x10
+//          STR  R2, [R10]           ; LoadTimer                        E58A2000 0x14
+//          LDR  R1, [R10, #8]       ; EnableAutoReload                 E59A1008 0x18
+//          ORR  R1, R1, #2          ;                                  E3811002 0x1c
+//          STR  R1, [R10, #8]       ;                                  E58A1008 0x20
+//          LDR  R1, [R10, #8]       ; SetPrescaler(TIMER_PRESCALER = 3) E59A1008 0x24
+//          ORR  R1, R1, #0x300      ;                                  E3811C03 0x28
+//          STR  R1, [R10, #8]       ;                                  E58A1008 0x2c
+//          LDR  R1, [R10, #8]       ; Start                            E59A1008 0x30
+//          ORR  R1, R1, #1          ;                                  E3811001 0x34
+//          STR  R1, [R10, #8]       ;                                  E58A1008 0x38
+//          LDR  R3, [R10, #4]       ; CntValue = GetCounterValue       E59A3004 0x3c
+//          SUB  R4, R0, #64         ; TMR_OFFSET = 2^32 - 64           E2404040 0x40
+//          ADD  R5, R0, #9          ; led = LED (X00X)                 E2805009 0x44
+//          ADD  R6, R0, #4          ; 4 periods (the C loops forever)  E2806004 0x48
+//          B    LOOP                ; skip the result words            EA000005 0x4c
+// FINISH   STR  R5, [R0, #96]       ; mem[96] = led = 9                E5805060 0x50
+//          ADD  R1, R0, #7          ;                                  E2801007 0x54
+//          STR  R1, [R0, #100]      ; mem[100] = 7                     E5801064 0x58
+// HALT     B    HALT                ;                                  EAFFFFFE 0x5c
+//          .WORD 0                  ; mem[96]                          00000000 0x60
+//          .WORD 0                  ; mem[100]                         00000000 0x64
+// LOOP     STR  R2, [R10]           ; LoadTimer                        E58A2000 0x68
+//          LDR  R3, [R10, #4]       ; CntValue = GetCounterValue       E59A3004 0x6c
+// POLL     LDR  R3, [R10, #4]       ; while (CntValue >= TMR_OFFSET)   E59A3004 0x70
+//          SUBS R7, R3, R4          ; CntValue = GetCounterValue       E0537004 0x74
+//          BCS  POLL                ;                                  2AFFFFFC 0x78
+//          SUB  R5, R2, R5          ; led = ~led                       E0425005 0x7c
+//          STR  R5, [R11]           ; DiscreteWrite(CH1, led)          E58B5000 0x80
+//          SUBS R6, R6, #1          ;                                  E2566001 0x84
+//          BNE  LOOP                ;                                  1AFFFFF6 0x88
+//          B    FINISH              ;                                  EAFFFFEF 0x8c
@@ -0,0 +1,197 @@
+/*
+ * memload.c
+ *
+ *  Program image loader for the ARM core testbenches (DPI-C)
+ */
+
+/********************************************************************************************
+ *
+ * The memories in ARM_SingleCycle/arm_single.sv and MultiCycle/arm_multi.sv load memfile.dat
+ * with $readmemh by default. When the simulation is compiled with +define+MEMLOAD_DPI and
+ * started with +image=<file>, they load <file> through these functions instead:
+ *
+ *   memload_open(path, base, &lo, &hi)	maps the file with mmap. An ELF32 file is placed at
+ *					the physical addresses of its PT_LOAD segments, any
+ *					other file is taken as a raw binary placed at base.
+ *					Returns 0 and the byte range [lo, hi) covered by the
+ *					image, or -1 on error.
+ *   memload_word(addr)			returns the little-endian word at byte address addr
+ *					(0 outside the image, e.g. .bss)
+ *   memload_close()			unmaps the file
+ *
+ * The file is never copied: the memories read the words they need straight from the
+ * mapping, so multi-megabyte images load in one pass.
+ *
+ * memload.svh holds the SystemVerilog side. Build with the simulator's DPI-C flow, e.g.
+ *   Vivado:   xsc memload.c ; xvlog -sv -d MEMLOAD_DPI -i ../SimLoader ... ; xelab -sv_lib dpi ...
+ *   Questa:   vlog +define+MEMLOAD_DPI +incdir+../SimLoader ... ../SimLoader/memload.c
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include <elf.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Definitions */
+#define MAX_SEGMENTS	16
+
+/* Loadable pieces of the image */
+typedef struct {
+	uint32_t addr;		/* first byte address */
+	uint32_t size;		/* bytes present in the file */
+	const uint8_t *data;	/* start of the bytes in the mapping */
+} segment_t;
+
+/* Mapped file */
+static const uint8_t *image;
+static size_t image_size;
+static segment_t segments[MAX_SEGMENTS];
+static int nsegments;
+
+/* Function Prototypes */
+int memload_open(const char *path, int base, int *lo, int *hi);
+int memload_word(int addr);
+void memload_close(void);
+static int load_elf(uint32_t *lo, uint32_t *hi);
+
+
+/*****************************************************************************
+ * Function: memload_open()
+ *
+ * Maps the image and records its loadable segments
+ *
+ *****************************************************************************/
+int memload_open(const char *path, int base, int *lo, int *hi)
+{
+	struct stat st;
+	uint32_t first, last;
+	int fd;
+
+	memload_close();
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		close(fd);
+		return -1;
+	}
+
+	image_size = st.st_size;
+	image = mmap(NULL, image_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED) {
+		image = NULL;
+		return -1;
+	}
+
+	if (image_size >= sizeof(Elf32_Ehdr) && memcmp(image, ELFMAG, SELFMAG) == 0) {
+		if (load_elf(&first, &last) != 0) {
+			memload_close();
+			return -1;
+		}
+	} else {
+		/* Raw binary at base */
+		segments[0].addr = (uint32_t)base;
+		segments[0].size = image_size;
+		segments[0].data = image;
+		nsegments = 1;
+		first = (uint32_t)base;
+		last = (uint32_t)base + image_size;
+	}
+
+	*lo = (int)first;
+	*hi = (int)last;
+	return 0;
+}
+
+
+/*****************************************************************************
+ * Function: load_elf()
+ *
+ * Collects the PT_LOAD segments of a little-endian ELF32 file
+ *
+ *****************************************************************************/
+static int load_elf(uint32_t *lo, uint32_t *hi)
+{
+	const Elf32_Ehdr *eh = (const Elf32_Ehdr *)image;
+	const Elf32_Phdr *ph;
+	int i;
+
+	if (eh->e_ident[EI_CLASS] != ELFCLASS32 || eh->e_ident[EI_DATA] != ELFDATA2LSB)
+		return -1;
+	if (eh->e_phoff + (size_t)eh->e_phnum * sizeof(Elf32_Phdr) > image_size)
+		return -1;
+
+	*lo = 0xFFFFFFFF;
+	*hi = 0;
+	nsegments = 0;
+	ph = (const Elf32_Phdr *)(image + eh->e_phoff);
+	for (i = 0; i < eh->e_phnum; i++, ph++) {
+		if (ph->p_type != PT_LOAD || ph->p_memsz == 0)
+			continue;
+		if (nsegments == MAX_SEGMENTS || ph->p_offset + (size_t)ph->p_filesz > image_size)
+			return -1;
+
+		segments[nsegments].addr = ph->p_paddr;
+		segments[nsegments].size = ph->p_filesz;
+		segments[nsegments].data = image + ph->p_offset;
+		nsegments++;
+
+		if (ph->p_paddr < *lo)
+			*lo = ph->p_paddr;
+		if (ph->p_paddr + ph->p_memsz > *hi)
+			*hi = ph->p_paddr + ph->p_memsz;
+	}
+
+	return (nsegments == 0) ? -1 : 0;
+}
+
+
+/*****************************************************************************
+ * Function: memload_word()
+ *
+ * Returns the word at a byte address, assembled byte by byte so segments
+ * need not be word aligned
+ *
+ *****************************************************************************/
+int memload_word(int addr)
+{
+	uint32_t a = (uint32_t)addr & ~3u;
+	uint32_t word = 0;
+	int i, b;
+
+	for (i = 0; i < nsegments; i++) {
+		const segment_t *s = &segments[i];
+
+		for (b = 0; b < 4; b++) {
+			uint32_t off = a + b - s->addr;
+
+			if (off < s->size)
+				word |= (uint32_t)s->data[off] << (8 * b);
+		}
+	}
+
+	return (int)word;
+}
+
+
+/*****************************************************************************
+ * Function: memload_close()
+ *
+ * Releases the mapping
+ *
+ *****************************************************************************/
+void memload_close(void)
+{
+	if (image != NULL)
+		munmap((void *)image, image_size);
+	image = NULL;
+	image_size = 0;
+	nsegments = 0;
+}
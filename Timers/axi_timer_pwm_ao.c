@@ -0,0 +1,310 @@
+/*
+ * axi_timer_pwm_ao.c
+ *
+ *  Sine pwm (spwm) of axi_timer_pwm_student.c on the active objects of Common/ao.h
+ */
+
+/********************************************************************************************
+ * Same output as axi_timer_pwm_student.c: a sine pwm on pin T14 at 1 Hz, 60 Hz, 100 Hz,
+ * 500 Hz or 1 kHz selected with the switches, the table read at the Private Timer rate.
+ * Instead of the PrivateTimerHit flag and the loop in main, the work is split in two
+ * active objects:
+ *
+ *   Pwm   (priority 2)	SIG_TICK from the Private Timer handler: next table point to the
+ *			AXI Timer. SIG_RATE from Control: new table step.
+ *   Control (priority 1)	SIG_SWITCH from the GPIO handler: LEDs, Private Timer load, table
+ *			step for Pwm, and its own statistics. SIG_REPORT from Pwm about
+ *			once a second: prints the statistics of Pwm.
+ *
+ * The handlers only clear their interrupt and post. A tick that comes while the previous
+ * one is still waiting is queued, not merged into a flag, and a tick that finds the queue
+ * full is counted as lost in the report. A report is one line, shorter than the UART FIFO,
+ * so printing it does not hold Pwm back.
+ *
+ * HW platform: that of axi_timer_pwm_student.c. Build with ../Common/ao.c.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "xscutimer.h" // API library for the Private Timer
+#include "xtmrctr.h"  //AXI Timer API
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "ao.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds and sw */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define SW_CHANNEL 		2				/* GPIO port 2 for SWITCHES */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+#define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID 	/* Device ID for Private Timer */
+#define TMRCTR_DEVICE_ID	XPAR_TMRCTR_0_DEVICE_ID		/* AXI TMR device ID */
+
+/* Interruption ID definitions */
+#define SW_INT_MASK		XGPIO_IR_CH2_MASK
+#define IntC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID 	// GIC device ID
+#define IntC_GPIO_INTERRUPT_ID	XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR 	// GPIO Interrupt ID
+#define PTIMER_INTERRUPT_ID	XPAR_SCUTIMER_INTR          	// Private Timer Interruption ID
+
+/* Some constant definitions */
+#define PERIPHCLK_HZ		(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define TIMER_PRESCALER		1
+#define PWM_PERIOD              12500    /* PWM period of 80Khz in ns */
+#define SINE_TABLE_SIZE		50 	/* Size of Sine Table */
+
+/* Private Timer load for a table read rate, as in the student work #1 */
+#define TIMER_LOAD(rate)	(PERIPHCLK_HZ / (TIMER_PRESCALER + 1) / (rate) - 1)
+
+/* Signals */
+enum {
+	SIG_TICK = AO_SIG_USER,		/* Pwm: read the next table point */
+	SIG_RATE,			/* Pwm: Arg reads per second << 16 | table step */
+	SIG_SWITCH,			/* Control: Arg switch value */
+	SIG_REPORT			/* Control: print statistics */
+};
+
+/************************** Hardware Instances  ******************************/
+
+XGpio GpioInst;				/* Instance of the AXI GPIO */
+XTmrCtr TimerCounterInst;		/* Instance of the AXI Timer */
+XScuTimer PrivateTimerInstance;		/* Cortex A9 Scu Private Timer Instance */
+XScuGic IntC;				/* Instance of the Interrupt Controller */
+
+/* pwm high time SINE_TABLE_SIZE sine values @f_pwm = 1 KHz, from axi_timer_pwm_student.c */
+const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,842274,
+				885257,922164,952414,975528,991144,999013,999013,991144,
+				975528,952414,922164,885257,842274,793893,740877,684062,
+				624345,562667,500000,437333,375655,315938,259123,206107,
+				157726,114743,77836,47586,24472,8856,987,987,8856,24472,
+				47586,77836,114743,157726,206107,259123,315938,375655,437333};
+
+/* Active objects and their queues */
+static ao_t Pwm, Control;
+static ao_event_t PwmQueue[32];
+static ao_event_t ControlQueue[8];
+
+/**************  Function Prototypes **************/
+
+static void SW_Intr_Handler(void *InstancePtr);
+static void PrivateTimerIntrHandler(void *InstancePtr);
+static void PwmHandler(ao_t *Me, const ao_event_t *Event);
+static void ControlHandler(ao_t *Me, const ao_event_t *Event);
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr, XScuTimer *TimerInstancePtr);
+
+
+/*************** Main function ********************/
+int main(void){
+	XScuTimer_Config *ConfigPtr;
+	int Status;
+
+	/* Gpio: LEDs out, switches in */
+	Status = XGpio_Initialize(&GpioInst, GPIO_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("GPIO Config failed!\r\n");
+		return XST_FAILURE;
+	}
+	XGpio_SetDataDirection(&GpioInst, LED_CHANNEL, 0x0);
+	XGpio_SetDataDirection(&GpioInst, SW_CHANNEL, 0xf);
+
+	/* AXI Timer in PWM mode */
+	Status = XTmrCtr_Initialize(&TimerCounterInst, TMRCTR_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("AXI Timer Config failed!\r\n");
+		return XST_FAILURE;
+	}
+
+	/* Private Timer: auto reload, load set by Control */
+	ConfigPtr = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	XScuTimer_CfgInitialize(&PrivateTimerInstance, ConfigPtr, ConfigPtr->BaseAddr);
+	XScuTimer_SetPrescaler(&PrivateTimerInstance, TIMER_PRESCALER);
+	XScuTimer_EnableAutoReload(&PrivateTimerInstance);
+
+	/* Objects first: the handlers post to them as soon as interrupts are on */
+	AO_Start(&Pwm, 2, PwmHandler, PwmQueue, 32);
+	AO_Start(&Control, 1, ControlHandler, ControlQueue, 8);
+	AO_Post(&Control, SIG_SWITCH, XGpio_DiscreteRead(&GpioInst, SW_CHANNEL));
+
+	Status = IntCInitFunction(&IntC, IntC_DEVICE_ID, &GpioInst, &PrivateTimerInstance);
+	if (Status != XST_SUCCESS) {
+		xil_printf("Interruption configuration failed!\r\n");
+		return XST_FAILURE;
+	}
+	xil_printf("Interruption configuration success!\r\n");
+
+	AO_Run();
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* Pwm: one table point per tick */
+static void PwmHandler(ao_t *Me, const ao_event_t *Event)
+{
+	static u32 HighTime[SINE_TABLE_SIZE];	/* table scaled to PWM_PERIOD */
+	static u32 Pos, Step = 1, Ticks, Rate;
+	int i;
+
+	switch (Event->Sig) {
+		case AO_SIG_INIT:
+			for (i = 0; i < SINE_TABLE_SIZE; i++)
+				HighTime[i] = (u32)(((u64)sine[i] * PWM_PERIOD + 500000) / 1000000);
+			XTmrCtr_PwmDisable(&TimerCounterInst);
+			XTmrCtr_PwmConfigure(&TimerCounterInst, PWM_PERIOD, HighTime[0]);
+			XTmrCtr_PwmEnable(&TimerCounterInst);
+			break;
+
+		case SIG_TICK:
+			XTmrCtr_PwmDisable(&TimerCounterInst);
+			XTmrCtr_PwmConfigure(&TimerCounterInst, PWM_PERIOD, HighTime[Pos]);
+			XTmrCtr_PwmEnable(&TimerCounterInst);
+
+			Pos += Step;
+			if (Pos >= SINE_TABLE_SIZE)
+				Pos -= SINE_TABLE_SIZE;
+
+			if (++Ticks >= Rate) {
+				Ticks = 0;
+				AO_Post(&Control, SIG_REPORT, 0);
+			}
+			break;
+
+		case SIG_RATE:
+			/* Arg: table step in the low half, reads per second in the high half */
+			Step = Event->Arg & 0xFFFF;
+			Rate = Event->Arg >> 16;
+			Pos = 0;
+			Ticks = 0;
+			break;
+	}
+}
+
+
+/* Control: switches to frequency, and the reports */
+static void ControlHandler(ao_t *Me, const ao_event_t *Event)
+{
+	u32 Rate, Step;
+
+	switch (Event->Sig) {
+		case SIG_SWITCH:
+			XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, Event->Arg);
+
+			switch (Event->Arg) {
+				case 0x0:
+					Rate = 3000; Step = 1;	// 60 Hz sine wave - all 50 points
+					break;
+				case 0x1:
+					Rate = 5000; Step = 1;	// 100 Hz sine wave - all 50 points
+					break;
+				case 0x2:
+					Rate = 5000; Step = 5;	// 500 Hz sine wave - 10 points
+					break;
+				case 0x3:
+					Rate = 10000; Step = 5;	// 1 kHz sine wave - 10 points
+					break;
+				default:
+					Rate = 50; Step = 1;	// 1 Hz sine wave - all 50 points
+			}
+
+			XScuTimer_Stop(&PrivateTimerInstance);
+			XScuTimer_LoadTimer(&PrivateTimerInstance, TIMER_LOAD(Rate));
+			AO_Post(&Pwm, SIG_RATE, (Rate << 16) | Step);
+			XScuTimer_Start(&PrivateTimerInstance);
+
+			AO_Report(Me, "Control");
+			break;
+
+		case SIG_REPORT:
+			AO_Report(&Pwm, "Pwm");
+			break;
+	}
+}
+
+
+/* Switches changed: post the new value, nothing else */
+static void SW_Intr_Handler(void *InstancePtr)
+{
+	XGpio *GpioPtr = (XGpio *)InstancePtr;
+
+	if ((XGpio_InterruptGetStatus(GpioPtr) & SW_INT_MASK) != SW_INT_MASK)
+		return;
+
+	AO_Post(&Control, SIG_SWITCH, XGpio_DiscreteRead(GpioPtr, SW_CHANNEL));
+
+	(void)XGpio_InterruptClear(GpioPtr, SW_INT_MASK);
+}
+
+
+/* Private Timer Interrupt Handler: one tick per table point */
+static void PrivateTimerIntrHandler(void *InstancePtr)
+{
+	XScuTimer_ClearInterruptStatus((XScuTimer *)InstancePtr);
+
+	AO_Post(&Pwm, SIG_TICK, 0);
+}
+
+
+/********** Interrupt setup and handler connection **********/
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr, XScuTimer *TimerInstancePtr)
+{
+	XScuGic_Config *IntCConfig;
+	int status;
+
+	/* Interrupt controller initialization and success check */
+	IntCConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(IntCtrlPtr, IntCConfig, IntCConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Gpio Handler connection */
+	status = XScuGic_Connect(IntCtrlPtr,
+				IntC_GPIO_INTERRUPT_ID,
+				(Xil_ExceptionHandler)SW_Intr_Handler,
+				(void *)GpioInstancePtr);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Private Timer Handler connection */
+	status = XScuGic_Connect(IntCtrlPtr, PTIMER_INTERRUPT_ID,
+				(Xil_ExceptionHandler)PrivateTimerIntrHandler,
+				(void *)TimerInstancePtr);
+	if (status != XST_SUCCESS) {
+		return status;
+	}
+
+	/* Enable GPIO interrupts */
+	XGpio_InterruptEnable(GpioInstancePtr, SW_INT_MASK);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+	/* Enable Private Timer interrupts */
+	XScuTimer_EnableInterrupt(TimerInstancePtr);
+
+	/* Enable GIC */
+	XScuGic_Enable(IntCtrlPtr, PTIMER_INTERRUPT_ID);
+	XScuGic_Enable(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID);
+
+	/* Initialize the exception table */
+	Xil_ExceptionInit();
+
+	/* Enable Exception handlers */
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				(Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				IntCtrlPtr);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+} /* End of IntCInitFunction */
@@ -0,0 +1,514 @@
+/*
+ * axi_timer_pwm_prio.c
+ *
+ *  Sine pwm (spwm) of axi_timer_pwm_student.c with GIC priorities, nesting or FIQ
+ */
+
+/********************************************************************************************
+ * Same output as axi_timer_pwm_student.c: a sine pwm on pin T14 at 1 Hz, 60 Hz, 100 Hz,
+ * 500 Hz or 1 kHz selected with the switches. The Private Timer handler writes the next
+ * table point straight into the AXI Timer high time register (TLR1, taken at the next PWM
+ * period), so the time from the timer event to that write is the PWM update jitter. The
+ * handler measures it as Private Timer ticks since the reload, and main prints the range
+ * about once a second.
+ *
+ * SW_Intr_Handler is slow on purpose: SW_WORK_US stands for the driver calls and prints
+ * of a real handler. To toggle the switches faster than by hand, main sets the switch
+ * interrupt pending in the GIC every STRESS_US (0: only the real switches).
+ *
+ * Interrupt configurations, chosen at build time:
+ *
+ *   default		both sources at the Xilinx default priority, no nesting: a tick that
+ *			comes during SW_Intr_Handler waits for it to finish
+ *   PRIO_NESTED	Private Timer at PTIMER_PRIORITY, above the switches; SW_Intr_Handler
+ *			re-enables IRQ for its slow part (Xil_EnableNestedInterrupts), so the
+ *			GIC lets the timer preempt it
+ *   PRIO_FIQ		Private Timer in GIC group 0, signalled as FIQ, everything else in
+ *			group 1 as IRQ. The FIQ vector branches to FiqPwmHandler, a few
+ *			instructions of assembly on the banked FIQ registers: no stacking, no
+ *			dispatcher, and it preempts any IRQ handler
+ *
+ * HW platform: that of axi_timer_pwm_student.c. Build with -O2 and ../Common on the include
+ * path.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include <stddef.h>
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "xscutimer.h" // API library for the Private Timer
+#include "xtmrctr.h"  //AXI Timer API
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xil_cache.h"
+#include "mmio.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds and sw */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define SW_CHANNEL 		2				/* GPIO port 2 for SWITCHES */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+#define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID 	/* Device ID for Private Timer */
+#define TMRCTR_DEVICE_ID	XPAR_TMRCTR_0_DEVICE_ID		/* AXI TMR device ID */
+#define TMRCTR_HZ		XPAR_TMRCTR_0_CLOCK_FREQ_HZ	/* AXI Timer clock */
+
+/* Interruption ID definitions */
+#define SW_INT_MASK		XGPIO_IR_CH2_MASK
+#define IntC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID 	// GIC device ID
+#define IntC_GPIO_INTERRUPT_ID	XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR 	// GPIO Interrupt ID
+#define PTIMER_INTERRUPT_ID	XPAR_SCUTIMER_INTR          	// Private Timer Interruption ID
+
+/* GIC priorities, 0 highest, in steps of 8 */
+#define DEFAULT_PRIORITY	0xA0		/* what XScuGic_Connect leaves */
+#if defined(PRIO_NESTED) || defined(PRIO_FIQ)
+#define PTIMER_PRIORITY		0x10
+#else
+#define PTIMER_PRIORITY		DEFAULT_PRIORITY
+#endif
+#define SW_PRIORITY		DEFAULT_PRIORITY
+
+/* Some constant definitions */
+#define PERIPHCLK_HZ		(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define GTIMER_HZ		PERIPHCLK_HZ
+#define TIMER_PRESCALER		0	/* one tick per PERIPHCLK: 3 ns resolution */
+#define PWM_PERIOD              12500    /* PWM period of 80Khz in ns */
+#define SINE_TABLE_SIZE		50 	/* Size of Sine Table */
+#define SW_WORK_US		50	/* slow part of SW_Intr_Handler */
+#define STRESS_US		200	/* switch interrupt period, 0 off */
+
+/* Private Timer load for a table read rate, as in the student work #1 */
+#define TIMER_LOAD(rate)	(PERIPHCLK_HZ / (TIMER_PRESCALER + 1) / (rate) - 1)
+
+/* Private Timer ticks to ns */
+#define TICKS_NS(t)		((t) * 1000 / (PERIPHCLK_HZ / (TIMER_PRESCALER + 1) / 1000000))
+
+/************************** Hardware Instances  ******************************/
+
+XGpio GpioInst;				/* Instance of the AXI GPIO */
+XTmrCtr TimerCounterInst;		/* Instance of the AXI Timer */
+XScuTimer PrivateTimerInstance;		/* Cortex A9 Scu Private Timer Instance */
+XScuGic IntC;				/* Instance of the Interrupt Controller */
+
+/* pwm high time SINE_TABLE_SIZE sine values @f_pwm = 1 KHz, from axi_timer_pwm_student.c */
+const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,842274,
+				885257,922164,952414,975528,991144,999013,999013,991144,
+				975528,952414,922164,885257,842274,793893,740877,684062,
+				624345,562667,500000,437333,375655,315938,259123,206107,
+				157726,114743,77836,47586,24472,8856,987,987,8856,24472,
+				47586,77836,114743,157726,206107,259123,315938,375655,437333};
+
+/* The table as TLR1 values for PWM_PERIOD */
+static u32 HighLoad[SINE_TABLE_SIZE];
+
+/*
+ * State of the Private Timer handler. FiqPwmHandler reaches the fields by the PWM_*
+ * offsets below, checked against the struct at compile time; the switch handler changes
+ * it with IRQ and FIQ masked
+ */
+typedef struct {
+	UINTPTR Tlr;		/* AXI Timer TLR1 */
+	const u32 *Table;	/* HighLoad */
+	u32 Pos;		/* next table point */
+	u32 Step;		/* table points per tick */
+	u32 Size;		/* SINE_TABLE_SIZE */
+	u32 Reload;		/* Private Timer load */
+	u32 Count;		/* updates since the last report */
+	u32 LateMin;		/* ticks from the timer event to the update */
+	u32 LateMax;
+	UINTPTR Gic;		/* GIC CPU interface */
+	UINTPTR Timer;		/* Private Timer */
+} pwm_t;
+
+#define PWM_TLR		0
+#define PWM_TABLE	4
+#define PWM_POS		8
+#define PWM_STEP	12
+#define PWM_SIZE	16
+#define PWM_RELOAD	20
+#define PWM_COUNT	24
+#define PWM_LATEMIN	28
+#define PWM_LATEMAX	32
+#define PWM_GIC		36
+#define PWM_TIMER	40
+
+_Static_assert(offsetof(pwm_t, Tlr) == PWM_TLR, "PWM_TLR");
+_Static_assert(offsetof(pwm_t, Table) == PWM_TABLE, "PWM_TABLE");
+_Static_assert(offsetof(pwm_t, Pos) == PWM_POS, "PWM_POS");
+_Static_assert(offsetof(pwm_t, Step) == PWM_STEP, "PWM_STEP");
+_Static_assert(offsetof(pwm_t, Size) == PWM_SIZE, "PWM_SIZE");
+_Static_assert(offsetof(pwm_t, Reload) == PWM_RELOAD, "PWM_RELOAD");
+_Static_assert(offsetof(pwm_t, Count) == PWM_COUNT, "PWM_COUNT");
+_Static_assert(offsetof(pwm_t, LateMin) == PWM_LATEMIN, "PWM_LATEMIN");
+_Static_assert(offsetof(pwm_t, LateMax) == PWM_LATEMAX, "PWM_LATEMAX");
+_Static_assert(offsetof(pwm_t, Gic) == PWM_GIC, "PWM_GIC");
+_Static_assert(offsetof(pwm_t, Timer) == PWM_TIMER, "PWM_TIMER");
+
+pwm_t Pwm;				/* not static: FiqPwmHandler uses it */
+static u32 SwitchValue = ~0u;
+
+/**************  Function Prototypes **************/
+
+static void SW_Intr_Handler(void *InstancePtr);
+static void PrivateTimerIntrHandler(void *InstancePtr);
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr, XScuTimer *TimerInstancePtr);
+static void SetRate(u32 Switches);
+static void Report(void);
+#ifdef PRIO_FIQ
+void FiqPwmHandler(void);
+static int FiqInit(void);
+#endif
+
+
+/*************** Main function ********************/
+int main(void){
+	XScuTimer_Config *ConfigPtr;
+	u32 Now, LastReport, LastStress;
+	int Status, i;
+
+	/* Gpio: LEDs out, switches in */
+	Status = XGpio_Initialize(&GpioInst, GPIO_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("GPIO Config failed!\r\n");
+		return XST_FAILURE;
+	}
+	XGpio_SetDataDirection(&GpioInst, LED_CHANNEL, 0x0);
+	XGpio_SetDataDirection(&GpioInst, SW_CHANNEL, 0xf);
+
+	/* AXI Timer in PWM mode; from here on only TLR1 is written */
+	Status = XTmrCtr_Initialize(&TimerCounterInst, TMRCTR_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("AXI Timer Config failed!\r\n");
+		return XST_FAILURE;
+	}
+	for (i = 0; i < SINE_TABLE_SIZE; i++) {
+		u32 High = (u32)(((u64)sine[i] * PWM_PERIOD / 1000000) * TMRCTR_HZ / 1000000000);
+		HighLoad[i] = High > 2 ? High - 2 : 0;	/* as XTmrCtr_PwmConfigure */
+	}
+	XTmrCtr_PwmDisable(&TimerCounterInst);
+	XTmrCtr_PwmConfigure(&TimerCounterInst, PWM_PERIOD, (u32)((u64)sine[0] * PWM_PERIOD / 1000000));
+	XTmrCtr_PwmEnable(&TimerCounterInst);
+
+	Pwm.Tlr = TMRCTR0_BASE + TMRCTR_TLR(1);
+	Pwm.Table = HighLoad;
+	Pwm.Size = SINE_TABLE_SIZE;
+	Pwm.LateMin = ~0u;
+	Pwm.Gic = GIC_CPU_BASE;
+	Pwm.Timer = SCUTIMER_BASE;
+
+	/* Private Timer: auto reload, load set by SetRate */
+	ConfigPtr = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	XScuTimer_CfgInitialize(&PrivateTimerInstance, ConfigPtr, ConfigPtr->BaseAddr);
+	XScuTimer_SetPrescaler(&PrivateTimerInstance, TIMER_PRESCALER);
+	XScuTimer_EnableAutoReload(&PrivateTimerInstance);
+	SetRate(XGpio_DiscreteRead(&GpioInst, SW_CHANNEL));
+
+	Status = IntCInitFunction(&IntC, IntC_DEVICE_ID, &GpioInst, &PrivateTimerInstance);
+	if (Status != XST_SUCCESS) {
+		xil_printf("Interruption configuration failed!\r\n");
+		return XST_FAILURE;
+	}
+	xil_printf("Interruption configuration success!\r\n");
+
+	/* Report and stress timing from the global timer */
+	mmio_update32(GTIMER_BASE + GTIMER_CONTROL, GTIMER_CONTROL_ENABLE, GTIMER_CONTROL_ENABLE);
+	LastReport = LastStress = gtimer_now32();
+
+	while (1) {
+		Now = gtimer_now32();
+		if (STRESS_US && Now - LastStress >= STRESS_US * (GTIMER_HZ / 1000000)) {
+			LastStress = Now;
+			gic_set_pending(IntC_GPIO_INTERRUPT_ID);
+		}
+		if (Now - LastReport >= GTIMER_HZ) {
+			LastReport = Now;
+			Report();
+		}
+	}
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+/* New rate for the switch value: LEDs, table step and Private Timer load */
+static void SetRate(u32 Switches)
+{
+	u32 Rate, Step, cpsr;
+
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, Switches);
+
+	switch (Switches) {
+		case 0x0:
+			Rate = 3000; Step = 1;	// 60 Hz sine wave - all 50 points
+			break;
+		case 0x1:
+			Rate = 5000; Step = 1;	// 100 Hz sine wave - all 50 points
+			break;
+		case 0x2:
+			Rate = 5000; Step = 5;	// 500 Hz sine wave - 10 points
+			break;
+		case 0x3:
+			Rate = 10000; Step = 5;	// 1 kHz sine wave - 10 points
+			break;
+		default:
+			Rate = 50; Step = 1;	// 1 Hz sine wave - all 50 points
+	}
+
+	/* no tick, IRQ or FIQ, between the timer reload and the state */
+	cpsr = irq_fiq_save();
+	XScuTimer_Stop(&PrivateTimerInstance);
+	XScuTimer_LoadTimer(&PrivateTimerInstance, TIMER_LOAD(Rate));
+	Pwm.Reload = TIMER_LOAD(Rate);
+	Pwm.Step = Step;
+	Pwm.Pos = 0;
+	XScuTimer_Start(&PrivateTimerInstance);
+	irq_restore(cpsr);
+}
+
+
+/* Update count and latency range since the last report, then a new range */
+static void Report(void)
+{
+	u32 Count, Min, Max, cpsr;
+
+	cpsr = irq_fiq_save();
+	Count = Pwm.Count;
+	Min = Pwm.LateMin;
+	Max = Pwm.LateMax;
+	Pwm.Count = 0;
+	Pwm.LateMin = ~0u;
+	Pwm.LateMax = 0;
+	irq_restore(cpsr);
+
+	if (Count == 0)
+		return;
+	printf("%d updates, latency %d..%d ns, jitter %d ns\r\n", Count,
+	       TICKS_NS(Min), TICKS_NS(Max), TICKS_NS(Max - Min));
+}
+
+
+/*
+ * Switches: the work of the student handler, then SW_WORK_US of busy time. With
+ * PRIO_NESTED the busy part runs with IRQ enabled, and a tick preempts it
+ */
+static void SW_Intr_Handler(void *InstancePtr)
+{
+	XGpio *GpioPtr = (XGpio *)InstancePtr;
+	u32 Value, t0;
+
+	Value = XGpio_DiscreteRead(GpioPtr, SW_CHANNEL);
+	if (Value != SwitchValue) {
+		SwitchValue = Value;
+		SetRate(Value);
+	}
+	(void)XGpio_InterruptClear(GpioPtr, SW_INT_MASK);
+
+#ifdef PRIO_NESTED
+	Xil_EnableNestedInterrupts();
+#endif
+	t0 = gtimer_now32();
+	while (gtimer_now32() - t0 < SW_WORK_US * (GTIMER_HZ / 1000000))
+		;
+#ifdef PRIO_NESTED
+	Xil_DisableNestedInterrupts();
+#endif
+}
+
+
+/* Private Timer Interrupt Handler: next table point, and how late it is */
+static void PrivateTimerIntrHandler(void *InstancePtr)
+{
+	u32 Now, Late;
+
+	Now = scutimer_counter(SCUTIMER_BASE);
+	scutimer_clear(SCUTIMER_BASE);
+	mmio_write32(Pwm.Tlr, Pwm.Table[Pwm.Pos]);
+
+	Pwm.Pos += Pwm.Step;
+	if (Pwm.Pos >= Pwm.Size)
+		Pwm.Pos -= Pwm.Size;
+
+	Late = Pwm.Reload - Now;
+	if (Late > Pwm.LateMax)
+		Pwm.LateMax = Late;
+	if (Late < Pwm.LateMin)
+		Pwm.LateMin = Late;
+	Pwm.Count++;
+}
+
+
+/********** Interrupt setup and handler connection **********/
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr, XScuTimer *TimerInstancePtr)
+{
+	XScuGic_Config *IntCConfig;
+	int status;
+	u8 Priority, Trigger;
+
+	/* Interrupt controller initialization and success check */
+	IntCConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(IntCtrlPtr, IntCConfig, IntCConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Gpio Handler connection */
+	status = XScuGic_Connect(IntCtrlPtr,
+				IntC_GPIO_INTERRUPT_ID,
+				(Xil_ExceptionHandler)SW_Intr_Handler,
+				(void *)GpioInstancePtr);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Private Timer Handler connection; not called with PRIO_FIQ */
+	status = XScuGic_Connect(IntCtrlPtr, PTIMER_INTERRUPT_ID,
+				(Xil_ExceptionHandler)PrivateTimerIntrHandler,
+				(void *)TimerInstancePtr);
+	if (status != XST_SUCCESS) {
+		return status;
+	}
+
+	/* Priorities, keeping the trigger types */
+	XScuGic_GetPriorityTriggerType(IntCtrlPtr, PTIMER_INTERRUPT_ID, &Priority, &Trigger);
+	XScuGic_SetPriorityTriggerType(IntCtrlPtr, PTIMER_INTERRUPT_ID, PTIMER_PRIORITY, Trigger);
+	XScuGic_GetPriorityTriggerType(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID, &Priority, &Trigger);
+	XScuGic_SetPriorityTriggerType(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID, SW_PRIORITY, Trigger);
+
+	/* Enable GPIO interrupts */
+	XGpio_InterruptEnable(GpioInstancePtr, SW_INT_MASK);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+	/* Enable Private Timer interrupts */
+	XScuTimer_EnableInterrupt(TimerInstancePtr);
+
+#ifdef PRIO_FIQ
+	status = FiqInit();
+	if (status != XST_SUCCESS) {
+		return status;
+	}
+#endif
+
+	/* Enable GIC */
+	XScuGic_Enable(IntCtrlPtr, PTIMER_INTERRUPT_ID);
+	XScuGic_Enable(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID);
+
+	/* Initialize the exception table */
+	Xil_ExceptionInit();
+
+	/* Enable Exception handlers */
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+				(Xil_ExceptionHandler)XScuGic_InterruptHandler,
+				IntCtrlPtr);
+	Xil_ExceptionEnable();
+#ifdef PRIO_FIQ
+	Xil_ExceptionEnableMask(XIL_EXCEPTION_FIQ);
+#endif
+
+	return XST_SUCCESS;
+} /* End of IntCInitFunction */
+
+
+#ifdef PRIO_FIQ
+
+/*
+ * The Private Timer alone in group 0, signalled as FIQ, and the FIQ vector replaced by a
+ * branch to FiqPwmHandler. Everything else goes to group 1, which the secure CPU interface
+ * still acknowledges on IRQ (ACK_CTL), so XScuGic_InterruptHandler serves it as before
+ */
+static int FiqInit(void)
+{
+	UINTPTR Vector;
+	s32 Offset;
+	u32 Vbar;
+	int id;
+
+	__asm__ volatile("mrc p15, 0, %0, c12, c0, 0" : "=r"(Vbar));
+	Vector = Vbar + 0x1C;
+	Offset = (s32)((UINTPTR)FiqPwmHandler - (Vector + 8));
+	if (Offset < -0x2000000 || Offset >= 0x2000000)
+		return XST_FAILURE;		/* out of reach of a B */
+
+	*(volatile u32 *)Vector = 0xEA000000 | (((u32)Offset >> 2) & 0x00FFFFFF);
+	Xil_DCacheFlushRange(Vector, 4);
+	Xil_ICacheInvalidateRange(Vector, 4);
+	__asm__ volatile("mcr p15, 0, %0, c7, c5, 6\n\tdsb\n\tisb" :: "r"(0) : "memory");
+
+	for (id = 0; id < GIC_IDS; id += 32)
+		mmio_write32(GIC_DIST_BASE + GIC_ICDISR(id), 0xFFFFFFFF);
+	mmio_write32(GIC_DIST_BASE + GIC_ICDISR(PTIMER_INTERRUPT_ID),
+		     ~GIC_BIT(PTIMER_INTERRUPT_ID));
+
+	/* XScuGic_CfgInitialize enables only group 0 in the distributor */
+	mmio_write32(GIC_DIST_BASE + GIC_ICDDCR, GIC_ICDDCR_ENABLE_S | GIC_ICDDCR_ENABLE_NS);
+
+	mmio_update32(GIC_CPU_BASE + GIC_ICCICR,
+		      GIC_ICCICR_ACK_CTL | GIC_ICCICR_FIQ_EN | GIC_ICCICR_ENABLE_NS,
+		      GIC_ICCICR_ACK_CTL | GIC_ICCICR_FIQ_EN | GIC_ICCICR_ENABLE_NS);
+
+	return XST_SUCCESS;
+}
+
+
+/*
+ * PrivateTimerIntrHandler in FIQ mode, on the banked r8-r12 only:
+ *   r8 Pwm, r9 scratch, r10 counter at entry, r11 scratch, r12 interrupt ID
+ */
+#define STR_(x)	#x
+#define STR(x)	STR_(x)
+
+__asm__(
+"	.text\n"
+"	.arm\n"
+"	.align	2\n"
+"	.global	FiqPwmHandler\n"
+"	.type	FiqPwmHandler, %function\n"
+"FiqPwmHandler:\n"
+"	ldr	r8, =Pwm\n"
+"	ldr	r9, [r8, #" STR(PWM_GIC) "]\n"
+"	ldr	r12, [r9, #" STR(GIC_ICCIAR) "]\n"	/* acknowledge */
+"	ldr	r9, [r8, #" STR(PWM_TIMER) "]\n"
+"	ldr	r10, [r9, #" STR(SCUTIMER_COUNTER) "]\n"
+"	mov	r11, #" STR(SCUTIMER_ISR_EVENT) "\n"
+"	str	r11, [r9, #" STR(SCUTIMER_ISR) "]\n"	/* clear the timer event */
+"	ldr	r9, [r8, #" STR(PWM_POS) "]\n"
+"	ldr	r11, [r8, #" STR(PWM_TABLE) "]\n"
+"	ldr	r11, [r11, r9, lsl #2]\n"
+"	ldr	r9, [r8, #" STR(PWM_TLR) "]\n"
+"	str	r11, [r9]\n"				/* PWM high time */
+"	ldr	r9, [r8, #" STR(PWM_POS) "]\n"
+"	ldr	r11, [r8, #" STR(PWM_STEP) "]\n"
+"	add	r9, r9, r11\n"
+"	ldr	r11, [r8, #" STR(PWM_SIZE) "]\n"
+"	cmp	r9, r11\n"
+"	subhs	r9, r9, r11\n"
+"	str	r9, [r8, #" STR(PWM_POS) "]\n"
+"	ldr	r9, [r8, #" STR(PWM_RELOAD) "]\n"
+"	sub	r10, r9, r10\n"				/* ticks since the event */
+"	ldr	r9, [r8, #" STR(PWM_LATEMAX) "]\n"
+"	cmp	r10, r9\n"
+"	strhi	r10, [r8, #" STR(PWM_LATEMAX) "]\n"
+"	ldr	r9, [r8, #" STR(PWM_LATEMIN) "]\n"
+"	cmp	r10, r9\n"
+"	strlo	r10, [r8, #" STR(PWM_LATEMIN) "]\n"
+"	ldr	r9, [r8, #" STR(PWM_COUNT) "]\n"
+"	add	r9, r9, #1\n"
+"	str	r9, [r8, #" STR(PWM_COUNT) "]\n"
+"	ldr	r9, [r8, #" STR(PWM_GIC) "]\n"
+"	str	r12, [r9, #" STR(GIC_ICCEOIR) "]\n"	/* end of interrupt */
+"	subs	pc, lr, #4\n"
+"	.ltorg\n"
+"	.size	FiqPwmHandler, .-FiqPwmHandler\n"
+);
+
+#endif
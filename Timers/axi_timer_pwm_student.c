@@ -48,6 +48,15 @@
 #include "xscugic.h"
 #include "xil_exception.h"
 
+/* Build with USE_OCM, ../Common/hotpath.c and ../Common/lscript_ocm.ld to keep the
+ * handlers and the sine table in OCM, away from the cache misses of the main loop */
+#ifdef USE_OCM
+#include "hotpath.h"
+#else
+#define OCM_TEXT
+#define OCM_RODATA
+#endif
+
 /* Definitions */
 #define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds and sw */
 #define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
@@ -130,7 +139,7 @@ static volatile int   PrivateTimerHit = FALSE;
 */
 
 /* pwm high time SINE_TABLE_SIZE sine values @f_pwm = 1 KHz  */
-const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,842274,
+OCM_RODATA const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,842274,
 				885257,922164,952414,975528,991144,999013,999013,991144,
 				975528,952414,922164,885257,842274,793893,740877,684062,
 				624345,562667,500000,437333,375655,315938,259123,206107,
@@ -141,10 +150,10 @@ const int sine[SINE_TABLE_SIZE]={500000,562667,624345,684062,740877,793893,84227
 /**************  Function Prototypes **************/
 
 /* Interrupt handler for the SW */
-static void SW_Intr_Handler(void *InstancePtr);
+OCM_TEXT static void SW_Intr_Handler(void *InstancePtr);
 
 /* Interrupt handler for the Private Timer */
-static void PrivateTimerIntrHandler(void *InstancePtr);
+OCM_TEXT static void PrivateTimerIntrHandler(void *InstancePtr);
 
 /* Interrupt configuration routines */
 static int IntCInitFunction(XScuGic *IntCtrlPtr,u16 DeviceId, XGpio *GpioInstancePtr, XTmrCtr *AxiTmrInstancePtr,XScuTimer *TimerInstancePtr);
@@ -0,0 +1,165 @@
+/*
+ * dds_spwm.c
+ *
+ *  Driver for the DDS sine PWM generator IP (dds_spwm.sv)
+ */
+
+/********************************************************************************************
+ *
+ * The IP generates the whole SPWM waveform: carrier, sine table and phase accumulator are in
+ * the PL, so the CPU does not touch it between setting changes. The register layout and the
+ * formulas are in dds_spwm.sv:
+ *
+ *   f_pwm = f_clk / PERIOD		f_out = FREQ * f_pwm / 2^32
+ *   high time = PERIOD * (1/2 + AMP/65536 * sin)
+ *
+ * The setters below write the shadow registers only. Nothing changes at the output until
+ * DdsSpwm_Update(), which hands all of them to the generator together at the start of the
+ * next carrier period, so a frequency and amplitude change never produces a half-applied
+ * sample or a cut pulse. Typical use:
+ *
+ *   DdsSpwm_Initialize(&Dds, XPAR_DDS_SPWM_0_S_AXI_BASEADDR, 100000000);
+ *   DdsSpwm_SetCarrier(&Dds, 80000);
+ *   DdsSpwm_SetFrequency(&Dds, 60000);		60 Hz
+ *   DdsSpwm_SetAmplitude(&Dds, 65535);
+ *   DdsSpwm_Update(&Dds, 1);
+ *   DdsSpwm_Start(&Dds);
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "dds_spwm.h"
+
+
+/*****************************************************************************
+ * Function: DdsSpwm_Initialize()
+ *
+ * Stops the output; the settings stay as they were until the next update
+ *
+ *****************************************************************************/
+int DdsSpwm_Initialize(DdsSpwm *InstancePtr, UINTPTR BaseAddress, u32 ClockHz)
+{
+	if (InstancePtr == NULL || ClockHz == 0)
+		return XST_INVALID_PARAM;
+
+	InstancePtr->BaseAddress = BaseAddress;
+	InstancePtr->ClockHz = ClockHz;
+	InstancePtr->Period = DdsSpwm_ReadReg(BaseAddress, DDS_SPWM_PERIOD_OFFSET);
+	InstancePtr->Ctrl = 0;
+	DdsSpwm_WriteReg(BaseAddress, DDS_SPWM_CTRL_OFFSET, 0);
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************
+ * Function: DdsSpwm_SetCarrier()
+ *
+ * Sets the PWM carrier frequency. Set it before the sine frequency, which
+ * is counted in carrier periods
+ *
+ *****************************************************************************/
+int DdsSpwm_SetCarrier(DdsSpwm *InstancePtr, u32 CarrierHz)
+{
+	u32 Period;
+
+	if (CarrierHz == 0)
+		return XST_INVALID_PARAM;
+
+	Period = (InstancePtr->ClockHz + CarrierHz / 2) / CarrierHz;
+	if (Period < DDS_SPWM_PERIOD_MIN || Period > DDS_SPWM_PERIOD_MAX)
+		return XST_INVALID_PARAM;
+
+	InstancePtr->Period = Period;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_PERIOD_OFFSET, Period);
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************
+ * Function: DdsSpwm_SetFrequency()
+ *
+ * Sets the sine frequency in mHz: FREQ = f_out * 2^32 / f_pwm, rounded.
+ * It must stay below half the carrier
+ *
+ *****************************************************************************/
+int DdsSpwm_SetFrequency(DdsSpwm *InstancePtr, u32 MilliHz)
+{
+	u64 PwmMilliHz;
+	u32 Freq;
+
+	PwmMilliHz = (u64)InstancePtr->ClockHz * 1000 / InstancePtr->Period;
+	if ((u64)MilliHz * 2 >= PwmMilliHz)
+		return XST_INVALID_PARAM;
+
+	Freq = (u32)((((u64)MilliHz << 32) + PwmMilliHz / 2) / PwmMilliHz);
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_FREQ_OFFSET, Freq);
+
+	return XST_SUCCESS;
+}
+
+
+/* Amplitude of the sine, 0 (50% duty) to 65535 (full swing) */
+void DdsSpwm_SetAmplitude(DdsSpwm *InstancePtr, u32 Amplitude)
+{
+	if (Amplitude > 0xFFFF)
+		Amplitude = 0xFFFF;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_AMP_OFFSET, Amplitude);
+}
+
+
+/* Phase offset, 2^32 = one turn (0x40000000 = 90 degrees) */
+void DdsSpwm_SetPhase(DdsSpwm *InstancePtr, u32 Phase)
+{
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_PHASE_OFFSET, Phase);
+}
+
+
+/*****************************************************************************
+ * Function: DdsSpwm_Update()
+ *
+ * Applies the shadow registers at the next carrier period start; with
+ * Restart the sine starts again from the PHASE offset
+ *
+ *****************************************************************************/
+void DdsSpwm_Update(DdsSpwm *InstancePtr, int Restart)
+{
+	u32 Ctrl = InstancePtr->Ctrl | DDS_SPWM_CTRL_UPDATE;
+
+	if (Restart)
+		Ctrl |= DDS_SPWM_CTRL_RESTART;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_CTRL_OFFSET, Ctrl);
+}
+
+
+/* One carrier period at most after DdsSpwm_Update() */
+int DdsSpwm_IsUpdatePending(DdsSpwm *InstancePtr)
+{
+	return DdsSpwm_ReadReg(InstancePtr->BaseAddress, DDS_SPWM_STATUS_OFFSET) & 1;
+}
+
+
+void DdsSpwm_Start(DdsSpwm *InstancePtr)
+{
+	InstancePtr->Ctrl |= DDS_SPWM_CTRL_ENABLE;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+void DdsSpwm_Stop(DdsSpwm *InstancePtr)
+{
+	InstancePtr->Ctrl &= ~DDS_SPWM_CTRL_ENABLE;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_CTRL_OFFSET, InstancePtr->Ctrl);
+}
+
+
+/* Inverted output: idle high, high time becomes the low time */
+void DdsSpwm_SetInverted(DdsSpwm *InstancePtr, int Inverted)
+{
+	if (Inverted)
+		InstancePtr->Ctrl |= DDS_SPWM_CTRL_INVERT;
+	else
+		InstancePtr->Ctrl &= ~DDS_SPWM_CTRL_INVERT;
+	DdsSpwm_WriteReg(InstancePtr->BaseAddress, DDS_SPWM_CTRL_OFFSET, InstancePtr->Ctrl);
+}
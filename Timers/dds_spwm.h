@@ -0,0 +1,58 @@
+/*
+ * dds_spwm.h
+ *
+ *  Driver for the DDS sine PWM generator IP (dds_spwm.sv)
+ */
+
+#ifndef DDS_SPWM_H
+#define DDS_SPWM_H
+
+/* Include Files */
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+
+/* Register offsets */
+#define DDS_SPWM_CTRL_OFFSET	0x00	/* enable, update, invert, restart */
+#define DDS_SPWM_PERIOD_OFFSET	0x04	/* carrier period in clock cycles (shadow) */
+#define DDS_SPWM_FREQ_OFFSET	0x08	/* phase increment per carrier period (shadow) */
+#define DDS_SPWM_AMP_OFFSET	0x0C	/* amplitude, 65536 = 1.0 (shadow) */
+#define DDS_SPWM_PHASE_OFFSET	0x10	/* phase offset, 2^32 = one turn (shadow) */
+#define DDS_SPWM_STATUS_OFFSET	0x14	/* update pending */
+#define DDS_SPWM_ACC_OFFSET	0x18	/* phase accumulator */
+#define DDS_SPWM_DUTY_OFFSET	0x1C	/* high time of the current period */
+
+/* CTRL bits */
+#define DDS_SPWM_CTRL_ENABLE	0x1
+#define DDS_SPWM_CTRL_UPDATE	0x2
+#define DDS_SPWM_CTRL_INVERT	0x4
+#define DDS_SPWM_CTRL_RESTART	0x8
+
+#define DDS_SPWM_PERIOD_MIN	8	/* the sine pipeline needs 4 cycles */
+#define DDS_SPWM_PERIOD_MAX	0xFFFF
+
+#define DdsSpwm_ReadReg(BaseAddress, Offset) \
+	Xil_In32((BaseAddress) + (Offset))
+#define DdsSpwm_WriteReg(BaseAddress, Offset, Data) \
+	Xil_Out32((BaseAddress) + (Offset), (Data))
+
+typedef struct {
+	UINTPTR BaseAddress;	/* AXI base address of the IP */
+	u32 ClockHz;		/* AXI clock of the IP */
+	u32 Period;		/* carrier period last set, clock cycles */
+	u32 Ctrl;		/* CTRL without the update bit */
+} DdsSpwm;
+
+/* Function Prototypes */
+int DdsSpwm_Initialize(DdsSpwm *InstancePtr, UINTPTR BaseAddress, u32 ClockHz);
+int DdsSpwm_SetCarrier(DdsSpwm *InstancePtr, u32 CarrierHz);
+int DdsSpwm_SetFrequency(DdsSpwm *InstancePtr, u32 MilliHz);
+void DdsSpwm_SetAmplitude(DdsSpwm *InstancePtr, u32 Amplitude);
+void DdsSpwm_SetPhase(DdsSpwm *InstancePtr, u32 Phase);
+void DdsSpwm_Update(DdsSpwm *InstancePtr, int Restart);
+int DdsSpwm_IsUpdatePending(DdsSpwm *InstancePtr);
+void DdsSpwm_Start(DdsSpwm *InstancePtr);
+void DdsSpwm_Stop(DdsSpwm *InstancePtr);
+void DdsSpwm_SetInverted(DdsSpwm *InstancePtr, int Inverted);
+
+#endif
@@ -0,0 +1,409 @@
+// dds_spwm.sv
+// Sine PWM (SPWM) generator for the PL, direct digital synthesis with
+// AXI4-Lite control
+//
+// Replaces the per-sample AXI timer writes of axi_timer_pwm_student.c:
+// the carrier, the sine table and the phase accumulator are all in
+// hardware, so the CPU writes only when a setting changes.
+//
+// Simulate with Verilator 5 (sine.dat in the working directory)
+//   verilator --binary --timing -Wno-fatal --top-module testbench dds_spwm.sv
+//   obj_dir/Vtestbench
+// or any SystemVerilog simulator, top module testbench.
+// Expect the simulator to print "Simulation succeeded"
+//
+// Status: the frequency and duty check is not done. No simulator was
+// available, so the testbench below has never run, and the f_out and
+// high-time formulas below are design values, not measurements.
+//
+// Synthesis
+//   The carrier counts PERIOD clock cycles (f_pwm = f_clk / PERIOD).
+//   At the start of each carrier period the phase accumulator ACC
+//   advances by FREQ, so
+//     f_out = FREQ * f_pwm / 2^32
+//   (80 kHz carrier: FREQ = 53687 per Hz, 0.0186 Hz resolution).
+//   The top TBITS bits of ACC + PHASE address a 2^TBITS-entry sine
+//   table in block RAM (sine.dat, entry i = round(32767 sin(2 pi i /
+//   2^TBITS)), 16-bit two's complement), scaled by AMP (unsigned,
+//   65536 = 1.0) and centred on half the period:
+//     high time = PERIOD * (1/2 + AMP/65536 * sin / 65536)   cycles
+//   The table, scaling and multiply take four cycles, so PERIOD must
+//   be at least 8. The new high time is loaded into the comparator at
+//   a period boundary and the output is registered, so every carrier
+//   period has exactly one pulse.
+//
+// Registers (32 bit, word access, WSTRB is ignored)
+//   Offset  Name
+//    0x00   CTRL     [0] enable, [1] update (write 1, reads 1 while
+//                    pending), [2] invert the output, [3] restart
+//                    the phase at the update
+//    0x04   PERIOD   [15:0] carrier period in clock cycles   (shadow)
+//    0x08   FREQ     phase increment per carrier period     (shadow)
+//    0x0C   AMP      [15:0] amplitude, 65536 = 1.0          (shadow)
+//    0x10   PHASE    phase offset, 2^32 = one turn          (shadow)
+//    0x14   STATUS   [0] update pending
+//    0x18   ACC      phase accumulator
+//    0x1C   DUTY     [15:0] high time of the current period
+//   PERIOD, FREQ, AMP and PHASE are written to shadow registers and
+//   read back from them. Writing CTRL with update set copies all four
+//   to the generator at once at the start of the next carrier period
+//   (at once while disabled), so a new setting never shows up half
+//   applied or in the middle of a pulse. A new PERIOD scales the duty
+//   from the sample after.
+//   While disabled the output is idle (low, high when inverted) and
+//   the carrier and the accumulator are held at 0.
+//   sync pulses for one cycle at every carrier period start, e.g. to
+//   trigger an ADC.
+//
+// Testbench
+//   With f_clk = 100 MHz and the 80 kHz carrier of
+//   axi_timer_pwm_student.c it sets 60 Hz, 1 kHz and 4 kHz at
+//   different amplitudes and, from the high time of every carrier
+//   period, checks the sine frequency (zero crossings, within 0.2%),
+//   amplitude (within 2% of the period: at 4 kHz there are only 20
+//   samples per sine period to catch the peaks) and mean (within 1%,
+//   over two whole sine periods), one pulse and
+//   PERIOD cycles per carrier period, that shadow writes do nothing
+//   until the update and that the update lands on a period boundary.
+
+`timescale 1ns/1ps
+
+module testbench();
+
+  parameter PERIOD = 1250;      // 80 kHz carrier at 100 MHz
+  parameter MAXS   = 4096;      // carrier periods recorded
+
+  logic        clk, resetn;
+  logic [4:0]  awaddr, araddr;
+  logic [31:0] wdata, rdata;
+  logic [3:0]  wstrb;
+  logic        awvalid, awready, wvalid, wready, bvalid, bready;
+  logic        arvalid, arready, rvalid, rready;
+  logic [1:0]  bresp, rresp;
+  logic        pwm, sync, PwmLast, Record;
+  logic [95:0] Active, ActiveLast;
+  int          High, Rises, Len, N, Errors;
+  int          Samples[MAXS], SRises[MAXS], SLen[MAXS];
+
+  // instantiate device to be tested
+  dds_spwm_axi dut(clk, resetn, awaddr, awvalid, awready, wdata, wstrb,
+                   wvalid, wready, bresp, bvalid, bready, araddr,
+                   arvalid, arready, rdata, rresp, rvalid, rready,
+                   pwm, sync);
+
+  // 100 MHz clock
+  always
+    begin
+      clk <= 1; # 5; clk <= 0; # 5;
+    end
+
+  // high cycles, rising edges and length of every carrier period
+  always @(posedge clk)
+    begin
+      if (sync) begin
+        if (Record & N < MAXS) begin
+          Samples[N] = High;
+          SRises[N]  = Rises;
+          SLen[N]    = Len;
+          N++;
+        end
+        High  = pwm;
+        Rises = pwm & ~PwmLast;
+        Len   = 1;
+      end else begin
+        High  += pwm;
+        Rises += pwm & ~PwmLast;
+        Len++;
+      end
+      PwmLast = pwm;
+    end
+
+  // the generator settings may only change at a period start
+  assign Active = {dut.Freq, dut.Phase, dut.Period, dut.Amp};
+
+  always @(negedge clk)
+    begin
+      if (resetn & dut.Enable & (Active !== ActiveLast) & ~sync) begin
+        $display("settings changed in the middle of a carrier period");
+        Errors++;
+      end
+      ActiveLast = Active;
+    end
+
+  // AXI4-Lite master, one transfer at a time
+  task automatic axi_write(input logic [4:0] a, input logic [31:0] d);
+    @(negedge clk);
+    awaddr = a; wdata = d; wstrb = 4'hF;
+    awvalid = 1; wvalid = 1;
+    while (!awready) @(negedge clk);
+    @(negedge clk);
+    awvalid = 0; wvalid = 0;
+  endtask
+
+  task automatic axi_read(input logic [4:0] a, output logic [31:0] d);
+    @(negedge clk);
+    araddr = a; arvalid = 1;
+    while (!arready) @(negedge clk);
+    @(negedge clk);
+    arvalid = 0;
+    d = rdata;
+  endtask
+
+  // FREQ for a sine of f Hz on the 80 kHz carrier
+  function automatic logic [31:0] tuning(input real f);
+    return 32'(longint'(f * 4294967296.0 / (100.0e6 / PERIOD) + 0.5));
+  endfunction
+
+  // sets frequency and amplitude, applies them and checks the output
+  // over 2.5 sine periods (the swing and the mean over the first 2)
+  task automatic check(input real f, input logic [15:0] Amp);
+    logic [31:0] d;
+    real         Fpwm, Fmeas, x, First, Last, Mean;
+    int          Periods, Whole, Crossings, Max, Min;
+
+    Fpwm = 100.0e6 / PERIOD;
+    axi_write(5'h08, tuning(f));
+    axi_write(5'h0C, Amp);
+    repeat (4 * PERIOD) @(negedge clk);
+    if (dut.Freq === tuning(f) & f != 0) begin
+      $display("FREQ applied before the update");
+      Errors++;
+    end
+    axi_write(5'h00, 32'h3);
+    do axi_read(5'h14, d); while (d[0]);
+
+    // skip the sample in flight, then record
+    repeat (2) @(posedge sync);
+    N = 0; Record = 1;
+    Periods = int'(2.5 * Fpwm / f);
+    Whole   = int'(2.0 * Fpwm / f);
+    if (Periods > MAXS) Periods = MAXS;
+    while (N < Periods) @(posedge clk);
+    Record = 0;
+
+    Crossings = 0; First = 0; Last = 0; Mean = 0;
+    Max = 0; Min = PERIOD;
+    for (int k = 0; k < Periods; k++) begin
+      if (SRises[k] > 1 | SLen[k] != PERIOD | Samples[k] > PERIOD) begin
+        $display("%0.0f Hz: period %0d has %0d pulses, %0d cycles, high %0d",
+                 f, k, SRises[k], SLen[k], Samples[k]);
+        Errors++;
+      end
+      if (k < Whole) begin
+        if (Samples[k] > Max) Max = Samples[k];
+        if (Samples[k] < Min) Min = Samples[k];
+        Mean += Samples[k];
+      end
+      if (k > 0 && Samples[k-1] < PERIOD / 2 && Samples[k] >= PERIOD / 2) begin
+        x = k - 1 + real'(PERIOD / 2 - Samples[k-1]) / (Samples[k] - Samples[k-1]);
+        if (Crossings == 0) First = x;
+        Last = x;
+        Crossings++;
+      end
+    end
+    Mean = Mean / Whole;
+
+    Fmeas = (Crossings > 1) ? (Crossings - 1) * Fpwm / (Last - First) : 0;
+    $display("%0.0f Hz, AMP %h: measured %0.3f Hz, swing %0d..%0d, mean %0.1f",
+             f, Amp, Fmeas, Min, Max, Mean);
+    if (Fmeas < 0.998 * f | Fmeas > 1.002 * f) begin
+      $display("frequency off");
+      Errors++;
+    end
+    if ((Max - Min) < (real'(Amp) / 65536.0 - 0.02) * PERIOD |
+        (Max - Min) > (real'(Amp) / 65536.0 + 0.02) * PERIOD) begin
+      $display("amplitude off");
+      Errors++;
+    end
+    if (Mean < 0.49 * PERIOD | Mean > 0.51 * PERIOD) begin
+      $display("mean off");
+      Errors++;
+    end
+  endtask
+
+  initial
+    begin
+      resetn = 0; Errors = 0; N = 0; Record = 0;
+      High = 0; Rises = 0; Len = 0; PwmLast = 0;
+      {awvalid, wvalid, arvalid} = 0;
+      bready = 1; rready = 1;
+      # 22; resetn = 1;
+
+      axi_write(5'h04, PERIOD);
+      axi_write(5'h10, 0);
+      axi_write(5'h00, 32'h1);
+      check(60.0,   16'hFFFF);
+      check(1000.0, 16'h8000);
+      check(4000.0, 16'hC000);
+
+      if (Errors == 0) $display("Simulation succeeded");
+      else             $display("Simulation failed");
+      $finish;
+    end
+endmodule
+
+module dds_spwm_axi #(parameter TBITS        = 10,
+                      parameter PERIOD_RESET = 1250)
+                    (input  logic        s_axi_aclk, s_axi_aresetn,
+                     input  logic [4:0]  s_axi_awaddr,
+                     input  logic        s_axi_awvalid,
+                     output logic        s_axi_awready,
+                     input  logic [31:0] s_axi_wdata,
+                     input  logic [3:0]  s_axi_wstrb,
+                     input  logic        s_axi_wvalid,
+                     output logic        s_axi_wready,
+                     output logic [1:0]  s_axi_bresp,
+                     output logic        s_axi_bvalid,
+                     input  logic        s_axi_bready,
+                     input  logic [4:0]  s_axi_araddr,
+                     input  logic        s_axi_arvalid,
+                     output logic        s_axi_arready,
+                     output logic [31:0] s_axi_rdata,
+                     output logic [1:0]  s_axi_rresp,
+                     output logic        s_axi_rvalid,
+                     input  logic        s_axi_rready,
+                     output logic        pwm, sync);
+
+  logic        clk, reset, we, re;
+  logic [31:0] rd;
+  logic        Enable, Invert, Restart, Pending, Start;
+  // shadow and active settings
+  logic [15:0] PeriodS, AmpS, Period, Amp;
+  logic [31:0] FreqS, PhaseS, Freq, Phase;
+  // generator
+  logic [15:0] Cnt, Compare, Duty;
+  logic [31:0] Acc;
+
+  assign clk   = s_axi_aclk;
+  assign reset = ~s_axi_aresetn;
+
+  // write channel: address and data are taken together, then the
+  // response is held until accepted
+  assign we            = s_axi_awvalid & s_axi_wvalid & ~s_axi_bvalid;
+  assign s_axi_awready = we;
+  assign s_axi_wready  = we;
+  assign s_axi_bresp   = 2'b00;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset)             s_axi_bvalid <= 0;
+    else if (we)           s_axi_bvalid <= 1;
+    else if (s_axi_bready) s_axi_bvalid <= 0;
+
+  // read channel: the data is registered
+  assign re            = s_axi_arvalid & ~s_axi_rvalid;
+  assign s_axi_arready = re;
+  assign s_axi_rresp   = 2'b00;
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      s_axi_rvalid <= 0;
+      s_axi_rdata  <= 0;
+    end else if (re) begin
+      s_axi_rvalid <= 1;
+      s_axi_rdata  <= rd;
+    end else if (s_axi_rready) s_axi_rvalid <= 0;
+
+  // registers; the copy of the shadows comes first so that an update
+  // requested in the same cycle stays pending for the next period
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      {Enable, Invert, Restart, Pending} <= 0;
+      PeriodS <= PERIOD_RESET;
+      Period  <= PERIOD_RESET;
+      {FreqS, AmpS, PhaseS} <= 0;
+      {Freq, Amp, Phase}    <= 0;
+    end else begin
+      if (Pending & (Start | ~Enable)) begin
+        Period  <= PeriodS;
+        Freq    <= FreqS;
+        Amp     <= AmpS;
+        Phase   <= PhaseS;
+        Pending <= 0;
+      end
+      if (we)
+        case(s_axi_awaddr[4:2])
+          3'd0: begin
+                  Enable  <= s_axi_wdata[0];
+                  Invert  <= s_axi_wdata[2];
+                  Restart <= s_axi_wdata[3];
+                  if (s_axi_wdata[1]) Pending <= 1;
+                end
+          3'd1:    PeriodS <= s_axi_wdata[15:0];
+          3'd2:    FreqS   <= s_axi_wdata;
+          3'd3:    AmpS    <= s_axi_wdata[15:0];
+          3'd4:    PhaseS  <= s_axi_wdata;
+          default: ;
+        endcase
+    end
+
+  always_comb
+    case(s_axi_araddr[4:2])
+      3'd0:    rd = {28'b0, Restart, Invert, Pending, Enable};
+      3'd1:    rd = {16'b0, PeriodS};
+      3'd2:    rd = FreqS;
+      3'd3:    rd = {16'b0, AmpS};
+      3'd4:    rd = PhaseS;
+      3'd5:    rd = {31'b0, Pending};
+      3'd6:    rd = Acc;
+      default: rd = {16'b0, Compare};
+    endcase
+
+  // carrier and phase accumulator, both advance at the period start
+  assign Start = Enable & (Cnt == Period - 1);
+
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      Cnt     <= 0;
+      Acc     <= 0;
+      Compare <= 0;
+    end else if (~Enable) begin
+      Cnt     <= 0;
+      Acc     <= 0;
+      Compare <= 0;
+    end else if (Start) begin
+      Cnt     <= 0;
+      Acc     <= (Pending & Restart) ? 32'b0 : Acc + Freq;
+      Compare <= Duty;
+    end else Cnt <= Cnt + 1;
+
+  dds_sine #(TBITS) sine(clk, Acc + Phase, Amp, Period, Duty);
+
+  // registered output, no glitches at the compare
+  always_ff @(posedge clk, posedge reset)
+    if (reset) begin
+      pwm  <= 0;
+      sync <= 0;
+    end else begin
+      pwm  <= Enable ? (Cnt < Compare) ^ Invert : Invert;
+      sync <= Start;
+    end
+endmodule
+
+module dds_sine #(parameter TBITS = 10)
+                (input  logic        clk,
+                 input  logic [31:0] Phase,
+                 input  logic [15:0] Amp, Period,
+                 output logic [15:0] Duty);
+
+  // four-stage pipeline: table address, block RAM read, amplitude,
+  // high time = Period * (1/2 + Scaled / 65536)
+  logic signed [15:0] Sine[2**TBITS];
+  logic [TBITS-1:0]   Addr;
+  logic signed [15:0] SinQ, Scaled;
+  logic signed [32:0] Prod;
+  logic [32:0]        High;
+
+  initial
+    $readmemh("sine.dat", Sine);
+
+  assign Prod = SinQ * $signed({1'b0, Amp});
+  assign High = Period * {1'b0, Scaled + 16'sh8000};
+
+  always_ff @(posedge clk)
+    begin
+      Addr   <= Phase[31 -: TBITS];
+      SinQ   <= Sine[Addr];
+      Scaled <= Prod[31:16];
+      Duty   <= High[31:16];
+    end
+endmodule
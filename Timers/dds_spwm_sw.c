@@ -0,0 +1,205 @@
+/*
+ * dds_spwm_sw.c
+ *
+ *  Sine PWM from the DDS generator IP, frequency selected with the switches
+ */
+
+/********************************************************************************************
+ * This code produces the same sine pwm (spwm) waves as axi_timer_pwm_student.c (1 Hz, 60 Hz,
+ * 100 Hz, 500 Hz and 1 kHz on an 80 kHz carrier) with the DDS generator IP (dds_spwm.sv)
+ * instead of the AXI Timer. The HW platform requires:
+ *
+ * 1. LEDs in AXI-GPIO Ch1
+ * 2. SW in AXI-GPIO Ch2
+ * 3. dds_spwm IP with its pwm output in pin T14.
+ *
+ * The IP reads its own sine table at the carrier rate, so every frequency uses all the table
+ * points and the CPU only writes the IP when a switch changes: there is no Private Timer and
+ * no per-sample interrupt.
+ *
+ ********************************************************************************************/
+
+/* Include Files */
+#include "xparameters.h"
+#include "xgpio.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "dds_spwm.h"
+
+/* Definitions */
+#define GPIO_DEVICE_ID  	XPAR_AXI_GPIO_0_DEVICE_ID	/* GPIO device for leds and sw */
+#define LED_CHANNEL 		1				/* GPIO port 1 for LEDs */
+#define SW_CHANNEL 		2				/* GPIO port 2 for SWITCHES */
+#define printf 			xil_printf			/* smaller, optimized printf */
+
+#define DDS_BASEADDR		XPAR_DDS_SPWM_0_S_AXI_BASEADDR	/* DDS generator IP */
+#define DDS_CLOCK_HZ		100000000			/* FCLK_CLK0, the AXI clock of the IP */
+#define PWM_CARRIER_HZ		80000				/* PWM carrier, 12500 ns */
+#define SINE_AMPLITUDE		65535				/* full swing */
+
+/* Interruption ID definitions */
+#define SW_INT_MASK		XGPIO_IR_CH2_MASK
+#define IntC_DEVICE_ID		XPAR_PS7_SCUGIC_0_DEVICE_ID 	// GIC device ID
+#define IntC_GPIO_INTERRUPT_ID	XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR 	// GPIO Interrupt ID
+
+
+/************************** Hardware Instances  ******************************/
+
+XScuGic IntC;			/* Instance of the Interrupt Controller */
+XGpio GpioInst; 		/* Instance of the AXI GPIO */
+DdsSpwm DdsInst;		/* Instance of the DDS generator */
+
+
+/**************  Function Prototypes **************/
+
+/* Interrupt handler for the SW */
+static void SW_Intr_Handler(void *InstancePtr);
+
+/* Interrupt configuration routine */
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr);
+
+/* Sine frequency in mHz for a switch setting */
+static u32 SwitchFrequency(u32 Switches);
+
+
+/*************** Main function ********************/
+int main(void){
+	int Status;
+	u32 SwitchValue;
+
+	/* Configure Gpio for leds and switches */
+	Status = XGpio_Initialize(&GpioInst, GPIO_DEVICE_ID);
+	if (Status != XST_SUCCESS) {
+		xil_printf("GPIO Config failed!\r\n");
+		return XST_FAILURE;
+	}
+	XGpio_SetDataDirection(&GpioInst, LED_CHANNEL, 0x0);
+	XGpio_SetDataDirection(&GpioInst, SW_CHANNEL, 0xf);
+
+	/* Carrier, first frequency and amplitude, all applied at once */
+	DdsSpwm_Initialize(&DdsInst, DDS_BASEADDR, DDS_CLOCK_HZ);
+	Status = DdsSpwm_SetCarrier(&DdsInst, PWM_CARRIER_HZ);
+	if (Status != XST_SUCCESS) {
+		xil_printf("DDS carrier out of range\r\n");
+		return XST_FAILURE;
+	}
+
+	SwitchValue = XGpio_DiscreteRead(&GpioInst, SW_CHANNEL);
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, SwitchValue);
+	DdsSpwm_SetFrequency(&DdsInst, SwitchFrequency(SwitchValue));
+	DdsSpwm_SetAmplitude(&DdsInst, SINE_AMPLITUDE);
+	DdsSpwm_SetPhase(&DdsInst, 0);
+	DdsSpwm_Update(&DdsInst, 1);
+	DdsSpwm_Start(&DdsInst);
+
+	/* Setup interrupt controller and handler connection for the switches */
+	Status = IntCInitFunction(&IntC, IntC_DEVICE_ID, &GpioInst);
+	if(Status != XST_SUCCESS) {
+		  xil_printf("GPIO Interruption configuration failed!\r\n");
+		  return XST_FAILURE;
+	}
+	xil_printf("SPWM running\r\n");
+
+	while(1){    // Nothing to do, the IP makes the waveform
+	}
+
+	return 0;
+} /* End of main */
+
+
+
+/***********************************************************
+ *
+ *                Function implementations
+ *
+ ***********************************************************/
+
+static u32 SwitchFrequency(u32 Switches)
+{
+	switch(Switches){
+		case 0x0:
+			return 60000;		// 60 Hz sine wave
+		case 0x1:
+			return 100000;		// 100 Hz sine wave
+		case 0x2:
+			return 500000;		// 500 Hz sine wave
+		case 0x3:
+			return 1000000;		// 1 kHz sine wave
+		default:
+			return 1000;		// 1 Hz sine wave
+	}
+}
+
+
+/********** Interrupt setup and handler connection **********/
+static int IntCInitFunction(XScuGic *IntCtrlPtr, u16 DeviceId, XGpio *GpioInstancePtr)
+{
+	XScuGic_Config *IntCConfig;
+	int status;
+
+	/* Interrupt controller initialization and success check */
+	IntCConfig = XScuGic_LookupConfig(DeviceId);
+
+	status = XScuGic_CfgInitialize(IntCtrlPtr, IntCConfig, IntCConfig->CpuBaseAddress);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Gpio Handler connection */
+	status = XScuGic_Connect(IntCtrlPtr,
+				IntC_GPIO_INTERRUPT_ID,
+				(Xil_ExceptionHandler)SW_Intr_Handler,
+				(void *)GpioInstancePtr);
+	if(status != XST_SUCCESS){
+		return XST_FAILURE;
+	}
+
+	/* Enable GPIO interrupts */
+	XGpio_InterruptEnable(GpioInstancePtr, SW_INT_MASK);
+	XGpio_InterruptGlobalEnable(GpioInstancePtr);
+
+	/* Enable GIC */
+	XScuGic_Enable(IntCtrlPtr, IntC_GPIO_INTERRUPT_ID);
+
+	/* Initialize the exception table */
+	Xil_ExceptionInit();
+
+	/* Enable Exception handlers */
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			 	 	 	 	 	 (Xil_ExceptionHandler)XScuGic_InterruptHandler,
+								 IntCtrlPtr);
+	Xil_ExceptionEnable();
+
+	return XST_SUCCESS;
+} /*End of IntCInitFunction */
+
+
+void SW_Intr_Handler(void *InstancePtr)
+{
+	u32 SwitchValue;
+
+	/* Disable Gpio Ch2 interrupts */
+	XGpio_InterruptDisable(&GpioInst, SW_INT_MASK);
+
+	/* Ignore additional button presses in Ch2 */
+	if ((XGpio_InterruptGetStatus(&GpioInst) & SW_INT_MASK) !=
+			SW_INT_MASK) {
+			return;
+		}
+
+	SwitchValue = XGpio_DiscreteRead(&GpioInst, SW_CHANNEL);
+	XGpio_DiscreteWrite(&GpioInst, LED_CHANNEL, SwitchValue);
+
+	/* Two register writes: the new frequency goes to the shadow register
+	 * and is applied at the next carrier period, keeping the phase */
+	DdsSpwm_SetFrequency(&DdsInst, SwitchFrequency(SwitchValue));
+	DdsSpwm_Update(&DdsInst, 0);
+
+    /* Clear the interrupt flag in Gpio Ch2*/
+    (void)XGpio_InterruptClear(&GpioInst, SW_INT_MASK);
+
+    /* Enable GPIO interrupts in Gpio Ch2 */
+    XGpio_InterruptEnable(&GpioInst, SW_INT_MASK);
+} /* End of SW_Intr_Handler*/